@@ -1,7 +1,11 @@
+/* For posix_memalign */
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <string.h>
 
 /*
  * These are defined for each TIP program in the compiled code.
@@ -32,6 +36,113 @@ void _tip_error(int64_t x) {
   exit(-1);
 }
 
+/*
+ * Pooled allocation of the heap cells of TIP programs, which are used
+ * when they are compiled with --pooled-alloc.
+ *
+ * Almost all cells are of a handful of sizes, e.g., 8 bytes for alloc of
+ * an int and the size of the UberRecord for records, which grows with the
+ * number of fields in the program.  Each size, rounded up to a multiple of
+ * 8, is a class of cells carved out of slabs that hold cells of that size
+ * only, and the first slab of a class is created the first time its size
+ * is allocated.  Freed cells are kept on a free list per class and reused
+ * before the slab is bumped.  The classes are per thread, so allocation
+ * needs no locking.  A cell freed by another thread joins that thread's
+ * list for the same size.
+ *
+ * Slabs are aligned to their size, so the slab header holding the size
+ * of its cells is found from a cell's address.  Cells too large to share
+ * a slab with a few others are allocated on their own, with only a slab
+ * header in front of them that marks them as such.
+ */
+#define TIP_SLAB_SIZE ((size_t)1 << 16)
+#define TIP_CELL_ALIGN 8
+#define TIP_MAX_POOLED (TIP_SLAB_SIZE / 4)
+#define TIP_NUM_CLASSES (TIP_MAX_POOLED / TIP_CELL_ALIGN)
+
+struct tip_slab {
+  size_t cellSize;  /* 0 for a header in front of one large cell */
+  size_t padding;
+};
+
+struct tip_free_cell {
+  struct tip_free_cell *next;
+};
+
+static _Thread_local struct tip_free_cell *tip_free_lists[TIP_NUM_CLASSES];
+static _Thread_local char *tip_slab_next[TIP_NUM_CLASSES];
+static _Thread_local size_t tip_slab_left[TIP_NUM_CLASSES];
+
+/*
+ * A slab holding cells of cellSize bytes, or the header of a large cell
+ * of bytes in all if cellSize is 0.  Unlike aligned_alloc, posix_memalign
+ * does not require the size to be a multiple of the alignment, so a
+ * large cell takes little more than its own size.
+ */
+static struct tip_slab *tip_new_slab(size_t bytes, size_t cellSize) {
+  void *slab = NULL;
+  if (posix_memalign(&slab, TIP_SLAB_SIZE, bytes) != 0) {
+    printf("Error: out of memory\n");
+    exit(-1);
+  }
+  ((struct tip_slab *)slab)->cellSize = cellSize;
+  return slab;
+}
+
+/*
+ * Allocate a cell of size bytes, whose contents are undefined.  Code
+ * generation uses this when it initializes the whole cell.
+ */
+void *_tip_alloc(int64_t size) {
+  if ((size_t)size > TIP_MAX_POOLED) {
+    size_t bytes = (sizeof(struct tip_slab) + size + TIP_CELL_ALIGN - 1) & ~(TIP_CELL_ALIGN - 1);
+    return tip_new_slab(bytes, 0) + 1;
+  }
+
+  size_t c = size > 0 ? (size - 1) / TIP_CELL_ALIGN : 0;
+  struct tip_free_cell *cell = tip_free_lists[c];
+  if (cell != NULL) {
+    tip_free_lists[c] = cell->next;
+    return cell;
+  }
+
+  size_t cellSize = (c + 1) * TIP_CELL_ALIGN;
+  if (tip_slab_left[c] < cellSize) {
+    struct tip_slab *slab = tip_new_slab(TIP_SLAB_SIZE, cellSize);
+    tip_slab_next[c] = (char *)(slab + 1);
+    tip_slab_left[c] = TIP_SLAB_SIZE - sizeof(struct tip_slab);
+  }
+  void *result = tip_slab_next[c];
+  tip_slab_next[c] += cellSize;
+  tip_slab_left[c] -= cellSize;
+  return result;
+}
+
+// Allocate a cell of size bytes that is initialized to zero
+void *_tip_alloc_zeroed(int64_t size) {
+  void *cell = _tip_alloc(size);
+  memset(cell, 0, size);
+  return cell;
+}
+
+// Free a cell allocated by _tip_alloc or _tip_alloc_zeroed
+void _tip_free(void *cell) {
+  if (cell == NULL) {
+    return;
+  }
+
+  struct tip_slab *slab = (struct tip_slab *)((uintptr_t)cell & ~(TIP_SLAB_SIZE - 1));
+  if (slab->cellSize == 0) {
+    free(slab);
+    return;
+  }
+
+  size_t c = slab->cellSize / TIP_CELL_ALIGN - 1;
+  struct tip_free_cell *freed = cell;
+  freed->next = tip_free_lists[c];
+  tip_free_lists[c] = freed;
+}
+
 /*
  * If the compiled program has no "main" function then one is created
  * that calls this function.
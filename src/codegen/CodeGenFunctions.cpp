@@ -2,8 +2,17 @@
 #include <ASTDeclNode.h>
 
 #include "AST.h"
+#include "EscapingFunctions.h"
 #include "SemanticAnalysis.h"
 #include "InternalError.h"
+#include "Substituter.h"
+#include "TipAbsentField.h"
+#include "TipAlpha.h"
+#include "TipFunction.h"
+#include "TipMu.h"
+#include "TipRecord.h"
+#include "TipRef.h"
+#include "TipTypeFactory.h"
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
@@ -23,6 +32,7 @@
 #include "llvm/Support/TypeSize.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/InstCombine/InstCombine.h"
@@ -59,6 +69,28 @@ using namespace llvm;
  *
  * This results in some suboptimal code, but we rely on the powerful LLVM
  * optimization passes to clean most of it up.  
+ *
+ * A record is the address of a structure of just the fields it defines,
+ * which is the layout of its inferred type, as every record that may flow
+ * to an access has the same type.
+ *
+ * Alternatively, code generation can be directed by the inferred types.  Each
+ * value is then represented by an LLVM type derived from its TIP type:
+ * references become pointers, records become pointers to a structure of the
+ * fields they define, and only ints and types that are polymorphic or
+ * recursive in a way LLVM cannot express remain Int64.  Since every
+ * representation is 64 bits wide, a value can always be converted to the
+ * representation a use expects, which is done where the types derived for
+ * the two differ.
+ *
+ * Functions become pointers to functions of type Int64^N -> Int64, whatever
+ * their TIP type.  The types derived for a function value where it is
+ * defined and where it is called may differ in their representation, e.g.,
+ * when one unrolls a recursive type, and calling a function through a
+ * pointer to another function type is undefined.  Functions that are used
+ * as values are therefore defined with that type, while the functions that
+ * are only called by name take and return the representations of their
+ * types.
  */
 
 namespace {
@@ -70,24 +102,18 @@ namespace {
 LLVMContext TheContext;
 IRBuilder<> Builder(TheContext);
 
-/* 
- * Functions are represented with indices into a table. 
- * This permits function values to be passed, i.e, as Int64 indices. 
- */
-std::map<std::string, int> functionIndex;
-
-std::map<std::string, std::vector<std::string>> functionFormalNames;
-
 /*
- * This structure stores the mapping from names in a function scope
- * to their LLVM values.  The structure is built when entering a
- * scope and cleared when exiting a scope.
+ * This structure stores the mapping from declarations of parameters
+ * and locals to their LLVM values.  It is indexed by the number that
+ * symbol analysis assigns to each declaration, and since these are
+ * unique across the program it need not be cleared between scopes.
  */
-std::map<std::string, AllocaInst *> NamedValues;
+std::vector<AllocaInst *> NamedValues;
 
 /**
- * The UberRecord is a the type of all records
- *  It has a field for every named field in the program
+ * The UberRecord has a field for every named field in the program.  It is
+ * the type of the records whose type is not known, which are only those
+ * derived from "null".
  */
 llvm::StructType * uberRecordType;
 
@@ -96,15 +122,41 @@ llvm::StructType * uberRecordType;
  */
 llvm::PointerType * ptrToUberRecordType;
 
-// Maps field names to their index in the UberRecor
-std::map<std::basic_string<char>, int> fieldIndex;
-
-// Vector of fields in an uber record
-std::vector<std::basic_string<char>> fieldVector;
+// Maps interned field names to their index in the UberRecord, or -1
+std::vector<int> fieldIndex;
 
 // Permits getFunction to access the current module being compiled
 std::unique_ptr<Module> CurrentModule;
 
+/*
+ * For type directed code generation the inferred types of declarations
+ * are taken from the semantic analysis, and the types of expressions are
+ * derived from them.  Both the types of expressions and the LLVM types
+ * that represent TIP types are memoized for the program being compiled.
+ */
+bool typeDirected = false;
+TypeInference *typeResults = nullptr;
+SymbolTable *symbolTable = nullptr;
+std::map<ASTExpr *, std::shared_ptr<TipType>> exprTypes;
+std::map<std::shared_ptr<TipType>, llvm::Type *> representations;
+
+// The LLVM functions for TIP functions, indexed by their declaration number
+std::vector<llvm::Function *> tipFunctions;
+
+/*
+ * The index in the function table of each function whose address escapes
+ * as a value, or -1 for functions that are only ever called by name.
+ */
+std::vector<int> tableIndex;
+
+/*
+ * The analysis that finds the possible callees of applications when
+ * indirect calls are promoted to direct calls, and otherwise nullptr.
+ * Calls with more possible callees than this are left indirect.
+ */
+SemanticAnalysis *callTargets = nullptr;
+const unsigned maxPromotedTargets = 4;
+
 /*
  * We use calls to llvm intrinsics for several purposes.  To construct a "nop",
  * using an LLVM internal intrinsic, to perform TIP specific IO, and
@@ -117,6 +169,15 @@ llvm::Function *errorIntrinsic = nullptr;
 llvm::Function *callocFun = nullptr;
 llvm::Function *freeFun = nullptr;
 
+/*
+ * With pooled allocation heap cells come from the allocator of the
+ * runtime library, which need not zero the cells that code generation
+ * initializes.
+ */
+bool pooledAlloc = false;
+llvm::Function *tipAllocFun = nullptr;
+llvm::Function *tipAllocZeroedFun = nullptr;
+
 
 // A counter to create unique labels
 int labelNum = 0;
@@ -151,15 +212,245 @@ GlobalVariable *tipInputArray = nullptr;
 Constant *zeroV = ConstantInt::get(Type::getInt64Ty(TheContext), 0);
 Constant *oneV = ConstantInt::get(Type::getInt64Ty(TheContext), 1);
 
+bool isAbsent(std::shared_ptr<TipType> const &type) {
+  return dynamic_cast<TipAbsentField *>(type.get()) != nullptr;
+}
+
+// The position among the fields a record defines of the field at the given position in the program
+int memberIndex(TipRecord *record, int position) {
+  int index = 0;
+  for (int i = 0; i < position; i++) {
+    if (!isAbsent(record->getArguments()[i])) {
+      index++;
+    }
+  }
+  return index;
+}
+
+/*
+ * The LLVM type that represents values of a TIP type.  The bindings give
+ * the representation of the variables of the recursive types that enclose
+ * the type, innermost last.
+ */
+using Bindings = std::vector<std::pair<TipVar *, llvm::Type *>>;
+
+llvm::Type *representation(std::shared_ptr<TipType> const &type, Bindings &bindings);
+
+std::vector<llvm::Type *> members(TipRecord *record, Bindings &bindings) {
+  std::vector<llvm::Type *> types;
+  for (auto &field : record->getArguments()) {
+    if (!isAbsent(field)) {
+      types.push_back(representation(field, bindings));
+    }
+  }
+  return types;
+}
+
+llvm::Type *buildRepresentation(std::shared_ptr<TipType> const &type,
+                                Bindings &bindings) {
+  auto *int64 = Type::getInt64Ty(TheContext);
+  if (auto *var = dynamic_cast<TipVar *>(type.get())) {
+    for (auto bound = bindings.rbegin(); bound != bindings.rend(); ++bound) {
+      if (*bound->first == *var) {
+        return bound->second;
+      }
+    }
+    return int64;
+  } else if (auto *ref = dynamic_cast<TipRef *>(type.get())) {
+    return PointerType::get(representation(ref->getAddressOfField(), bindings), 0);
+  } else if (auto *record = dynamic_cast<TipRecord *>(type.get())) {
+    return PointerType::get(StructType::get(TheContext, members(record, bindings)), 0);
+  } else if (auto *fun = dynamic_cast<TipFunction *>(type.get())) {
+    std::vector<llvm::Type *> params(fun->getParams().size(), int64);
+    return PointerType::get(FunctionType::get(int64, params, false), 0);
+  } else if (auto *mu = dynamic_cast<TipMu *>(type.get())) {
+    /*
+     * A recursive type that is a record, or a reference to one, is
+     * represented with a named structure, which may refer to itself.
+     * Otherwise the recursive occurrences are represented by Int64.
+     */
+    int depth = 0;
+    auto body = mu->getT();
+    while (auto *ref = dynamic_cast<TipRef *>(body.get())) {
+      body = ref->getAddressOfField();
+      depth++;
+    }
+
+    llvm::Type *result;
+    if (auto *record = dynamic_cast<TipRecord *>(body.get())) {
+      auto *named = StructType::create(TheContext, "record");
+      result = PointerType::get(named, 0);
+      for (int i = 0; i < depth; i++) {
+        result = PointerType::get(result, 0);
+      }
+      bindings.emplace_back(mu->getV().get(), result);
+      named->setBody(members(record, bindings));
+    } else {
+      bindings.emplace_back(mu->getV().get(), int64);
+      result = representation(mu->getT(), bindings);
+    }
+    bindings.pop_back();
+    return result;
+  }
+
+  // ints, and absent fields, which are never accessed
+  return int64;
+}
+
+llvm::Type *representation(std::shared_ptr<TipType> const &type, Bindings &bindings) {
+  // Only closed types have a representation that can be reused
+  if (!bindings.empty()) {
+    return buildRepresentation(type, bindings);
+  }
+
+  auto found = representations.find(type);
+  if (found != representations.end()) {
+    return found->second;
+  }
+  auto *result = buildRepresentation(type, bindings);
+  representations[type] = result;
+  return result;
+}
+
+llvm::Type *representation(std::shared_ptr<TipType> const &type) {
+  Bindings bindings;
+  return representation(type, bindings);
+}
+
+/*
+ * The structure of the fields that a record type defines, in the order of
+ * the fields of the program.  Without type directed code generation each
+ * field is an Int64.
+ */
+llvm::StructType *recordLayout(std::shared_ptr<TipType> const &recordType) {
+  if (typeDirected) {
+    return cast<StructType>(representation(recordType)->getPointerElementType());
+  }
+  auto *record = static_cast<TipRecord *>(recordType.get());
+  int defined = memberIndex(record, record->getArguments().size());
+  return StructType::get(TheContext, std::vector<llvm::Type *>(defined, Type::getInt64Ty(TheContext)));
+}
+
+// Unroll a recursive type until its outermost constructor is exposed
+std::shared_ptr<TipType> unfold(std::shared_ptr<TipType> type) {
+  while (auto *mu = dynamic_cast<TipMu *>(type.get())) {
+    type = Substituter::substitute(mu->getT().get(), mu->getV().get(), type);
+  }
+  return type;
+}
+
+/*
+ * The type of an expression, derived from the inferred types of the
+ * declarations it mentions.  Where those do not determine it, as for
+ * "null", a free type variable is used.
+ */
+std::shared_ptr<TipType> typeOf(ASTExpr *expr) {
+  auto found = exprTypes.find(expr);
+  if (found != exprTypes.end()) {
+    return found->second;
+  }
+
+  std::shared_ptr<TipType> type;
+  if (auto *var = dynamic_cast<ASTVariableExpr *>(expr)) {
+    type = typeResults->getInferredType(var->getDecl());
+  } else if (auto *deref = dynamic_cast<ASTDeRefExpr *>(expr)) {
+    auto ptrType = unfold(typeOf(deref->getPtr()));
+    if (auto *ref = dynamic_cast<TipRef *>(ptrType.get())) {
+      type = ref->getAddressOfField();
+    }
+  } else if (auto *ref = dynamic_cast<ASTRefExpr *>(expr)) {
+    type = TipTypeFactory::ref(typeOf(ref->getVar()));
+  } else if (auto *alloc = dynamic_cast<ASTAllocExpr *>(expr)) {
+    type = TipTypeFactory::ref(typeOf(alloc->getInitializer()));
+  } else if (dynamic_cast<ASTNullExpr *>(expr)) {
+    type = TipTypeFactory::ref(TipTypeFactory::alpha(expr));
+  } else if (auto *app = dynamic_cast<ASTFunAppExpr *>(expr)) {
+    auto funType = unfold(typeOf(app->getFunction()));
+    if (auto *fun = dynamic_cast<TipFunction *>(funType.get())) {
+      type = fun->getReturnValue();
+    }
+  } else if (auto *record = dynamic_cast<ASTRecordExpr *>(expr)) {
+    auto &allFields = symbolTable->getFields();
+    std::vector<std::shared_ptr<TipType>> fieldTypes(allFields.size());
+    for (auto &field : record->getFields()) {
+      auto &fieldType = fieldTypes[symbolTable->getFieldIndex(field->getFieldId())];
+      if (fieldType == nullptr) {
+        fieldType = typeOf(field->getInitializer());
+      }
+    }
+    for (auto &fieldType : fieldTypes) {
+      if (fieldType == nullptr) {
+        fieldType = TipTypeFactory::absentField();
+      }
+    }
+    type = TipTypeFactory::record(fieldTypes, allFields);
+  } else if (auto *access = dynamic_cast<ASTAccessExpr *>(expr)) {
+    auto recordType = unfold(typeOf(access->getRecord()));
+    auto position = symbolTable->getFieldIndex(access->getFieldId());
+    if (auto *rec = dynamic_cast<TipRecord *>(recordType.get()); rec != nullptr && position >= 0) {
+      type = rec->getArguments()[position];
+    }
+  } else {
+    // numbers, input, and the operators
+    type = TipTypeFactory::intType();
+  }
+
+  if (type == nullptr) {
+    type = TipTypeFactory::alpha(expr);
+  }
+  exprTypes[expr] = type;
+  return type;
+}
+
+// The LLVM type of the value of an expression
+llvm::Type *valueType(ASTExpr *expr) {
+  if (!typeDirected) {
+    return Type::getInt64Ty(TheContext);
+  }
+  return representation(typeOf(expr));
+}
+
+// The LLVM type of the value of a declared name
+llvm::Type *valueType(ASTDeclNode *decl) {
+  if (!typeDirected) {
+    return Type::getInt64Ty(TheContext);
+  }
+  return representation(typeResults->getInferredType(decl));
+}
+
+// The type of the functions that a representation points to, if it is a function pointer
+FunctionType *functionType(llvm::Type *type) {
+  return type->isPointerTy() ? dyn_cast<FunctionType>(type->getPointerElementType()) : nullptr;
+}
+
+/*
+ * Convert a value to another representation.  All representations are
+ * 64 bits wide, except the results of comparisons, which are widened.
+ */
+Value *convert(Value *value, llvm::Type *type) {
+  auto *from = value->getType();
+  if (from == type) {
+    return value;
+  } else if (from->isPointerTy() && type->isPointerTy()) {
+    return Builder.CreatePointerCast(value, type);
+  } else if (from->isPointerTy()) {
+    return Builder.CreatePtrToInt(value, type);
+  } else if (type->isPointerTy()) {
+    return Builder.CreateIntToPtr(value, type);
+  }
+  return Builder.CreateZExtOrTrunc(value, type);
+}
+
 /*
  * Create LLVM Function in Module associated with current program.
  * This function declares the function, but it does not generate code.
  * This is a key element of the shallow pass that builds the function
- * dispatch table.
+ * dispatch table.  A function that escapes as a value is declared with
+ * the type that function values are called with.
  */
-llvm::Function *getFunction(std::string Name) {
-  // Lookup the symbol to access the formal parameter list
-  auto formals = functionFormalNames[Name];
+llvm::Function *getFunction(ASTFunction *fn, bool escapes = false) {
+  auto &Name = fn->getName();
+  auto formals = fn->getFormals();
 
   /*
    * Main is handled specially.  It is declared as "_tip_main" with
@@ -188,9 +479,21 @@ llvm::Function *getFunction(std::string Name) {
     // function not found, so create it
 
     std::vector<Type *> FormalTypes(formals.size(), Type::getInt64Ty(TheContext));
+    Type *ReturnType = Type::getInt64Ty(TheContext);
+
+    // With type directed code generation use the representations of the parameter and return types
+    if (typeDirected && !escapes) {
+      auto funType = unfold(typeResults->getInferredType(fn->getDecl()));
+      if (auto *tipFun = dynamic_cast<TipFunction *>(funType.get());
+          tipFun != nullptr && tipFun->getParams().size() == formals.size()) {
+        for (size_t i = 0; i < formals.size(); i++) {
+          FormalTypes[i] = representation(tipFun->getParams()[i]);
+        }
+        ReturnType = representation(tipFun->getReturnValue());
+      }
+    }
 
-    // Use type factory to create function from formal type to int
-    auto *FT = FunctionType::get(Type::getInt64Ty(TheContext), FormalTypes, false);
+    auto *FT = FunctionType::get(ReturnType, FormalTypes, false);
 
     auto *F = llvm::Function::Create(FT, llvm::Function::InternalLinkage, Name,
                                      CurrentModule.get());
@@ -198,7 +501,7 @@ llvm::Function *getFunction(std::string Name) {
     // assign names to args for readability of generated code
     unsigned i = 0;
     for (auto &param : F->args()) {
-      param.setName(formals[i++]);
+      param.setName(formals[i++]->getName());
     }
 
     return F;
@@ -209,9 +512,109 @@ llvm::Function *getFunction(std::string Name) {
  * Create an alloca instruction in the entry block of the function.
  * This is used for mutable variables, including arguments to functions.
  */
-AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction, const std::string &VarName) {
+AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction, const std::string &VarName,
+                                   Type *VarType = Type::getInt64Ty(TheContext)) {
   IRBuilder<> tmp(&TheFunction->getEntryBlock(), TheFunction->getEntryBlock().begin());
-  return tmp.CreateAlloca(Type::getInt64Ty(TheContext), 0, VarName);
+  return tmp.CreateAlloca(VarType, 0, VarName);
+}
+
+/*
+ * The function that a callee expression names, if it is a reference to
+ * a function declaration that accepts the given number of arguments.
+ * Main is declared without parameters and ignores the arguments of a
+ * call, as it does when it is called through the function table, so it
+ * is always named.
+ */
+llvm::Function *namedFunction(ASTExpr *callee, size_t numArgs) {
+  auto *var = dynamic_cast<ASTVariableExpr *>(callee);
+  if (var == nullptr || var->getDecl() == nullptr) {
+    return nullptr;
+  }
+
+  // Functions are numbered first, so lower numbers are function declarations
+  int index = var->getDeclIndex();
+  if (index < 0 || index >= static_cast<int>(tipFunctions.size())) {
+    return nullptr;
+  }
+  auto *fn = tipFunctions[index];
+  if (fn->getName() == "_tip_main") {
+    return fn;
+  }
+  return fn->arg_size() == numArgs ? fn : nullptr;
+}
+
+/*
+ * The declaration numbers of the functions that the control flow analysis
+ * found an application may call, if there are few enough to test for each
+ * of them.  Only the functions that accept the actuals and that can be
+ * function values are candidates.
+ */
+std::vector<int> promotedTargets(ASTFunAppExpr *call) {
+  std::vector<int> targets;
+  if (callTargets == nullptr) {
+    return targets;
+  }
+
+  for (auto *fun : callTargets->getCallTargets(call)) {
+    int index = fun->getDecl()->getIndex();
+    if (index < 0 || index >= static_cast<int>(tipFunctions.size()) ||
+        tipFunctions[index]->arg_size() != call->getActuals().size()) {
+      continue;
+    }
+    if (!typeDirected && tableIndex[index] < 0) {
+      continue;
+    }
+    targets.push_back(index);
+  }
+
+  if (targets.size() > maxPromotedTargets) {
+    targets.clear();
+  }
+  return targets;
+}
+
+/*
+ * Allocate a heap cell for a value of the given type.  Cells from calloc
+ * are always zeroed, while the pooled allocator zeroes only the cells
+ * that are not initialized by the caller.
+ */
+Value *allocateCell(Type *cellType, bool initialized, const Twine &name) {
+  auto *size = ConstantInt::get(Type::getInt64Ty(TheContext),
+                                CurrentModule->getDataLayout().getTypeAllocSize(cellType));
+  if (pooledAlloc) {
+    return Builder.CreateCall(initialized ? tipAllocFun : tipAllocZeroedFun, {size}, name);
+  }
+  return Builder.CreateCall(callocFun, {oneV, size}, name);
+}
+
+/*
+ * Call a function value with the call-site determined function type.
+ * A function pointer is called as is, while a function table index is
+ * used to load the function pointer from the table.
+ */
+Value *indirectCall(Value *funVal, FunctionType *funType, std::vector<Value *> const &args) {
+  auto *funPtrType = PointerType::get(funType, 0);
+  if (typeDirected) {
+    return Builder.CreateCall(funType, convert(funVal, funPtrType), args, "calltmp");
+  }
+
+  /*
+   * Emit the GEP instruction to compute the address of LLVM function
+   * pointer to be called.
+   */
+  std::vector<Value *> indices;
+  indices.push_back(zeroV);
+  indices.push_back(funVal);
+
+  auto *gep = Builder.CreateInBoundsGEP(tipFTable->getValueType(), tipFTable, indices, "ftableidx");
+
+  // Load the function pointer
+  auto *genericFunPtr = Builder.CreateLoad(gep->getType()->getPointerElementType(), gep, "genfptr");
+
+  // Bitcast the function pointer to the call-site determined function type
+  auto *castFunPtr = Builder.CreatePointerCast(genericFunPtr, funPtrType, "castfptr");
+
+  return Builder.CreateCall(funType, castFunPtr, args, "calltmp");
 }
 
 } // end anonymous namespace for code generator data and functions
@@ -219,9 +622,19 @@ AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction, const std::strin
 /********************* codegen() routines ************************/
 
 std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
-                                                  std::string programName) {
+                                                  std::string programName,
+                                                  bool typed,
+                                                  bool promoteCalls,
+                                                  bool pooled) {
   LOG_S(1) << "Generating code for program " << programName;
 
+  typeDirected = typed;
+  symbolTable = analysis->getSymbolTable();
+  typeResults = analysis->getTypeResults();
+  callTargets = promoteCalls ? analysis : nullptr;
+  exprTypes.clear();
+  representations.clear();
+
   // Create module to hold generated code
   auto TheModule = std::make_unique<Module>(programName, TheContext);
 
@@ -244,19 +657,11 @@ std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
    */
   {
     /*
-     * First create the local function symbol table which stores
-     * the function index and formal parameters
+     * Functions are indexed by their declaration number, which symbol
+     * analysis assigns in program order, and parameters and locals are
+     * bound by declaration number as well.
      */
-    int funIndex = 0;
-    for (auto const &fn : getFunctions()) {
-      functionIndex[fn->getName()] = funIndex++;
-
-      auto formals = fn->getFormals();
-      std::vector<std::string> names;
-      std::transform(formals.begin(), formals.end(), 
-                     std::back_inserter(names), [](auto& d){return d->getName();});
-      functionFormalNames[fn->getName()] = names;
-    }
+    NamedValues.assign(analysis->getSymbolTable()->getNumDeclarations(), nullptr);
 
     /*
      * Create the llvm functions.
@@ -266,8 +671,19 @@ std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
      * below in creating the ftableInit.
      */
     std::vector<llvm::Constant *> programFunctions;
+    tipFunctions.clear();
+    tableIndex.clear();
+    auto escapes = EscapingFunctions::build(this);
     for (auto const &fn : getFunctions()) {
-      programFunctions.push_back(getFunction(fn->getName()));
+      tipFunctions.push_back(getFunction(fn, escapes[tableIndex.size()]));
+
+      // Only functions used as values need a slot in the table
+      if (escapes[tableIndex.size()]) {
+        tableIndex.push_back(programFunctions.size());
+        programFunctions.push_back(tipFunctions.back());
+      } else {
+        tableIndex.push_back(-1);
+      }
     }
 
     /*
@@ -279,7 +695,7 @@ std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
         FunctionType::get(Type::getInt64Ty(TheContext), None, false), 0);
 
     // Create and record the function dispatch table
-    auto *ftableType = ArrayType::get(genFunPtrType, funIndex);
+    auto *ftableType = ArrayType::get(genFunPtrType, programFunctions.size());
 
     // Cast TIP functions to the generic function pointer type for initializer
     std::vector<Constant *> castProgramFunctions;
@@ -294,10 +710,16 @@ std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
      */
     auto *ftableInit = ConstantArray::get(ftableType, castProgramFunctions);
 
-    // Create the global function dispatch table
-    tipFTable = new GlobalVariable(*CurrentModule, ftableType, true,
-                                   llvm::GlobalValue::InternalLinkage,
-                                   ftableInit, "_tip_ftable");
+    /*
+     * Create the global function dispatch table, unless function values
+     * are represented by function pointers.
+     */
+    tipFTable = nullptr;
+    if (!typeDirected) {
+      tipFTable = new GlobalVariable(*CurrentModule, ftableType, true,
+                                     llvm::GlobalValue::InternalLinkage,
+                                     ftableInit, "_tip_ftable");
+    }
   }
 
   /*
@@ -313,8 +735,7 @@ std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
      * we never visit it during the codegen() traversals - since
      * the function doesn't exist in the TIP program.
      */
-    auto fidx = functionIndex.find("main");
-    if (fidx == functionIndex.end()) {
+    if (analysis->getSymbolTable()->getFunction("main") == nullptr) {
       auto *M = llvm::Function::Create(
           FunctionType::get(Type::getInt64Ty(TheContext), false),
           llvm::Function::ExternalLinkage, "_tip_main", CurrentModule.get());
@@ -344,15 +765,31 @@ std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
         ConstantArray::get(inputArrayType, zeros), "_tip_input_array");
   }
 
-  // declare the calloc function
-  // the calloc function takes in two ints: the number of items and the size of the items
-  std::vector<Type *> twoInt(2, Type::getInt64Ty(TheContext));
-  auto *FT = FunctionType::get(Type::getInt8PtrTy(TheContext), twoInt, false);
-  callocFun = llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
-                                     "calloc", CurrentModule.get());
-  callocFun->addFnAttr(llvm::Attribute::NoUnwind);
-
-  callocFun->setAttributes(callocFun->getAttributes().addAttributeAtIndex(callocFun->getContext(), 0, llvm::Attribute::NoAlias));
+  pooledAlloc = pooled;
+  callocFun = tipAllocFun = tipAllocZeroedFun = nullptr;
+  if (pooledAlloc) {
+    // declare the allocation functions of the runtime library, which take the size of the cell
+    std::vector<Type *> oneInt(1, Type::getInt64Ty(TheContext));
+    auto *FT = FunctionType::get(Type::getInt8PtrTy(TheContext), oneInt, false);
+    tipAllocFun = llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
+                                         "_tip_alloc", CurrentModule.get());
+    tipAllocZeroedFun = llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
+                                               "_tip_alloc_zeroed", CurrentModule.get());
+    for (auto *fun : {tipAllocFun, tipAllocZeroedFun}) {
+      fun->addFnAttr(llvm::Attribute::NoUnwind);
+      fun->setAttributes(fun->getAttributes().addAttributeAtIndex(fun->getContext(), 0, llvm::Attribute::NoAlias));
+    }
+  } else {
+    // declare the calloc function
+    // the calloc function takes in two ints: the number of items and the size of the items
+    std::vector<Type *> twoInt(2, Type::getInt64Ty(TheContext));
+    auto *FT = FunctionType::get(Type::getInt8PtrTy(TheContext), twoInt, false);
+    callocFun = llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
+                                       "calloc", CurrentModule.get());
+    callocFun->addFnAttr(llvm::Attribute::NoUnwind);
+
+    callocFun->setAttributes(callocFun->getAttributes().addAttributeAtIndex(callocFun->getContext(), 0, llvm::Attribute::NoAlias));
+  }
   
   // declare the free function
   // the free function takes in a pointer and returns void
@@ -360,23 +797,23 @@ std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
   std::vector<Type *> inputPtr(1, Type::getInt8PtrTy(TheContext));
   auto *free_FT = FunctionType::get(Type::getVoidTy(TheContext), inputPtr, false);
   freeFun = llvm::Function::Create(free_FT, llvm::Function::ExternalLinkage,
-                                     "free", CurrentModule.get());
+                                     pooledAlloc ? "_tip_free" : "free", CurrentModule.get());
   freeFun->addFnAttr(llvm::Attribute::NoUnwind);
 
   // callocFun->setAttributes(callocFun->getAttributes().addAttributeAtIndex(callocFun->getContext(), 0, llvm::Attribute::NoAlias));
 
   /* We create a single unified record structure that is capable of representing
-   * all records in a TIP program.  While wasteful of memory, this approach is 
-   * compatible with the limited type checking provided for records in TIP.
+   * all records in a TIP program.  Records are laid out by their inferred
+   * types, so it only serves records whose type is not known.
    *
    * We refer to this single unified record structure as the "uber record"
    */
   std::vector<Type *> member_values;
+  fieldIndex.assign(IdentifierTable::size(), -1);
   int index = 0;
-  for(auto field : analysis->getSymbolTable()->getFields()){
+  for(auto &field : analysis->getSymbolTable()->getFields()){
       member_values.push_back(IntegerType::getInt64Ty((TheContext)));
-      fieldVector.push_back(field);
-      fieldIndex[field] = index;
+      fieldIndex[IdentifierTable::intern(field)] = index;
       index++;
   }
   uberRecordType = StructType::create(TheContext, member_values, "uberRecord");
@@ -389,6 +826,13 @@ std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
 
   TheModule = std::move(CurrentModule);
 
+  // Release the types that were memoized for this program
+  typeDirected = false;
+  typeResults = nullptr;
+  callTargets = nullptr;
+  exprTypes.clear();
+  representations.clear();
+
   verifyModule(*TheModule);
 
   return TheModule;
@@ -396,8 +840,9 @@ std::unique_ptr<llvm::Module> ASTProgram::codegen(SemanticAnalysis* analysis,
 
 llvm::Value* ASTFunction::codegen() {
   LOG_S(1) << "Generating code for " << *this;
+  llvm::TimeTraceScope scope("CodegenFunction", getName());
 
-  llvm::Function *TheFunction = getFunction(getName());
+  llvm::Function *TheFunction = getFunction(this);
   if (TheFunction == nullptr) {
     throw InternalError("failed to declare the function" + getName()); // LCOV_EXCL_LINE
   }
@@ -406,9 +851,6 @@ llvm::Value* ASTFunction::codegen() {
   BasicBlock *BB = BasicBlock::Create(TheContext, "entry", TheFunction);
   Builder.SetInsertPoint(BB);
 
-  // keep scope separate from prior definitions
-  NamedValues.clear();
-
   /*
    * Add arguments to the symbol table
    *   - for main function, we initialize allocas with array loads
@@ -417,9 +859,9 @@ llvm::Value* ASTFunction::codegen() {
   if (getName() == "main") {
     int argIdx = 0;
     // Note that the args are not in the LLVM function decl, so we use the AST formals
-    for (auto &argName : functionFormalNames[getName()]) {
+    for (auto formal : getFormals()) {
       // Create an alloca for this argument and store its value
-      AllocaInst *argAlloc = CreateEntryBlockAlloca(TheFunction, argName);
+      AllocaInst *argAlloc = CreateEntryBlockAlloca(TheFunction, formal->getName());
 
       // Emit the GEP instruction to index into input array
       std::vector<Value *> indices;
@@ -431,17 +873,19 @@ llvm::Value* ASTFunction::codegen() {
       auto *inVal = Builder.CreateLoad(gep->getType()->getPointerElementType(), gep, "tipinput" + std::to_string(argIdx++));
       Builder.CreateStore(inVal, argAlloc);
 
-      // Record name binding to alloca
-      NamedValues[argName] = argAlloc;
+      // Record declaration binding to alloca
+      NamedValues[formal->getIndex()] = argAlloc;
     }
   } else {
+    auto formals = getFormals();
     for (auto &arg : TheFunction->args()) {
       // Create an alloca for this argument and store its value
-      AllocaInst *argAlloc = CreateEntryBlockAlloca(TheFunction, arg.getName().str());
-      Builder.CreateStore(&arg, argAlloc);
+      auto *formal = formals[arg.getArgNo()];
+      AllocaInst *argAlloc = CreateEntryBlockAlloca(TheFunction, arg.getName().str(), valueType(formal));
+      Builder.CreateStore(convert(&arg, argAlloc->getAllocatedType()), argAlloc);
 
-      // Record name binding to alloca
-      NamedValues[arg.getName().str()] = argAlloc;
+      // Record declaration binding to alloca
+      NamedValues[formal->getIndex()] = argAlloc;
     }
   }
 
@@ -479,6 +923,18 @@ llvm::Value* ASTBinaryExpr::codegen() {
     throw InternalError("null binary operand");
   }
 
+  /*
+   * Operands are ints, except that equality also compares references,
+   * records, and functions.  These are compared as pointers of the same
+   * type, or as Int64 if only one is a pointer.
+   */
+  if (L->getType()->isPointerTy() && R->getType()->isPointerTy()) {
+    R = convert(R, L->getType());
+  } else {
+    L = convert(L, Type::getInt64Ty(TheContext));
+    R = convert(R, Type::getInt64Ty(TheContext));
+  }
+
   if (getOp() == "+") {
     return Builder.CreateAdd(L, R, "addtmp");
   } else if (getOp() == "-") {
@@ -499,30 +955,35 @@ llvm::Value* ASTBinaryExpr::codegen() {
 }
 
 /*
- * First lookup the variable in the symbol table for names and
- * if that fails, then look in the symbol table for functions.
+ * Symbol analysis has bound the variable to its declaration.  If
+ * that declaration has an alloca it is a parameter or local, otherwise
+ * it names a function.
  *
- * This relies on the fact that TIP programs have been checked to
- * ensure that names obey the scope rules.
+ * Functions are numbered first and in program order, so the number of
+ * a function declaration is also its index in the functions of the module.
+ * A function used as a value is represented by its index in the function
+ * table.
  */
 llvm::Value* ASTVariableExpr::codegen() {
   LOG_S(1) << "Generating code for " << *this;
 
-  auto nv = NamedValues.find(getName());
-  if (nv != NamedValues.end()) {
+  if (getDecl() == nullptr) {
+    throw InternalError("Unknown variable name: " + getName());
+  }
+
+  if (auto *alloca = NamedValues[getDeclIndex()]) {
     if (lValueGen) {
-      return NamedValues[nv->first];
+      return alloca;
     } else {
-      return Builder.CreateLoad(nv->second->getAllocatedType(), nv->second, getName().c_str());
+      return Builder.CreateLoad(alloca->getAllocatedType(), alloca, getName().c_str());
     }
   }
 
-  auto fidx = functionIndex.find(getName());
-  if (fidx == functionIndex.end()) {
-    throw InternalError("Unknown variable name: " + getName());
+  // Function values are either function pointers or indices into the function table
+  if (typeDirected) {
+    return tipFunctions[getDeclIndex()];
   }
-
-  return ConstantInt::get(Type::getInt64Ty(TheContext), fidx->second);
+  return ConstantInt::get(Type::getInt64Ty(TheContext), tableIndex[getDeclIndex()]);
 }
 
 llvm::Value* ASTInputExpr::codegen() {
@@ -545,10 +1006,35 @@ llvm::Value* ASTInputExpr::codegen() {
  *
  * The function name values and table are setup in a shallow-pass over
  * functions performed during codegen for the Program.
+ *
+ * With type directed code generation function values are function
+ * pointers instead, which are called with the type of the callee.
+ *
+ * Applications of a named function are direct calls in either case,
+ * which exposes them to inlining and interprocedural optimization.
+ * When calls are promoted, applications of other function values test
+ * the value for each of the few functions that control flow analysis
+ * finds it may be, and call the matching function directly.
  */
 llvm::Value* ASTFunAppExpr::codegen() {
   LOG_S(1) << "Generating code for " << *this;
 
+  if (auto *callee = namedFunction(getFunction(), getActuals().size())) {
+    std::vector<Value *> argsV;
+    for (auto const &arg : getActuals()) {
+      Value *argVal = arg->codegen();
+      if (argVal == nullptr) {
+        throw InternalError("failed to generate bitcode for the argument"); // LCOV_EXCL_LINE
+      }
+      // The arguments of main are evaluated but not passed
+      if (argsV.size() < callee->arg_size()) {
+        argsV.push_back(convert(argVal, callee->getArg(argsV.size())->getType()));
+      }
+    }
+
+    return Builder.CreateCall(callee, argsV, "calltmp");
+  }
+
   /*
    * Evaluate the function expression - it will resolve to an integer value
    * whether it is a function literal or an expression.
@@ -559,35 +1045,17 @@ llvm::Value* ASTFunAppExpr::codegen() {
   }
 
   /*
-   * Emit the GEP instruction to compute the address of LLVM function
-   * pointer to be called.
-   */
-  std::vector<Value *> indices;
-  indices.push_back(zeroV); 
-  indices.push_back(funVal);
-
-  auto *gep = Builder.CreateInBoundsGEP(tipFTable->getValueType(), tipFTable, indices, "ftableidx");
-
-  // Load the function pointer
-  auto *genericFunPtr = Builder.CreateLoad(gep->getType()->getPointerElementType(), gep, "genfptr");
-
-  /*
-   * Compute the specific function pointer type based on the actual parameter
+   * Compute the specific function type based on the actual parameter
    * list.
    *
-   * TBD: Currently the type is Int64^N -> Int64, * where N is the length of the list
-   *
-   * Once type information is available we will need to iterate the actuals
-   * and construct the per actual vector of types.
+   * Without type directed code generation the type is Int64^N -> Int64,
+   * where N is the length of the list.
    */
-  std::vector<Type *> actualTypes(getActuals().size(), Type::getInt64Ty(TheContext));
-  auto *funType = FunctionType::get(Type::getInt64Ty(TheContext), actualTypes, false);
-  auto *funPtrType = PointerType::get(funType, 0);
-
-
-  // Bitcast the function pointer to the call-site determined function type
-  auto *castFunPtr =
-      Builder.CreatePointerCast(genericFunPtr, funPtrType, "castfptr");
+  FunctionType *funType = typeDirected ? functionType(valueType(getFunction())) : nullptr;
+  if (funType == nullptr || funType->getNumParams() != getActuals().size()) {
+    std::vector<Type *> actualTypes(getActuals().size(), Type::getInt64Ty(TheContext));
+    funType = FunctionType::get(Type::getInt64Ty(TheContext), actualTypes, false);
+  }
 
   // Compute the actual parameters
   std::vector<Value *> argsV;
@@ -596,10 +1064,60 @@ llvm::Value* ASTFunAppExpr::codegen() {
     if (argVal == nullptr) {
       throw InternalError("failed to generate bitcode for the argument"); // LCOV_EXCL_LINE
     }
-    argsV.push_back(argVal);
+    argsV.push_back(convert(argVal, funType->getParamType(argsV.size())));
+  }
+
+  auto targets = promotedTargets(this);
+  if (targets.empty()) {
+    return indirectCall(funVal, funType, argsV);
+  }
+
+  /*
+   * Test the function value against each possible callee in turn and
+   * call the one it matches directly.  The analysis does not follow
+   * function values through the heap, so a value that matches none of
+   * them is still called through the table.
+   */
+  llvm::Function *TheFunction = Builder.GetInsertBlock()->getParent();
+  labelNum++;
+  auto label = std::to_string(labelNum);
+  BasicBlock *MergeBB = BasicBlock::Create(TheContext, "callmerge" + label);
+
+  auto *funPtrType = PointerType::get(funType, 0);
+  auto *key = typeDirected ? convert(funVal, funPtrType) : funVal;
+  std::vector<std::pair<Value *, BasicBlock *>> results;
+  for (auto index : targets) {
+    auto *target = tipFunctions[index];
+    Constant *targetKey = typeDirected
+        ? ConstantExpr::getPointerCast(target, funPtrType)
+        : ConstantInt::get(Type::getInt64Ty(TheContext), tableIndex[index]);
+
+    BasicBlock *CallBB = BasicBlock::Create(TheContext, "promoted" + label, TheFunction);
+    BasicBlock *NextBB = BasicBlock::Create(TheContext, "notpromoted" + label, TheFunction);
+    Builder.CreateCondBr(Builder.CreateICmpEQ(key, targetKey, "istarget"), CallBB, NextBB);
+
+    Builder.SetInsertPoint(CallBB);
+    std::vector<Value *> targetArgs;
+    for (auto *argVal : argsV) {
+      targetArgs.push_back(convert(argVal, target->getArg(targetArgs.size())->getType()));
+    }
+    auto *result = Builder.CreateCall(target, targetArgs, "calltmp");
+    results.emplace_back(convert(result, funType->getReturnType()), Builder.GetInsertBlock());
+    Builder.CreateBr(MergeBB);
+
+    Builder.SetInsertPoint(NextBB);
   }
 
-  return Builder.CreateCall(funType, castFunPtr, argsV, "calltmp");
+  results.emplace_back(indirectCall(funVal, funType, argsV), Builder.GetInsertBlock());
+  Builder.CreateBr(MergeBB);
+
+  TheFunction->getBasicBlockList().push_back(MergeBB);
+  Builder.SetInsertPoint(MergeBB);
+  auto *phi = Builder.CreatePHI(funType->getReturnType(), results.size(), "calltmp");
+  for (auto &incoming : results) {
+    phi->addIncoming(incoming.first, incoming.second);
+  }
+  return phi;
 }
 
 /* 'alloc' Allocate expression
@@ -615,18 +1133,15 @@ llvm::Value* ASTAllocExpr::codegen() {
     throw InternalError("failed to generate bitcode for the initializer of the alloc expression");
   }
   
-  //Allocate an int pointer with calloc
-  std::vector<Value *> twoArg;
-  twoArg.push_back(ConstantInt::get(Type::getInt64Ty(TheContext), 1));
-  twoArg.push_back(ConstantInt::get(Type::getInt64Ty(TheContext), 8));
-  auto *allocInst = Builder.CreateCall(callocFun, twoArg, "allocPtr");
+  //Allocate a cell for the value of the initializer, which initializes all of it
+  auto *cellType = valueType(getInitializer());
+  auto *allocInst = allocateCell(cellType, true, "allocPtr");
   auto *castPtr = Builder.CreatePointerCast(
-      allocInst, Type::getInt64PtrTy(TheContext), "castPtr");
+      allocInst, PointerType::get(cellType, 0), "castPtr");
   // Initialize with argument
-  auto *initializingStore = Builder.CreateStore(argVal, castPtr);
+  auto *initializingStore = Builder.CreateStore(convert(argVal, cellType), castPtr);
 
-  return Builder.CreatePtrToInt(castPtr, Type::getInt64Ty(TheContext),
-                                "allocIntVal");
+  return convert(castPtr, valueType(this));
 }
 
 /* 'free' Allocate expression
@@ -643,7 +1158,7 @@ llvm::Value* ASTFreeStmt::codegen() {
   // }
 
   Value *target = getArg()->codegen();
-  Value *targetPtr = Builder.CreateIntToPtr(target, Type::getInt8PtrTy(TheContext), "targetPtr");
+  Value *targetPtr = convert(target, Type::getInt8PtrTy(TheContext));
 
   std::vector<Value *> Arg;
   Arg.push_back(targetPtr);
@@ -672,8 +1187,7 @@ llvm::Value* ASTFreeStmt::codegen() {
 
 llvm::Value* ASTNullExpr::codegen() {
   auto *nullPtr = ConstantPointerNull::get(Type::getInt64PtrTy(TheContext));
-  return Builder.CreatePtrToInt(nullPtr, Type::getInt64Ty(TheContext),
-                                "nullPtrIntVal");
+  return convert(nullPtr, valueType(this));
 }
 
 /* '&' address of expression
@@ -693,7 +1207,7 @@ llvm::Value* ASTRefExpr::codegen() {
     throw InternalError("could not generate l-value for address of");
   }
 
-  return Builder.CreatePtrToInt(lValue, Type::getInt64Ty(TheContext), "addrOfPtr");
+  return convert(lValue, valueType(this));
 }  // LCOV_EXCL_LINE
 
 /* '*' dereference expression
@@ -701,7 +1215,8 @@ llvm::Value* ASTRefExpr::codegen() {
  * The argument is assumed to be a reference expression, but
  * our code generation strategy stores everything as an integer.
  * Consequently, we convert the value with "inttoptr" before loading
- * the value at the pointed-to memory location.
+ * the value at the pointed-to memory location.  With type directed
+ * code generation the argument is usually a pointer already.
  */
 llvm::Value* ASTDeRefExpr::codegen() {
   LOG_S(1) << "Generating code for " << *this;
@@ -719,71 +1234,48 @@ llvm::Value* ASTDeRefExpr::codegen() {
   }
 
   // compute the address
-  Value *address = Builder.CreateIntToPtr(argVal, Type::getInt64PtrTy(TheContext), "ptrIntVal");
+  auto *cellType = valueType(this);
+  Value *address = convert(argVal, PointerType::get(cellType, 0));
 
   if (isLValue) {
     // For an l-value, return the address
     return address;
   } else {
     // For an r-value, return the value at the address
-    return Builder.CreateLoad(address->getType()->getPointerElementType(), address, "valueAt");
+    return Builder.CreateLoad(cellType, address, "valueAt");
   }
 }
 
 /* {field1 : val1, ..., fieldN : valN} record expression
  *
- * Builds an instance of the UberRecord using the declared fields
+ * Builds a structure of just the declared fields, which is the layout of
+ * the record's type.  Alloc'd records are on the heap and others on the stack.
  */
 llvm::Value* ASTRecordExpr::codegen() {
   LOG_S(1) << "Generating code for " << *this;
 
-  //If this is an alloc, we calloc the record
-  if(allocFlag){
-    //Allocate the a pointer to an uber record
-    auto *allocaRecord = Builder.CreateAlloca(ptrToUberRecordType);
-
-    // Use Builder to create the calloc call using pre-defined callocFun
-    auto sizeOfUberRecord = CurrentModule->getDataLayout().getStructLayout(uberRecordType)->getSizeInBytes();
-    std::vector<Value *> callocArgs;
-    callocArgs.push_back(oneV); 
-    callocArgs.push_back(ConstantInt::get(Type::getInt64Ty(TheContext), sizeOfUberRecord));
-    auto *calloc = Builder.CreateCall(callocFun, callocArgs, "callocedPtr");
-
-    //Bitcast the calloc call to theStruct Type
-    auto recordPtr = Builder.CreatePointerCast(calloc, ptrToUberRecordType, "recordCalloc");
-
-    //Store the ptr to the record in the record alloc
-    Builder.CreateStore(recordPtr, allocaRecord);
-
-    //Load allocaRecord
-    auto loadInst = Builder.CreateLoad(ptrToUberRecordType,allocaRecord);
-
-    //For each field, generate GEP for location of field in the uberRecord
-    //Generate the code for the field and store it in the GEP
-    for(auto const &field : getFields()){
-        auto *gep = Builder.CreateStructGEP(uberRecordType, loadInst, fieldIndex[field->getField()], field->getField());
-        auto value = field->codegen();
-        Builder.CreateStore(value, gep);
-    }
+  auto recordType = typeOf(this);
+  auto *record = static_cast<TipRecord *>(recordType.get());
+  auto *structType = recordLayout(recordType);
 
-  //Return int64 pointer to the pointer to the record
-  return Builder.CreatePtrToInt(recordPtr, Type::getInt64Ty(TheContext), "recordPtr");
+  Value *recordPtr;
+  if (allocFlag) {
+    // Every field of the structure is defined by the record
+    auto *calloc = allocateCell(structType, true, "callocedPtr");
+    recordPtr = Builder.CreatePointerCast(calloc, PointerType::get(structType, 0), "recordCalloc");
+  } else {
+    recordPtr = Builder.CreateAlloca(structType, nullptr, "record");
   }
-  else{
-    //Allocate a the space for a uber record
-    auto *allocaRecord = Builder.CreateAlloca(uberRecordType);
 
-    //Codegen the fields present in this record and store them in the appropriate location
-    //We do not give a value to fields that are not explictly set. Thus, accessing them is
-    //undefined behavior
-    for(auto const &field : getFields()){
-      auto *gep = Builder.CreateStructGEP(allocaRecord->getAllocatedType(), allocaRecord, fieldIndex[field->getField()], field->getField());
-      auto value = field->codegen();
-      Builder.CreateStore(value, gep);
-    }
-    //Return int64 pointer to the record since all variables are pointers to ints
-    return Builder.CreatePtrToInt(allocaRecord, Type::getInt64Ty(TheContext), "record");
+  for (auto const &field : getFields()) {
+    auto index = memberIndex(record, symbolTable->getFieldIndex(field->getFieldId()));
+    auto *gep = Builder.CreateStructGEP(structType, recordPtr, index, field->getField());
+    auto value = field->codegen();
+    Builder.CreateStore(convert(value, structType->getStructElementType(index)), gep);
   }
+
+  // Without type directed code generation the record is an Int64, as are all values
+  return convert(recordPtr, valueType(this));
 }
 
 /* field : val field expression
@@ -800,6 +1292,10 @@ llvm::Value* ASTFieldExpr::codegen() {
  *
  * In an l-value context this returns the location of the field being accessed
  * In an r-value context this returns the value of the field being accessed
+ *
+ * The field is located in the structure for the type of the record.  If
+ * that type is not known, which is only the case for records derived from
+ * "null", the UberRecord is used instead.
  */
 llvm::Value* ASTAccessExpr::codegen() {
   LOG_S(1) << "Generating code for " << *this;
@@ -812,17 +1308,30 @@ llvm::Value* ASTAccessExpr::codegen() {
   }
 
   //Get current field and check if it exists
-  auto currField = this->getField();
-  if(fieldIndex.count(currField) == 0){
+  auto &currField = this->getField();
+  if(getFieldId() >= fieldIndex.size() || fieldIndex[getFieldId()] < 0){
     throw InternalError("This field doesn't exist");
   }
 
   //Generate record instruction address
   Value *recordVal = this->getRecord()->codegen();
-  Value *recordAddress = Builder.CreateIntToPtr(recordVal, ptrToUberRecordType);
+
+  auto recordType = unfold(typeOf(getRecord()));
+  if (auto *record = dynamic_cast<TipRecord *>(recordType.get())) {
+    auto *structType = recordLayout(recordType);
+    auto index = memberIndex(record, symbolTable->getFieldIndex(getFieldId()));
+    auto *address = convert(recordVal, PointerType::get(structType, 0));
+    auto *gep = Builder.CreateStructGEP(structType, address, index, currField);
+    if (isLValue) {
+      return gep;
+    }
+    return Builder.CreateLoad(structType->getStructElementType(index), gep, "fieldAccess");
+  }
+
+  Value *recordAddress = convert(recordVal, ptrToUberRecordType);
 
   //Generate the field index
-  auto index = fieldIndex[currField];
+  auto index = fieldIndex[getFieldId()];
 
   //Generate the location of the field
   auto *gep = Builder.CreateStructGEP(uberRecordType, recordAddress, index, currField);
@@ -851,13 +1360,13 @@ llvm::Value* ASTDeclStmt::codegen() {
 
   // Register all variables and emit their initializer.
   for (auto l : getVars()) {
-    localAlloca = CreateEntryBlockAlloca(TheFunction, l->getName());
+    localAlloca = CreateEntryBlockAlloca(TheFunction, l->getName(), valueType(l));
 
     // Initialize all locals to "0"
-    Builder.CreateStore(zeroV, localAlloca);
+    Builder.CreateStore(Constant::getNullValue(localAlloca->getAllocatedType()), localAlloca);
 
     // Remember this binding.
-    NamedValues[l->getName()] = localAlloca;
+    NamedValues[l->getIndex()] = localAlloca;
   }
 
   // Return the body computation.
@@ -881,7 +1390,7 @@ llvm::Value* ASTAssignStmt::codegen() {
     throw InternalError("failed to generate bitcode for the rhs of the assignment");
   }
 
-  return Builder.CreateStore(rValue, lValue);
+  return Builder.CreateStore(convert(rValue, lValue->getType()->getPointerElementType()), lValue);
 }  // LCOV_EXCL_LINE
 
 llvm::Value* ASTBlockStmt::codegen() {
@@ -1074,7 +1583,7 @@ llvm::Value* ASTOutputStmt::codegen() {
     throw InternalError("failed to generate bitcode for the argument of the output statement");
   }
 
-  std::vector<Value *> ArgsV(1, argVal);
+  std::vector<Value *> ArgsV(1, convert(argVal, Type::getInt64Ty(TheContext)));
 
   return Builder.CreateCall(outputIntrinsic, ArgsV);
 }
@@ -1094,7 +1603,7 @@ llvm::Value* ASTErrorStmt::codegen() {
     throw InternalError("failed to generate bitcode for the argument of the error statement");
   }
 
-  std::vector<Value *> ArgsV(1, argVal);
+  std::vector<Value *> ArgsV(1, convert(argVal, Type::getInt64Ty(TheContext)));
 
   return Builder.CreateCall(errorIntrinsic, ArgsV);
 }
@@ -1103,5 +1612,6 @@ llvm::Value* ASTReturnStmt::codegen() {
   LOG_S(1) << "Generating code for " << *this;
 
   Value *argVal = getArg()->codegen();
-  return Builder.CreateRet(argVal);
+  auto *returnType = Builder.GetInsertBlock()->getParent()->getReturnType();
+  return Builder.CreateRet(convert(argVal, returnType));
 } // LCOV_EXCL_LINE
@@ -7,8 +7,9 @@
 using namespace llvm;
 
 std::unique_ptr<Module> CodeGenerator::generate(ASTProgram* program, 
-                                SemanticAnalysis* analysisResults, std::string fileName) {
-  return std::move(program->codegen(analysisResults, fileName));
+                                SemanticAnalysis* analysisResults, std::string fileName, bool typed,
+                                bool promoteCalls, bool pooled) {
+  return std::move(program->codegen(analysisResults, fileName, typed, promoteCalls, pooled));
 }  // LCOV_EXCL_LINE
 
 void CodeGenerator::emit(llvm::Module* m, std::string filename) {
@@ -23,9 +23,17 @@ public:
    * \param program the root of an AST encoding the program
    * \param analysisResults the results from semantic analysis of the program
    * \param fileName the name of the source file holding the program
+   * \param typed whether to direct code generation by the inferred types, representing
+   * references, records and functions by LLVM pointer types rather than Int64
+   * \param promoteCalls whether to call the functions that control flow analysis finds a
+   * function value may be directly, falling back to an indirect call for other values
+   * \param pooled whether to allocate heap cells with _tip_alloc and _tip_free of the
+   * runtime library rather than calloc and free
    * \return the LLVM module holding the generated program
    */
-  static std::unique_ptr<llvm::Module> generate(ASTProgram* program, SemanticAnalysis* analysisResults, std::string fileName);
+  static std::unique_ptr<llvm::Module> generate(ASTProgram* program, SemanticAnalysis* analysisResults,
+                                                std::string fileName, bool typed = false,
+                                                bool promoteCalls = false, bool pooled = false);
 
   /*! \fn emit
    *  \brief Emit LLVM IR to a file.
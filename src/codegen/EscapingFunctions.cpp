@@ -0,0 +1,20 @@
+#include "EscapingFunctions.h"
+
+bool EscapingFunctions::visit(ASTFunAppExpr *element) {
+  callees.insert(element->getFunction());
+  return true;
+}
+
+void EscapingFunctions::endVisit(ASTVariableExpr *element) {
+  // Functions are numbered first, so lower numbers are function declarations
+  int index = element->getDeclIndex();
+  if (index >= 0 && index < numFunctions && callees.count(element) == 0) {
+    escapes[index] = true;
+  }
+}
+
+std::vector<bool> EscapingFunctions::build(ASTProgram *p) {
+  EscapingFunctions visitor(p->getFunctions().size());
+  p->accept(&visitor);
+  return visitor.escapes;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ASTVisitor.h"
+#include <set>
+#include <vector>
+
+/*! \class EscapingFunctions
+ *  \brief Collects the functions whose address escapes as a value.
+ *
+ * A reference to a function that is the callee of an application can be
+ * called directly.  Any other reference, e.g., passing a function as an
+ * argument, assigning it, or returning it, makes the function a value
+ * that must be callable through the function table.
+ */
+class EscapingFunctions : public ASTVisitor {
+  int numFunctions;
+  std::set<ASTExpr *> callees;
+  std::vector<bool> escapes;
+public:
+  explicit EscapingFunctions(int numFunctions)
+      : numFunctions(numFunctions), escapes(numFunctions, false) {}
+
+  /*! \brief Return whether each function of the program escapes.
+   *
+   * The result is indexed by the number of the function's declaration,
+   * which is its position in the program.
+   */
+  static std::vector<bool> build(ASTProgram *p);
+
+  virtual bool visit(ASTFunAppExpr *element) override;
+  virtual void endVisit(ASTVariableExpr *element) override;
+};
@@ -0,0 +1,221 @@
+#include "PhaseScheduler.h"
+#include "loguru.hpp"
+#include "llvm/Support/TimeProfiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <sys/resource.h>
+
+namespace {
+
+// The peak resident set size of the process so far, in KiB.
+long peakResidentSetSize() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+}
+
+int PhaseScheduler::add(std::string name, Phase phase, std::vector<int> dependences) {
+  int id = tasks.size();
+  auto task = std::make_unique<Task>();
+  task->name = std::move(name);
+  task->phase = std::move(phase);
+  for (auto d : dependences) {
+    assert(d >= 0 && d < id);
+    tasks[d]->dependents.push_back(id);
+  }
+  task->dependences = std::move(dependences);
+  tasks.push_back(std::move(task));
+  return id;
+}
+
+void PhaseScheduler::execute(int t, std::chrono::steady_clock::time_point origin) {
+  using ms = std::chrono::duration<double, std::milli>;
+  auto &task = *tasks[t];
+  auto start = std::chrono::steady_clock::now();
+  long startPeak = peakResidentSetSize();
+  LOG_S(1) << "Starting phase " << task.name;
+  try {
+    llvm::TimeTraceScope scope("Phase", task.name);
+    task.phase(task.output);
+  } catch (...) {
+    task.error = std::current_exception();
+  }
+  auto end = std::chrono::steady_clock::now();
+  task.ran = true;
+  task.start = ms(start - origin).count();
+  task.time = ms(end - start).count();
+  task.cumulativePeakRSS = peakResidentSetSize();
+  task.peakRSSGrowth = task.cumulativePeakRSS - startPeak;
+}
+
+/*
+ * Ready phases are started lowest number first, so with fewer threads than
+ * independent phases the phases still run roughly in order.  A worker waits
+ * while nothing can be started and some phase is still running, since that
+ * phase may make others ready, and stops once neither holds.
+ */
+void PhaseScheduler::run(unsigned threads, std::ostream &out) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  int n = tasks.size();
+  int failed = n;
+  for (auto &task : tasks) {
+    task->output.str("");
+    task->error = nullptr;
+    task->ran = false;
+    task->time = 0;
+    task->cumulativePeakRSS = 0;
+    task->peakRSSGrowth = 0;
+  }
+  auto origin = std::chrono::steady_clock::now();
+
+  if (threads == 1) {
+    for (int t = 0; t < n && failed == n; t++) {
+      execute(t, origin);
+      if (tasks[t]->error) {
+        failed = t;
+      } else {
+        out << tasks[t]->output.str();
+      }
+    }
+  } else {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<int> pending(n);
+    std::vector<bool> done(n, false);
+    std::set<int> ready;
+    int running = 0;
+    int flushed = 0;
+
+    for (int t = 0; t < n; t++) {
+      pending[t] = tasks[t]->dependences.size();
+      if (pending[t] == 0) {
+        ready.insert(t);
+      }
+    }
+
+    auto startable = [&]() { return !ready.empty() && *ready.begin() < failed; };
+    auto work = [&]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true) {
+        changed.wait(lock, [&]() { return startable() || running == 0; });
+        if (!startable()) {
+          break;
+        }
+        int t = *ready.begin();
+        ready.erase(ready.begin());
+        running++;
+
+        lock.unlock();
+        execute(t, origin);
+        lock.lock();
+
+        running--;
+        done[t] = true;
+        if (tasks[t]->error) {
+          failed = std::min(failed, t);
+        } else {
+          for (auto d : tasks[t]->dependents) {
+            if (--pending[d] == 0) {
+              ready.insert(d);
+            }
+          }
+        }
+        while (flushed < failed && done[flushed]) {
+          out << tasks[flushed++]->output.str();
+        }
+        changed.notify_all();
+      }
+    };
+
+    // The profiler is per thread, and a finished worker hands its spans to the trace
+    bool tracing = llvm::timeTraceProfilerEnabled();
+    auto worker = [&]() {
+      if (tracing) {
+        llvm::timeTraceProfilerInitialize(traceGranularity, "tipc");
+      }
+      work();
+      if (tracing) {
+        llvm::timeTraceProfilerFinishThread();
+      }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < std::min<unsigned>(threads, n); w++) {
+      pool.emplace_back(worker);
+    }
+    work();
+    for (auto &thread : pool) {
+      thread.join();
+    }
+  }
+
+  elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+  if (failed < n) {
+    std::rethrow_exception(tasks[failed]->error);
+  }
+}
+
+double PhaseScheduler::getTotal() const {
+  double total = 0;
+  for (auto &task : tasks) {
+    total += task->time;
+  }
+  return total;
+}
+
+double PhaseScheduler::getCriticalPath() const {
+  std::vector<double> finish(tasks.size(), 0);
+  double longest = 0;
+  for (int t = 0; t < tasks.size(); t++) {
+    double ready = 0;
+    for (auto d : tasks[t]->dependences) {
+      ready = std::max(ready, finish[d]);
+    }
+    finish[t] = ready + tasks[t]->time;
+    longest = std::max(longest, finish[t]);
+  }
+  return longest;
+}
+
+std::vector<PhaseScheduler::Record> PhaseScheduler::getRecords() const {
+  std::vector<Record> records;
+  for (auto &task : tasks) {
+    if (task->ran) {
+      records.push_back(Record{task->name, task->start, task->time, task->cumulativePeakRSS,
+                                task->peakRSSGrowth});
+    }
+  }
+  return records;
+}
+
+void PhaseScheduler::report(std::ostream &os) const {
+  os << std::fixed << std::setprecision(3);
+  os << std::left << std::setw(24) << "phase" << std::right << std::setw(12) << "start (ms)"
+     << std::setw(12) << "time (ms)" << std::setw(24) << "peak RSS so far (KiB)"
+     << std::setw(20) << "peak growth (KiB)" << "\n";
+  for (auto &record : getRecords()) {
+    os << std::left << std::setw(24) << record.name << std::right << std::setw(12) << record.start
+       << std::setw(12) << record.time << std::setw(24) << record.cumulativePeakRSS
+       << std::setw(20) << record.peakRSSGrowth << "\n";
+  }
+  os << "phases took " << getTotal() << " ms and finished in " << getElapsed()
+     << " ms with a critical path of " << getCriticalPath() << " ms, saving "
+     << getTotal() - getElapsed() << " ms\n";
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*! \class PhaseScheduler
+ *  \brief Runs the phases of the compiler as a DAG of tasks on a pool of threads.
+ *
+ * Phases are numbered in the order they are added, which must be an order in
+ * which they could run one after the other: a phase may only depend on
+ * phases added before it.  A phase starts once all of its dependences have
+ * finished, so independent phases can run at the same time.
+ *
+ * The result is the same as running the phases in order.  Each phase writes
+ * its output to a buffer of its own, and the buffers are copied to the output
+ * stream in phase order, each as soon as it and every earlier phase are done.
+ * If a phase throws, no later phase is started, earlier phases still run, and
+ * once they are done the output of the earlier phases is written and the
+ * exception of the first phase to fail is rethrown.  Phases that already
+ * started are allowed to finish, so a phase with side effects other than its
+ * output, such as writing a file, should depend on the phases that can fail.
+ *
+ * Each phase is a span of the LLVM time trace, when the profiler is enabled
+ * on the thread that calls run, and the workers record their spans in the
+ * same trace.
+ */
+class PhaseScheduler {
+public:
+  //! \brief A phase, which writes its output to the given stream.
+  using Phase = std::function<void(std::ostream &)>;
+
+  //! \brief The measurements of a phase that ran.
+  struct Record {
+    std::string name;
+    double start;   //!< from the start of run, in milliseconds
+    double time;    //!< in milliseconds
+    long cumulativePeakRSS; //!< the peak resident set size of the process when the phase finished, in KiB
+    long peakRSSGrowth;     //!< how much that peak grew while the phase ran, in KiB
+  };
+
+  /*! \brief Add a phase.
+   * \param name The name of the phase, for reports
+   * \param phase The work of the phase
+   * \param dependences The numbers of the phases that must finish before it starts
+   * \return The number of the phase
+   */
+  int add(std::string name, Phase phase, std::vector<int> dependences = {});
+
+  /*! \brief Run the phases.
+   *
+   * With one thread the phases run in order on the calling thread.
+   * \param threads The number of threads to use, 0 for one per hardware thread
+   * \param out The stream the output of the phases is copied to
+   */
+  void run(unsigned threads, std::ostream &out);
+
+  //! \brief Return the time from the start of run to the end of the last phase, in milliseconds.
+  double getElapsed() const { return elapsed; }
+
+  //! \brief Return the sum of the times taken by the phases that ran, in milliseconds.
+  double getTotal() const;
+
+  //! \brief Return the time taken by the longest chain of dependent phases, in milliseconds.
+  double getCriticalPath() const;
+
+  //! \brief Return the measurements of the phases that ran, in phase order.
+  std::vector<Record> getRecords() const;
+
+  /*! \brief Write the start, duration and peak memory of each phase that ran, and the time saved.
+   *
+   * The peak memory is that of the whole process, both so far and the growth
+   * during the phase, which phases that run at the same time share.  The time
+   * saved is the sum of the times of the phases less the elapsed time.
+   */
+  void report(std::ostream &os) const;
+
+  //! \brief Set the shortest span the workers record in the time trace, in microseconds.
+  void setTimeTraceGranularity(unsigned microseconds) { traceGranularity = microseconds; }
+
+private:
+  struct Task {
+    std::string name;
+    Phase phase;
+    std::vector<int> dependences;
+    std::vector<int> dependents;
+    std::ostringstream output;
+    std::exception_ptr error;
+    bool ran = false;
+    double start = 0;
+    double time = 0;
+    long cumulativePeakRSS = 0;
+    long peakRSSGrowth = 0;
+  };
+
+  void execute(int task, std::chrono::steady_clock::time_point origin);
+
+  std::vector<std::unique_ptr<Task>> tasks;
+  double elapsed = 0;
+  unsigned traceGranularity = 500;
+};
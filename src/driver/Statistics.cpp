@@ -0,0 +1,93 @@
+#include "Statistics.h"
+
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <set>
+
+namespace {
+
+void printString(std::ostream &os, std::string const &s) {
+  os << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+}
+
+void printValue(std::ostream &os, double value) {
+  if (std::trunc(value) == value && std::fabs(value) < 1e15) {
+    os << static_cast<long long>(value);
+  } else {
+    os << std::fixed << std::setprecision(3) << value << std::defaultfloat;
+  }
+}
+
+void printCounters(std::ostream &os, std::map<std::string, double> const &counters, int indent) {
+  os << "{";
+  bool first = true;
+  for (auto &counter : counters) {
+    os << (first ? "\n" : ",\n") << std::string(indent + 2, ' ');
+    printString(os, counter.first);
+    os << ": ";
+    printValue(os, counter.second);
+    first = false;
+  }
+  os << "\n" << std::string(indent, ' ') << "}";
+}
+
+}
+
+void Statistics::set(std::string const &section, std::string const &counter, double value) {
+  std::lock_guard<std::mutex> lock(mutex);
+  assert(tables.count(section) == 0);
+  sections[section][counter] = value;
+}
+
+void Statistics::set(std::string const &table, std::string const &row, std::string const &counter, double value) {
+  std::lock_guard<std::mutex> lock(mutex);
+  assert(sections.count(table) == 0);
+  tables[table][row][counter] = value;
+}
+
+void Statistics::print(std::ostream &os) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::set<std::string> names;
+  for (auto &section : sections) {
+    names.insert(section.first);
+  }
+  for (auto &table : tables) {
+    names.insert(table.first);
+  }
+
+  os << "{";
+  bool first = true;
+  for (auto &name : names) {
+    os << (first ? "\n" : ",\n") << "  ";
+    printString(os, name);
+    os << ": ";
+    auto section = sections.find(name);
+    if (section != sections.end()) {
+      printCounters(os, section->second, 2);
+    } else {
+      os << "{";
+      bool firstRow = true;
+      for (auto &row : tables.at(name)) {
+        os << (firstRow ? "\n" : ",\n") << "    ";
+        printString(os, row.first);
+        os << ": ";
+        printCounters(os, row.second, 4);
+        firstRow = false;
+      }
+      os << "\n  }";
+    }
+    first = false;
+  }
+  os << "\n}\n";
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+/*! \class Statistics
+ *  \brief Counters gathered across the phases of the compiler, reported as JSON.
+ *
+ * Counters are grouped in sections.  A section holds either counters or a
+ * table of rows, e.g., one per function, each with counters of its own.
+ * Phases may record counters concurrently.  Sections, rows and counters are
+ * reported in order of their names, so the report does not depend on the
+ * order in which the counters were recorded.
+ */
+class Statistics {
+public:
+  /*! \brief Record a counter of a section.
+   * \param section The name of the section
+   * \param counter The name of the counter
+   * \param value The value of the counter, replacing any earlier value
+   */
+  void set(std::string const &section, std::string const &counter, double value);
+
+  /*! \brief Record a counter of a row of a table.
+   * \param table The name of the section holding the table
+   * \param row The name of the row
+   * \param counter The name of the counter
+   * \param value The value of the counter, replacing any earlier value
+   */
+  void set(std::string const &table, std::string const &row, std::string const &counter, double value);
+
+  /*! \brief Write the counters as a JSON object with a member per section.
+   *
+   * Integral values are written as integers.
+   */
+  void print(std::ostream &os) const;
+
+private:
+  using Counters = std::map<std::string, double>;
+
+  mutable std::mutex mutex;
+  std::map<std::string, Counters> sections;
+  std::map<std::string, std::map<std::string, Counters>> tables;
+};
@@ -8,6 +8,7 @@
 #include "ASTVisualizer.h"
 
 #include "loguru.hpp"
+#include "llvm/Support/TimeProfiler.h"
 
 using namespace std;
 using namespace antlr4;
@@ -25,7 +26,7 @@ void ParserErrorListener::syntaxError(Recognizer *recognizer, Token *offendingSy
 }
 
 
-std::unique_ptr<ASTProgram> FrontEnd::parse(std::istream& stream){
+std::unique_ptr<ASTProgram> FrontEnd::parse(std::istream& stream, bool useArena){
   ANTLRInputStream input(stream);
   TIPLexer lexer(&input);
   CommonTokenStream tokens(&lexer);
@@ -43,12 +44,17 @@ std::unique_ptr<ASTProgram> FrontEnd::parse(std::istream& stream){
 
   LOG_S(1) << "Parsing program";
 
-  TIPParser::ProgramContext *tree = parser.program();
+  TIPParser::ProgramContext *tree;
+  {
+    llvm::TimeTraceScope scope("ParseTree");
+    tree = parser.program();
+  }
 
   LOG_S(1) << "Building AST";
 
+  llvm::TimeTraceScope scope("ASTBuilder");
   ASTBuilder ab(&parser);
-  return ab.build(tree);
+  return ab.build(tree, useArena);
 }
 
 void FrontEnd::prettyprint(ASTProgram* program, std::ostream& os) {
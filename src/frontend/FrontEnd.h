@@ -40,9 +40,11 @@ public:
    * exception.  In the absence of errors, ownership of the generated AST is 
    * transfered to the caller.
    * \param stream the input stream holding the program text.
+   * \param useArena allocate the nodes of the AST from an arena owned by the program.
    * \return the generated AST.
+   * \sa ASTArena
    */
-  static std::unique_ptr<ASTProgram> parse(std::istream& stream);
+  static std::unique_ptr<ASTProgram> parse(std::istream& stream, bool useArena = false);
 
   /*! \fn print
    *  \brief Print program in a standard form to cout.
@@ -83,14 +83,41 @@ static std::unique_ptr<ASTFunction> visitedFunction = nullptr;
  * You will access these from the method overrides in your visitor.
  */
 
-std::unique_ptr<ASTProgram> ASTBuilder::build(TIPParser::ProgramContext *ctx) {
+std::unique_ptr<ASTProgram> ASTBuilder::build(TIPParser::ProgramContext *ctx, bool useArena) {
+  // Declared first so that it outlives the functions if building fails
+  std::shared_ptr<ASTArena> arena;
+  if (useArena) {
+    arena = std::make_shared<ASTArena>();
+  }
+
+  // Partially built nodes left in the globals must not outlive the arena
+  auto clearVisited = []() {
+    visitedStmt.reset();
+    visitedDeclNode.reset();
+    visitedDeclStmt.reset();
+    visitedExpr.reset();
+    visitedFieldExpr.reset();
+    visitedFunction.reset();
+  };
+
   std::vector<std::unique_ptr<ASTFunction>> pFunctions;
-  for (auto fn : ctx->function()) {
-    visit(fn);
-    pFunctions.push_back(std::move(visitedFunction));
+  {
+    ASTArena::Scope scope(arena.get());
+    try {
+      for (auto fn : ctx->function()) {
+        visit(fn);
+        pFunctions.push_back(std::move(visitedFunction));
+      }
+    } catch (...) {
+      clearVisited();
+      throw;
+    }
+    clearVisited();
   }
 
+  // The program itself lives on the heap since it owns the arena
   auto prog = std::make_unique<ASTProgram>(std::move(pFunctions));
+  prog->setArena(arena);
   prog->setName(generateSHA256(ctx->getText()));
   return prog;
 }
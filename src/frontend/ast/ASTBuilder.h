@@ -31,8 +31,10 @@ public:
    *  \brief Builds an instance of ASTProgram from an ANTLR4 parse tree.
    *
    * The caller obtains "ownership" of the resulting ASTProgram.
+   * \param ctx The parse tree of the program
+   * \param useArena Allocate the nodes of the program from an ASTArena
    */
-  std::unique_ptr<ASTProgram> build(TIPParser::ProgramContext *ctx);
+  std::unique_ptr<ASTProgram> build(TIPParser::ProgramContext *ctx, bool useArena = false);
 
   /**
    * a helper function to build binary expressions
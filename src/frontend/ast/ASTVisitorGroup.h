@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ASTVisitor.h"
+#include <vector>
+
+/*! \brief Runs several AST visitors in a single traversal.
+ *
+ * Passes that do not depend on each other's results can share one walk of
+ * the AST rather than each performing their own.  At every node the group
+ * calls visit, and later endVisit, on each of its members in the order they
+ * were given, so a member that raises an error does so before later members
+ * see the node.
+ *
+ * The group descends into the children of a node if any member asks to.
+ * A member whose visit returns false is not shown the nodes below that node,
+ * but its endVisit for the node itself is still called, exactly as when it
+ * is used on its own.
+ *
+ * The group does not own its members.
+ */
+class ASTVisitorGroup : public ASTVisitor {
+  struct Member {
+    ASTVisitor * visitor;
+    // Depth of the subtree the member declined to visit, 0 if it is active
+    int skipped;
+  };
+  std::vector<Member> members;
+
+  template <typename T> bool enter(T * element) {
+    bool descend = false;
+    for (auto &m : members) {
+      if (m.skipped > 0) {
+        m.skipped++;
+      } else if (m.visitor->visit(element)) {
+        descend = true;
+      } else {
+        m.skipped = 1;
+      }
+    }
+    return descend;
+  }
+
+  template <typename T> void leave(T * element) {
+    for (auto &m : members) {
+      if (m.skipped > 1) {
+        m.skipped--;
+        continue;
+      }
+      m.skipped = 0;
+      m.visitor->endVisit(element);
+    }
+  }
+
+public:
+  explicit ASTVisitorGroup(std::vector<ASTVisitor *> visitors) {
+    for (auto v : visitors) {
+      members.push_back({v, 0});
+    }
+  }
+
+  bool visit(ASTProgram * element) override { return enter(element); }
+  void endVisit(ASTProgram * element) override { leave(element); }
+  bool visit(ASTFunction * element) override { return enter(element); }
+  void endVisit(ASTFunction * element) override { leave(element); }
+  bool visit(ASTNumberExpr * element) override { return enter(element); }
+  void endVisit(ASTNumberExpr * element) override { leave(element); }
+  bool visit(ASTVariableExpr * element) override { return enter(element); }
+  void endVisit(ASTVariableExpr * element) override { leave(element); }
+  bool visit(ASTBinaryExpr * element) override { return enter(element); }
+  void endVisit(ASTBinaryExpr * element) override { leave(element); }
+  bool visit(ASTInputExpr * element) override { return enter(element); }
+  void endVisit(ASTInputExpr * element) override { leave(element); }
+  bool visit(ASTFunAppExpr * element) override { return enter(element); }
+  void endVisit(ASTFunAppExpr * element) override { leave(element); }
+  bool visit(ASTAllocExpr * element) override { return enter(element); }
+  void endVisit(ASTAllocExpr * element) override { leave(element); }
+  bool visit(ASTFreeStmt * element) override { return enter(element); }
+  void endVisit(ASTFreeStmt * element) override { leave(element); }
+  bool visit(ASTRefExpr * element) override { return enter(element); }
+  void endVisit(ASTRefExpr * element) override { leave(element); }
+  bool visit(ASTDeRefExpr * element) override { return enter(element); }
+  void endVisit(ASTDeRefExpr * element) override { leave(element); }
+  bool visit(ASTNullExpr * element) override { return enter(element); }
+  void endVisit(ASTNullExpr * element) override { leave(element); }
+  bool visit(ASTFieldExpr * element) override { return enter(element); }
+  void endVisit(ASTFieldExpr * element) override { leave(element); }
+  bool visit(ASTRecordExpr * element) override { return enter(element); }
+  void endVisit(ASTRecordExpr * element) override { leave(element); }
+  bool visit(ASTAccessExpr * element) override { return enter(element); }
+  void endVisit(ASTAccessExpr * element) override { leave(element); }
+  bool visit(ASTDeclNode * element) override { return enter(element); }
+  void endVisit(ASTDeclNode * element) override { leave(element); }
+  bool visit(ASTDeclStmt * element) override { return enter(element); }
+  void endVisit(ASTDeclStmt * element) override { leave(element); }
+  bool visit(ASTAssignStmt * element) override { return enter(element); }
+  void endVisit(ASTAssignStmt * element) override { leave(element); }
+  bool visit(ASTWhileStmt * element) override { return enter(element); }
+  void endVisit(ASTWhileStmt * element) override { leave(element); }
+  bool visit(ASTIfStmt * element) override { return enter(element); }
+  void endVisit(ASTIfStmt * element) override { leave(element); }
+  bool visit(ASTOutputStmt * element) override { return enter(element); }
+  void endVisit(ASTOutputStmt * element) override { leave(element); }
+  bool visit(ASTReturnStmt * element) override { return enter(element); }
+  void endVisit(ASTReturnStmt * element) override { leave(element); }
+  bool visit(ASTErrorStmt * element) override { return enter(element); }
+  void endVisit(ASTErrorStmt * element) override { leave(element); }
+  bool visit(ASTBlockStmt * element) override { return enter(element); }
+  void endVisit(ASTBlockStmt * element) override { leave(element); }
+};
@@ -19,10 +19,14 @@ Iterator SyntaxTree::end(const std::string &order) {
   return Iterator(testIterator);
 } // LCOV_EXCL_LINE
 
+/*
+ * The subtrees share ownership of the root rather than taking their own
+ * reference to each child, which would require copying the children.
+ */
 std::vector<SyntaxTree> SyntaxTree::getSubtrees() {
   std::vector<SyntaxTree> subtrees;
-  for(auto child : root->getChildren()) {
-    subtrees.push_back(SyntaxTree(child));
+  for(auto child : root->children()) {
+    subtrees.push_back(SyntaxTree(std::shared_ptr<ASTNode>(root, child)));
   }
 
   return subtrees;
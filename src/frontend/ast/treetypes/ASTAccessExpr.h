@@ -1,17 +1,22 @@
 #pragma once
 
 #include "ASTExpr.h"
+#include "IdentifierTable.h"
 
 /*! \brief Class for a record field access
  */
 class ASTAccessExpr : public ASTExpr {
   std::shared_ptr<ASTExpr> RECORD;
-  std::string FIELD;
+  int FIELD;
+  ASTNode *CHILDREN[1];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTAccessExpr(std::unique_ptr<ASTExpr> RECORD, const std::string &FIELD)
-      : RECORD(std::move(RECORD)), FIELD(FIELD) {}
-  std::string getField() const { return FIELD; }
+      : RECORD(std::move(RECORD)), FIELD(IdentifierTable::intern(FIELD)),
+        CHILDREN{this->RECORD.get()} {}
+  const std::string &getField() const { return IdentifierTable::name(FIELD); }
+  int getFieldId() const { return FIELD; }
   ASTExpr* getRecord() const { return RECORD.get(); }
   void accept(ASTVisitor * visitor) override;
   llvm::Value* codegen() override;
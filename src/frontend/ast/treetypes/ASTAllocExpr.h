@@ -6,9 +6,11 @@
  */
 class ASTAllocExpr : public ASTExpr {
   std::shared_ptr<ASTExpr> INIT;
+  ASTNode *CHILDREN[1];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
-  ASTAllocExpr(std::unique_ptr<ASTExpr> INIT) : INIT(std::move(INIT)) {}
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
+  ASTAllocExpr(std::unique_ptr<ASTExpr> INIT) : INIT(std::move(INIT)), CHILDREN{this->INIT.get()} {}
   ASTExpr* getInitializer() const { return INIT.get(); }
   void accept(ASTVisitor * visitor) override;
   llvm::Value* codegen() override;
@@ -0,0 +1,137 @@
+#include "ASTArena.h"
+#include "ASTNode.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <unordered_set>
+
+thread_local ASTArena *ASTArena::current = nullptr;
+
+namespace {
+
+constexpr std::size_t align(std::size_t size, std::size_t alignment) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/*
+ * The addresses of the blocks of every live arena.  Blocks are aligned to
+ * their size, and a node is never larger than a block, so the block that
+ * holds an arena node starts at the node's address rounded down to the
+ * block size.  Deleting a node can therefore tell arena memory from heap
+ * memory by its address, with no header in front of the node.
+ *
+ * The registry is never destroyed, so that nodes may be deleted at exit.
+ */
+struct BlockRegistry {
+  std::shared_mutex mutex;
+  std::unordered_set<std::uintptr_t> blocks;
+  std::atomic<std::size_t> size{0};
+};
+
+BlockRegistry &registry() {
+  static auto blocks = new BlockRegistry;
+  return *blocks;
+}
+
+}
+
+ASTArena::~ASTArena() {
+  auto &r = registry();
+  {
+    std::unique_lock<std::shared_mutex> lock(r.mutex);
+    for (auto block : blocks) {
+      r.blocks.erase(reinterpret_cast<std::uintptr_t>(block));
+    }
+    r.size = r.blocks.size();
+  }
+  for (auto block : blocks) {
+    ::operator delete(block, std::align_val_t(BLOCK_SIZE));
+  }
+}
+
+// New blocks are aligned for any fundamental type, so they need no padding
+void *ASTArena::allocate(std::size_t size, std::size_t alignment) {
+  auto address = reinterpret_cast<std::uintptr_t>(next);
+  auto padding = align(address, alignment) - address;
+  if (padding + size > remaining) {
+    auto blockSize = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+    auto block = static_cast<char *>(::operator new(blockSize, std::align_val_t(BLOCK_SIZE)));
+    blocks.push_back(block);
+    auto &r = registry();
+    {
+      std::unique_lock<std::shared_mutex> lock(r.mutex);
+      r.blocks.insert(reinterpret_cast<std::uintptr_t>(block));
+      r.size = r.blocks.size();
+    }
+    next = block;
+    remaining = blockSize;
+    padding = 0;
+  }
+  void *p = next + padding;
+  next += padding + size;
+  remaining -= padding + size;
+  allocated += padding + size;
+  return p;
+}
+
+bool ASTArena::holds(const void *node) {
+  auto &r = registry();
+  if (r.size == 0) {
+    return false;
+  }
+  auto block = reinterpret_cast<std::uintptr_t>(node) & ~(BLOCK_SIZE - 1);
+  std::shared_lock<std::shared_mutex> lock(r.mutex);
+  return r.blocks.count(block) != 0;
+}
+
+// No node type is over-aligned, so nodes are packed at the alignment of ASTNode
+void *ASTNode::operator new(std::size_t size) {
+  if (auto arena = ASTArena::active()) {
+    return arena->allocate(size, alignof(ASTNode));
+  }
+  return ::operator new(size);
+}
+
+void ASTNode::operator delete(void *node) {
+  if (node != nullptr && !ASTArena::holds(node)) {
+    ::operator delete(node);
+  }
+}
+
+// A copy of a node shares its children, so a copy of the list only copies the pointers
+ASTChildList &ASTChildList::operator=(const ASTChildList &other) {
+  if (this != &other) {
+    set(other);
+  }
+  return *this;
+}
+
+ASTChildList::~ASTChildList() {
+  if (ownsNodes) {
+    delete[] nodes;
+  }
+}
+
+void ASTChildList::set(llvm::ArrayRef<ASTNode*> list) {
+  if (ownsNodes) {
+    delete[] nodes;
+  }
+  nodes = nullptr;
+  ownsNodes = false;
+  size = list.size();
+  if (list.empty()) {
+    return;
+  }
+
+  if (auto arena = ASTArena::active()) {
+    nodes = static_cast<ASTNode **>(arena->allocate(list.size() * sizeof(ASTNode *), alignof(ASTNode *)));
+  } else {
+    nodes = new ASTNode *[list.size()];
+    ownsNodes = true;
+  }
+  std::copy(list.begin(), list.end(), nodes);
+}
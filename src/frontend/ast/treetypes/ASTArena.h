@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/*! \class ASTArena
+ *  \brief A bump allocator for the nodes of a program's AST.
+ *
+ * While an arena is active on a thread, see ASTArena::Scope, every ASTNode
+ * created with new on that thread is carved out of large blocks owned by
+ * the arena rather than allocated individually on the heap.  Nodes are
+ * still owned by their parents through smart pointers, and deleting an
+ * arena node runs its destructor but does not release its memory; the
+ * memory is released all at once when the arena is destroyed.
+ *
+ * The arena must therefore outlive every node allocated from it.  An
+ * ASTProgram holds on to the arena its functions were built in, so this
+ * holds as long as clients do not retain nodes past the life of the program.
+ */
+class ASTArena {
+  std::vector<char *> blocks;
+  char *next = nullptr;
+  std::size_t remaining = 0;
+  std::size_t allocated = 0;
+
+  static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+  static thread_local ASTArena *current;
+
+public:
+  ASTArena() = default;
+  ASTArena(const ASTArena &) = delete;
+  ASTArena &operator=(const ASTArena &) = delete;
+  ~ASTArena();
+
+  /*! \brief Allocate memory from the arena.
+   * \param size The number of bytes to allocate
+   * \param alignment The alignment of the memory, a power of two
+   * \return Memory aligned to alignment, by default for any fundamental type
+   */
+  void *allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+  //! \brief Return the number of bytes handed out by the arena.
+  std::size_t bytesAllocated() const { return allocated; }
+
+  //! \brief Return the number of blocks held by the arena.
+  std::size_t numBlocks() const { return blocks.size(); }
+
+  /*! \brief Return whether a node was allocated from some live arena.
+   *
+   * This looks at the address alone, so it holds for a node whose
+   * construction has failed as well as for one that is being deleted.
+   * \param node The address of a node returned by operator new
+   */
+  static bool holds(const void *node);
+
+  //! \brief Return the arena active on this thread, or nullptr if there is none.
+  static ASTArena *active() { return current; }
+
+  /*! \class Scope
+   *  \brief Makes an arena active on this thread for the lifetime of the scope.
+   *
+   * Scopes nest, and a scope for a nullptr arena restores heap allocation.
+   */
+  class Scope {
+    ASTArena *previous;
+  public:
+    explicit Scope(ASTArena *arena) : previous(current) { current = arena; }
+    ~Scope() { current = previous; }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+};
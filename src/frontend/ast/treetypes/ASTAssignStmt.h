@@ -7,10 +7,12 @@
  */
 class ASTAssignStmt : public ASTStmt {
   std::shared_ptr<ASTExpr> LHS, RHS;
+  ASTNode *CHILDREN[2];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTAssignStmt(std::unique_ptr<ASTExpr> LHS, std::unique_ptr<ASTExpr> RHS)
-      : LHS(std::move(LHS)), RHS(std::move(RHS)) {}
+      : LHS(std::move(LHS)), RHS(std::move(RHS)), CHILDREN{this->LHS.get(), this->RHS.get()} {}
   ASTExpr* getLHS() const { return LHS.get(); }
   ASTExpr* getRHS() const { return RHS.get(); }
   void accept(ASTVisitor * visitor) override;
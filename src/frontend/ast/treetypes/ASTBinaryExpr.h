@@ -7,11 +7,14 @@
 class ASTBinaryExpr : public ASTExpr {
   std::string OP;
   std::shared_ptr<ASTExpr> LEFT, RIGHT;
+  ASTNode *CHILDREN[2];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTBinaryExpr(const std::string &OP, std::unique_ptr<ASTExpr> LEFT,
              std::unique_ptr<ASTExpr> RIGHT)
-      : OP(OP), LEFT(std::move(LEFT)), RIGHT(std::move(RIGHT)) {}
+      : OP(OP), LEFT(std::move(LEFT)), RIGHT(std::move(RIGHT)),
+        CHILDREN{this->LEFT.get(), this->RIGHT.get()} {}
   std::string getOp() const { return OP; }
   ASTExpr* getLeft() const { return LEFT.get(); }
   ASTExpr* getRight() const { return RIGHT.get(); }
@@ -7,6 +7,10 @@ ASTBlockStmt::ASTBlockStmt(std::vector<std::unique_ptr<ASTStmt>> STMTS) {
     std::shared_ptr<ASTStmt> s = std::move(stmt);
     this->STMTS.push_back(s);
   }
+
+  std::vector<ASTNode*> nodes;
+  appendRawRefs(nodes, this->STMTS);
+  CHILDREN.set(nodes);
 }
 
 std::vector<ASTStmt*> ASTBlockStmt::getStmts() const {
@@ -15,7 +19,7 @@ std::vector<ASTStmt*> ASTBlockStmt::getStmts() const {
 
 void ASTBlockStmt::accept(ASTVisitor * visitor) {
   if (visitor->visit(this)) {
-    for (auto s : getStmts()) {
+    for (auto &s : STMTS) {
       s->accept(visitor);
     }
   }
@@ -6,8 +6,10 @@
  */
 class ASTBlockStmt : public ASTStmt {
   std::vector<std::shared_ptr<ASTStmt>> STMTS;
+  ASTChildList CHILDREN;
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTBlockStmt(std::vector<std::unique_ptr<ASTStmt>> STMTS);
   std::vector<ASTStmt*> getStmts() const;
   void accept(ASTVisitor * visitor) override;
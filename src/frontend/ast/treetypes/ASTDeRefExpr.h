@@ -6,9 +6,11 @@
  */
 class ASTDeRefExpr : public ASTExpr {
   std::shared_ptr<ASTExpr> PTR;
+  ASTNode *CHILDREN[1];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
-  ASTDeRefExpr(std::unique_ptr<ASTExpr> PTR) : PTR(std::move(PTR)) {}
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
+  ASTDeRefExpr(std::unique_ptr<ASTExpr> PTR) : PTR(std::move(PTR)), CHILDREN{this->PTR.get()} {}
   ASTExpr* getPtr() const { return PTR.get(); }
   void accept(ASTVisitor * visitor) override;
   llvm::Value* codegen() override;
@@ -1,14 +1,22 @@
 #pragma once
 
 #include "ASTNode.h"
+#include "IdentifierTable.h"
 
 /*! \brief Class for declaring a name, e.g., function, parameter, variable
+ *
+ * Symbol analysis numbers every declaration in the program densely so that
+ * later phases can keep per-declaration state in vectors.
  */
 class ASTDeclNode : public ASTNode {
-  std::string NAME;
+  int ID;
+  int INDEX = -1;
 public:
-  ASTDeclNode(std::string NAME) : NAME(NAME) {}
-  std::string getName() const { return NAME; }
+  ASTDeclNode(const std::string &NAME) : ID(IdentifierTable::intern(NAME)) {}
+  const std::string &getName() const { return IdentifierTable::name(ID); }
+  int getId() const { return ID; }
+  int getIndex() const { return INDEX; }
+  void setIndex(int index) { INDEX = index; }
   void accept(ASTVisitor * visitor) override;
   llvm::Value* codegen() override;
 
@@ -7,6 +7,10 @@ ASTDeclStmt::ASTDeclStmt(std::vector<std::unique_ptr<ASTDeclNode>> VARS) {
     std::shared_ptr<ASTDeclNode> d = std::move(var);
     this->VARS.push_back(d);
   }
+
+  std::vector<ASTNode*> nodes;
+  appendRawRefs(nodes, this->VARS);
+  CHILDREN.set(nodes);
 }
 
 std::vector<ASTDeclNode*> ASTDeclStmt::getVars() const {
@@ -15,7 +19,7 @@ std::vector<ASTDeclNode*> ASTDeclStmt::getVars() const {
 
 void ASTDeclStmt::accept(ASTVisitor * visitor) {
   if (visitor->visit(this)) {
-    for (auto v : getVars()) {
+    for (auto &v : VARS) {
       v->accept(visitor);
     }
   }
@@ -7,8 +7,10 @@
  */
 class ASTDeclStmt : public ASTStmt {
   std::vector<std::shared_ptr<ASTDeclNode>> VARS;
+  ASTChildList CHILDREN;
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTDeclStmt(std::vector<std::unique_ptr<ASTDeclNode>> VARS);
   std::vector<ASTDeclNode*> getVars() const;
   void accept(ASTVisitor * visitor) override;
@@ -1,17 +1,21 @@
 #pragma once
 
 #include "ASTExpr.h"
+#include "IdentifierTable.h"
 
 /*! \brief Class for the field of a record
  */
 class ASTFieldExpr : public ASTExpr {
-  std::string FIELD;
+  int FIELD;
   std::shared_ptr<ASTExpr> INIT;
+  ASTNode *CHILDREN[1];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTFieldExpr(const std::string &FIELD, std::unique_ptr<ASTExpr> INIT)
-      : FIELD(FIELD), INIT(std::move(INIT)) {}
-  std::string getField() const { return FIELD; }
+      : FIELD(IdentifierTable::intern(FIELD)), INIT(std::move(INIT)), CHILDREN{this->INIT.get()} {}
+  const std::string &getField() const { return IdentifierTable::name(FIELD); }
+  int getFieldId() const { return FIELD; }
   ASTExpr* getInitializer() const { return INIT.get(); }
   void accept(ASTVisitor * visitor) override;
   llvm::Value* codegen() override;
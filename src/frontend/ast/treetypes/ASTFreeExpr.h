@@ -7,9 +7,11 @@
  */
 class ASTFreeStmt : public ASTStmt {
     std::shared_ptr<ASTExpr> ARG;
+  ASTNode *CHILDREN[1];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
-  ASTFreeStmt(std::unique_ptr<ASTExpr> ARG) : ARG(std::move(ARG)) {}
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
+  ASTFreeStmt(std::unique_ptr<ASTExpr> ARG) : ARG(std::move(ARG)), CHILDREN{this->ARG.get()} {}
   ASTExpr* getArg() const { return ARG.get(); }
   void accept(ASTVisitor * visitor) override;
   llvm::Value* codegen() override;
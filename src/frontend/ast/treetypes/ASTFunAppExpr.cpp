@@ -1,4 +1,5 @@
 #include "ASTFunAppExpr.h"
+#include "ASTinternal.h"
 
 ASTFunAppExpr::ASTFunAppExpr(std::unique_ptr<ASTExpr> FUN, std::vector<std::unique_ptr<ASTExpr>> ACTUALS) {
   this->FUN = std::move(FUN);
@@ -7,9 +8,12 @@ ASTFunAppExpr::ASTFunAppExpr(std::unique_ptr<ASTExpr> FUN, std::vector<std::uniq
     std::shared_ptr<ASTExpr> a = std::move(actual);
     this->ACTUALS.push_back(a);
   }
+
+  std::vector<ASTNode*> nodes = {this->FUN.get()};
+  appendRawRefs(nodes, this->ACTUALS);
+  CHILDREN.set(nodes);
 }
 #include "ASTVisitor.h"
-#include "ASTinternal.h"
 
 std::vector<ASTExpr*> ASTFunAppExpr::getActuals() const {
   return rawRefs(ACTUALS);
@@ -18,7 +22,7 @@ std::vector<ASTExpr*> ASTFunAppExpr::getActuals() const {
 void ASTFunAppExpr::accept(ASTVisitor * visitor) {
   if (visitor->visit(this)) {
     getFunction()->accept(visitor);
-    for (auto a : getActuals()) {
+    for (auto &a : ACTUALS) {
       a->accept(visitor);
     }
   }
@@ -7,8 +7,10 @@
 class ASTFunAppExpr : public ASTExpr {
   std::shared_ptr<ASTExpr> FUN;
   std::vector<std::shared_ptr<ASTExpr>> ACTUALS;
+  ASTChildList CHILDREN;
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTFunAppExpr(std::unique_ptr<ASTExpr> FUN, std::vector<std::unique_ptr<ASTExpr>> ACTUALS);
   ASTExpr* getFunction() const { return FUN.get(); }
   std::vector<ASTExpr*> getActuals() const;
@@ -21,6 +21,12 @@ ASTFunction::ASTFunction(std::unique_ptr<ASTDeclNode> DECL, std::vector<std::uni
     std::shared_ptr<ASTStmt> s = std::move(stmt);
     this->BODY.push_back(s);
   }
+
+  std::vector<ASTNode*> nodes = {this->DECL.get()};
+  appendRawRefs(nodes, this->FORMALS);
+  appendRawRefs(nodes, this->DECLS);
+  appendRawRefs(nodes, this->BODY);
+  CHILDREN.set(nodes);
 }
 
 std::vector<ASTDeclNode*> ASTFunction::getFormals() const {
@@ -38,13 +44,13 @@ std::vector<ASTStmt*> ASTFunction::getStmts() const {
 void ASTFunction::accept(ASTVisitor * visitor) {
   if (visitor->visit(this)) {
     getDecl()->accept(visitor);
-    for (auto p : getFormals()) {
+    for (auto &p : FORMALS) {
       p->accept(visitor);
     }
-    for (auto d : getDeclarations()) {
+    for (auto &d : DECLS) {
       d->accept(visitor);
     }
-    for (auto s : getStmts()) {
+    for (auto &s : BODY) {
       s->accept(visitor);
     }
   }
@@ -12,15 +12,17 @@ class ASTFunction : public ASTNode {
   std::vector<std::shared_ptr<ASTDeclNode>> FORMALS;
   std::vector<std::shared_ptr<ASTDeclStmt>> DECLS;
   std::vector<std::shared_ptr<ASTStmt>> BODY;
+  ASTChildList CHILDREN;
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTFunction(std::unique_ptr<ASTDeclNode> DECL, 
            std::vector<std::unique_ptr<ASTDeclNode>> FORMALS,
            const std::vector<std::unique_ptr<ASTDeclStmt>>& DECLS,
            std::vector<std::unique_ptr<ASTStmt>> BODY);
   ~ASTFunction()=default;
   ASTDeclNode* getDecl() const { return DECL.get(); };
-  std::string getName() const { return DECL->getName(); };
+  const std::string &getName() const { return DECL->getName(); };
   std::vector<ASTDeclNode*> getFormals() const;
   std::vector<ASTDeclStmt*> getDeclarations() const;
   std::vector<ASTStmt*> getStmts() const;
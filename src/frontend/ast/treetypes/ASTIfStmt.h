@@ -8,11 +8,16 @@
 class ASTIfStmt : public ASTStmt {
   std::shared_ptr<ASTExpr> COND;
   std::shared_ptr<ASTStmt> THEN, ELSE;
+  ASTNode *CHILDREN[3];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override {
+    return {CHILDREN, ELSE != nullptr ? 3u : 2u};
+  }
   ASTIfStmt(std::unique_ptr<ASTExpr> COND, std::unique_ptr<ASTStmt> THEN,
             std::unique_ptr<ASTStmt> ELSE)
-      : COND(std::move(COND)), THEN(std::move(THEN)), ELSE(std::move(ELSE)) {}
+      : COND(std::move(COND)), THEN(std::move(THEN)), ELSE(std::move(ELSE)),
+        CHILDREN{this->COND.get(), this->THEN.get(), this->ELSE.get()} {}
   ASTExpr* getCondition() const { return COND.get(); }
   ASTStmt* getThen() const { return THEN.get(); }
 
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Value.h"
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -30,13 +32,26 @@ class ASTVisitor;
  *
  * There are two virtual methods that are used in a generic visitor
  * and for code generation pass. 
+ *
+ * Nodes may be allocated from an ASTArena instead of individually on the
+ * heap; this is transparent to the code that creates and owns them.  Each
+ * node with children also lists them as plain pointers, so that walking the
+ * tree through children() neither allocates nor touches reference counts.
+ * \sa ASTArena
  */
 class ASTNode {
   int line = 0;
   int column = 0;
 public:
+  ASTNode() = default;
   virtual ~ASTNode() = default;
 
+  //! \brief Allocate a node from the active ASTArena, or the heap if there is none.
+  static void* operator new(std::size_t size);
+
+  //! \brief Release a node's memory unless it belongs to an ASTArena.
+  static void operator delete(void* node);
+
   /*! \fn accept
    *  \brief Visit the children of this node and apply the visitor.
    *
@@ -72,6 +87,17 @@ public:
   virtual std::vector<std::shared_ptr<ASTNode>> getChildren() {
     return {};
   }
+
+  /*! \fn children
+   *  \brief Return the children of the node without copying them.
+   *
+   * The children are those returned by getChildren, in the same order.
+   * Subclasses with children override it along with getChildren.
+   *
+   * \return a view of the node's list of children.
+   */
+  virtual llvm::ArrayRef<ASTNode*> children() const { return {}; }
+
   void setLocation(int l, int c) { line = l; column = c; }
   int getLine() { return line; }
   int getColumn() { return column; }
@@ -83,3 +109,26 @@ public:
 protected:
   virtual std::ostream& print(std::ostream &out) const = 0;
 };
+
+/*! \class ASTChildList
+ *  \brief The list behind children() for nodes with any number of children.
+ *
+ * Nodes with a fixed number of children list them in an array of their own.
+ * The others keep an ASTChildList, which takes its memory from the arena
+ * active when the list is set, if there is one, and from the heap otherwise.
+ */
+class ASTChildList {
+  ASTNode **nodes = nullptr;
+  std::uint32_t size = 0;
+  bool ownsNodes = false;
+public:
+  ASTChildList() = default;
+  ASTChildList(const ASTChildList &other) { set(other); }
+  ASTChildList &operator=(const ASTChildList &other);
+  ~ASTChildList();
+
+  //! \brief Replace the list with a copy of the given nodes.
+  void set(llvm::ArrayRef<ASTNode*> list);
+
+  operator llvm::ArrayRef<ASTNode*>() const { return {nodes, size}; }
+};
@@ -2,11 +2,20 @@
 #include "ASTVisitor.h"
 #include "ASTinternal.h"
 
+#include <algorithm>
+
 ASTProgram::ASTProgram(std::vector<std::unique_ptr<ASTFunction>> FUNCTIONS) {
   for(auto &func : FUNCTIONS) {
     std::shared_ptr<ASTFunction> f = std::move(func);
     this->FUNCTIONS.push_back(f);
   }
+  setFunctionChildren();
+}
+
+void ASTProgram::setFunctionChildren() {
+  std::vector<ASTNode*> nodes;
+  appendRawRefs(nodes, FUNCTIONS);
+  CHILDREN.set(nodes);
 }
 
 std::vector<ASTFunction*> ASTProgram::getFunctions() const {
@@ -22,9 +31,30 @@ ASTFunction * ASTProgram::findFunctionByName(std::string name) {
     return nullptr;
 }
 
+int ASTProgram::retainFunctions(std::set<ASTFunction*> const &keep) {
+  auto removed = std::remove_if(FUNCTIONS.begin(), FUNCTIONS.end(),
+                                [&keep](auto &f) { return keep.count(f.get()) == 0; });
+  int count = FUNCTIONS.end() - removed;
+  FUNCTIONS.erase(removed, FUNCTIONS.end());
+  setFunctionChildren();
+  return count;
+}
+
+int ASTProgram::getNumNodes() {
+  int count = 1;
+  std::vector<ASTNode*> stack(children().begin(), children().end());
+  while (!stack.empty()) {
+    auto node = stack.back();
+    stack.pop_back();
+    count++;
+    stack.insert(stack.end(), node->children().begin(), node->children().end());
+  }
+  return count;
+}
+
 void ASTProgram::accept(ASTVisitor * visitor) {
   if (visitor->visit(this)) {
-    for (auto f : getFunctions()) {
+    for (auto &f : FUNCTIONS) {
       f->accept(visitor);
     }
   }
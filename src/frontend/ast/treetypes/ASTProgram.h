@@ -1,25 +1,56 @@
 #pragma once
 
 #include "ASTFunction.h"
+#include "ASTArena.h"
 #include <ostream>
+#include <set>
 
 class SemanticAnalysis;
 
 /*! \brief Class for a program which is a name and a list of functions.
  *
+ * A program keeps alive the arena, if any, that its nodes were allocated
+ * from.  The arena is declared first so that it is released only after
+ * all of the functions have been destroyed.
  */
 class ASTProgram: public ASTNode {
+  std::shared_ptr<ASTArena> ARENA;
   std::string name;
   std::vector<std::shared_ptr<ASTFunction>> FUNCTIONS;
+  ASTChildList CHILDREN;
+  void setFunctionChildren();
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTProgram(std::vector<std::unique_ptr<ASTFunction>> FUNCTIONS);
   void setName(std::string n) { name = n; }
+  void setArena(std::shared_ptr<ASTArena> arena) { ARENA = arena; }
+  ASTArena* getArena() const { return ARENA.get(); }
   std::string getName() const { return name; }
   std::vector<ASTFunction*> getFunctions() const;
   ASTFunction * findFunctionByName(std::string);
+
+  /*! \brief Remove the functions that are not in the given set.
+   *
+   * Analyses that refer to the removed functions, such as the symbol table,
+   * must be recomputed.
+   * \return The number of functions removed
+   */
+  int retainFunctions(std::set<ASTFunction*> const &keep);
+
+  //! \brief Return the number of nodes in the program, including the program itself.
+  int getNumNodes();
   void accept(ASTVisitor * visitor) override;
-  std::unique_ptr<llvm::Module> codegen(SemanticAnalysis* st, std::string name);
+
+  /*! \brief Generate an LLVM module for the program.
+   * \param st The semantic analysis of the program
+   * \param name The name of the module
+   * \param typed Whether values are represented by LLVM types derived from their inferred types
+   * \param promoteCalls Whether calls of function values test for the callees found by control flow analysis
+   * \param pooled Whether heap cells are allocated by the pooled allocator of the runtime library
+   */
+  std::unique_ptr<llvm::Module> codegen(SemanticAnalysis* st, std::string name, bool typed = false,
+                                        bool promoteCalls = false, bool pooled = false);
 
 private:
   llvm::Value *codegen() override;
@@ -7,6 +7,10 @@ ASTRecordExpr::ASTRecordExpr(std::vector<std::unique_ptr<ASTFieldExpr>> FIELDS)
     std::shared_ptr<ASTFieldExpr> f = std::move(field);
     this->FIELDS.push_back(f);
   }
+
+  std::vector<ASTNode*> nodes;
+  appendRawRefs(nodes, this->FIELDS);
+  CHILDREN.set(nodes);
 }
 
 std::vector<ASTFieldExpr*> ASTRecordExpr::getFields() const {
@@ -15,7 +19,7 @@ std::vector<ASTFieldExpr*> ASTRecordExpr::getFields() const {
 
 void ASTRecordExpr::accept(ASTVisitor * visitor) {
   if (visitor->visit(this)) {
-    for (auto f : getFields()) {
+    for (auto &f : FIELDS) {
       f->accept(visitor);
     }
   }
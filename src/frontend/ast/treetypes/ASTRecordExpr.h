@@ -7,8 +7,10 @@
  */
 class ASTRecordExpr : public ASTExpr {
   std::vector<std::shared_ptr<ASTFieldExpr>> FIELDS;
+  ASTChildList CHILDREN;
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTRecordExpr(std::vector<std::unique_ptr<ASTFieldExpr>> FIELDS);
   std::vector<ASTFieldExpr*> getFields() const;
   void accept(ASTVisitor * visitor) override;
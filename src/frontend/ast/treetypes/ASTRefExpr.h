@@ -6,9 +6,11 @@
  */
 class ASTRefExpr : public ASTExpr {
   std::shared_ptr<ASTExpr> VAR;
+  ASTNode *CHILDREN[1];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
-  ASTRefExpr(std::unique_ptr<ASTExpr> VAR) : VAR(std::move(VAR)) {}
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
+  ASTRefExpr(std::unique_ptr<ASTExpr> VAR) : VAR(std::move(VAR)), CHILDREN{this->VAR.get()} {}
   ASTExpr* getVar() const { return VAR.get(); }
   void accept(ASTVisitor * visitor) override;
   llvm::Value* codegen() override;
@@ -1,14 +1,24 @@
 #pragma once
 
 #include "ASTExpr.h"
+#include "ASTDeclNode.h"
 
 /*! \brief Class for referencing a variable.
+ *
+ * Symbol analysis binds each reference to the declaration it resolves to,
+ * either a local, a parameter, or a function.
  */
 class ASTVariableExpr : public ASTExpr {
-  std::string NAME;
+  int ID;
+  ASTDeclNode* DECL = nullptr;
+  int DECLINDEX = -1;
 public:
-  ASTVariableExpr(std::string NAME) : NAME(NAME) {}
-  std::string getName() const { return NAME; }
+  ASTVariableExpr(const std::string &NAME) : ID(IdentifierTable::intern(NAME)) {}
+  const std::string &getName() const { return IdentifierTable::name(ID); }
+  int getId() const { return ID; }
+  ASTDeclNode* getDecl() const { return DECL; }
+  int getDeclIndex() const { return DECLINDEX; }
+  void bind(ASTDeclNode* decl) { DECL = decl; DECLINDEX = decl->getIndex(); }
   void accept(ASTVisitor * visitor) override;
   llvm::Value* codegen() override;
 
@@ -8,10 +8,13 @@
 class ASTWhileStmt : public ASTStmt {
   std::shared_ptr<ASTExpr> COND;
   std::shared_ptr<ASTStmt> BODY;
+  ASTNode *CHILDREN[2];
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
+  llvm::ArrayRef<ASTNode*> children() const override { return CHILDREN; }
   ASTWhileStmt(std::unique_ptr<ASTExpr> COND, std::unique_ptr<ASTStmt> BODY)
-      : COND(std::move(COND)), BODY(std::move(BODY)) {}
+      : COND(std::move(COND)), BODY(std::move(BODY)),
+        CHILDREN{this->COND.get(), this->BODY.get()} {}
   ASTExpr* getCondition() const { return COND.get(); }
   ASTStmt* getBody() const { return BODY.get(); }
   void accept(ASTVisitor * visitor) override;
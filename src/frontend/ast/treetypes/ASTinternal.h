@@ -43,3 +43,17 @@ std::vector<T*> rawRefs(const std::vector<std::shared_ptr<T>> &v) {
                  [](auto& up){return up.get();});
   return r;
 }
+
+/*! \fn appendRawRefs
+ *  \brief Append the pointers held by a vector of shared ptrs to a list of nodes.
+ *
+ * This is used to build the list of children that a node keeps for children().
+ * \param nodes the list to extend.
+ * \param v a vector of shared pointers.
+ */
+template<typename T>
+void appendRawRefs(std::vector<ASTNode*> &nodes, const std::vector<std::shared_ptr<T>> &v) {
+  std::transform(v.begin(), v.end(),
+                 std::back_inserter(nodes),
+                 [](auto& sp){return sp.get();});
+}
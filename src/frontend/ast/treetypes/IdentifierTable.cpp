@@ -0,0 +1,12 @@
+#include "IdentifierTable.h"
+
+std::unordered_map<std::string, int> IdentifierTable::ids;
+std::deque<std::string> IdentifierTable::names;
+
+int IdentifierTable::intern(const std::string &name) {
+  auto [it, inserted] = ids.try_emplace(name, names.size());
+  if (inserted) {
+    names.push_back(name);
+  }
+  return it->second;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+/*! \class IdentifierTable
+ *  \brief Interns the identifiers of TIP programs.
+ *
+ * Every name of a function, parameter, local or record field is mapped to
+ * a small integer id the first time it is seen.  AST nodes store the id
+ * instead of a copy of the name, and later phases key their tables by id.
+ * Ids are dense so that such tables can be plain vectors sized by size().
+ *
+ * The table is shared by all programs compiled in a process, so ids are
+ * stable across the phases of a compilation.
+ */
+class IdentifierTable {
+  static std::unordered_map<std::string, int> ids;
+  static std::deque<std::string> names;
+
+public:
+  /*! \brief Return the id of a name, assigning a new one if necessary.
+   * \param name The identifier
+   * \return The id of the identifier
+   */
+  static int intern(const std::string &name);
+
+  /*! \brief Return the name of an interned identifier.
+   * \param id The id of the identifier
+   * \return The identifier
+   */
+  static const std::string &name(int id) { return names[id]; }
+
+  /*! \brief Return the number of interned identifiers.
+   */
+  static int size() { return names.size(); }
+};
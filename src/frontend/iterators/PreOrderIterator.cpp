@@ -30,16 +30,13 @@ void PreOrderIterator::operator++() {
     return;
   }
 
-  SyntaxTree current = stack.top();
+  auto current = stack.top().getRoot();
   stack.pop();
 
-  auto subtrees = current.getSubtrees();
-  if(subtrees.empty()) {
-    return;
-  }
-
-  for(int i = subtrees.size() - 1; i >= 0; i--) {
-    stack.push(subtrees.at(i));
+  // Push the subtrees, which share ownership of the current root, in reverse
+  auto children = current->children();
+  for(auto child = children.rbegin(); child != children.rend(); ++child) {
+    stack.push(SyntaxTree(std::shared_ptr<ASTNode>(current, *child)));
   }
 }
 
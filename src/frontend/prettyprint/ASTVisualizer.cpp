@@ -15,7 +15,7 @@ void ASTVisualizer::buildGraph(SyntaxTree &tree) {
       std::string vertexName = "v"+std::to_string(vertexMap.size());  
       vertexMap.insert(std::pair<ASTNode*, std::string>(node,vertexName));
       declare_node(node, "start");
-      pushn(node, node->getChildren().size());
+      pushn(node, node->children().size());
     } else {
       process_node(node);
     }
@@ -36,7 +36,7 @@ void ASTVisualizer::process_node(ASTNode * element) {
 
   declare_node(element);
   connect_node_to_parent(element);
-  pushn(element, element->getChildren().size());
+  pushn(element, element->children().size());
 }
 
 void ASTVisualizer::declare_node(ASTNode * element, std::string label) {
@@ -0,0 +1,132 @@
+#include "HeapToStack.h"
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+
+#include "loguru.hpp"
+
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+// Larger cells stay on the heap, so that a function's frame stays small
+const uint64_t maxStackCellSize = 1024;
+
+bool isCallTo(CallInst *call, StringRef name, unsigned numArgs) {
+  auto *callee = call->getCalledFunction();
+  return callee != nullptr && callee->getName() == name && call->arg_size() == numArgs;
+}
+
+/*
+ * Follow the pointers derived from a cell to all of their uses, collecting
+ * the calls that free the cell.  The cell escapes if a pointer to it is
+ * stored, passed to a call, returned, converted to an integer, or merged
+ * with other pointers, e.g., by a phi.  Merges are ruled out because the
+ * stack slot is shared by every execution of the allocation, e.g., in
+ * each iteration of a loop.
+ */
+bool escapes(CallInst *cell, std::vector<CallInst *> &frees) {
+  std::vector<Value *> worklist{cell};
+  while (!worklist.empty()) {
+    auto *ptr = worklist.back();
+    worklist.pop_back();
+
+    for (auto *user : ptr->users()) {
+      if (isa<BitCastInst>(user) || isa<GetElementPtrInst>(user)) {
+        worklist.push_back(user);
+      } else if (auto *load = dyn_cast<LoadInst>(user)) {
+        if (load->isVolatile()) {
+          return true;
+        }
+      } else if (auto *store = dyn_cast<StoreInst>(user)) {
+        if (store->isVolatile() || store->getValueOperand() == ptr) {
+          return true;
+        }
+      } else if (auto *cmp = dyn_cast<ICmpInst>(user)) {
+        // Only a test for null does not depend on which execution allocated the cell
+        if (!isa<ConstantPointerNull>(cmp->getOperand(0)) && !isa<ConstantPointerNull>(cmp->getOperand(1))) {
+          return true;
+        }
+      } else if (auto *call = dyn_cast<CallInst>(user)) {
+        if (!isCallTo(call, "free", 1) && !isCallTo(call, "_tip_free", 1)) {
+          return true;
+        }
+        frees.push_back(call);
+      } else {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+class HeapToStack : public FunctionPass {
+public:
+  static char ID;
+  HeapToStack() : FunctionPass(ID) {}
+
+  bool runOnFunction(Function &F) override {
+    std::vector<CallInst *> cells;
+    for (auto &inst : instructions(F)) {
+      if (auto *call = dyn_cast<CallInst>(&inst)) {
+        if (isCallTo(call, "calloc", 2) || isCallTo(call, "_tip_alloc", 1) ||
+            isCallTo(call, "_tip_alloc_zeroed", 1)) {
+          cells.push_back(call);
+        }
+      }
+    }
+
+    bool changed = false;
+    for (auto *cell : cells) {
+      // The cells of the pooled allocator are zeroed only if asked for
+      bool zeroed = !isCallTo(cell, "_tip_alloc", 1);
+      uint64_t bytes = 1;
+      for (auto &arg : cell->args()) {
+        auto *factor = dyn_cast<ConstantInt>(arg);
+        bytes = factor != nullptr ? bytes * factor->getZExtValue() : 0;
+      }
+      if (bytes == 0 || bytes > maxStackCellSize) {
+        continue;
+      }
+
+      std::vector<CallInst *> frees;
+      if (escapes(cell, frees)) {
+        continue;
+      }
+
+      LOG_S(1) << "Moving a cell of " << bytes << " bytes to the stack in " << F.getName().str();
+
+      IRBuilder<> entry(&F.getEntryBlock(), F.getEntryBlock().begin());
+      auto *slot = entry.CreateAlloca(ArrayType::get(entry.getInt8Ty(), bytes), nullptr, "cell");
+      slot->setAlignment(Align(16));
+
+      // A zeroed cell is zeroed each time it is allocated
+      IRBuilder<> builder(cell);
+      auto *ptr = builder.CreatePointerCast(slot, cell->getType());
+      if (zeroed) {
+        builder.CreateMemSet(ptr, builder.getInt8(0), bytes, MaybeAlign(16));
+      }
+
+      cell->replaceAllUsesWith(ptr);
+      cell->eraseFromParent();
+      for (auto *free : frees) {
+        free->eraseFromParent();
+      }
+      changed = true;
+    }
+    return changed;
+  }
+};
+
+char HeapToStack::ID = 0;
+
+} // namespace
+
+FunctionPass *createHeapToStackPass() {
+  return new HeapToStack();
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "llvm/Pass.h"
+
+/*! \brief Create a pass that moves heap cells that do not escape to the stack.
+ *
+ * A cell allocated by calloc, or by the pooled allocator of the runtime
+ * library, whose address is only used to load from and store to the cell,
+ * and to free it, cannot be reached once the function returns.  Such a
+ * cell is replaced by a stack slot in the entry block of the function and
+ * the calls that free it are removed.  Where a zeroed cell was allocated
+ * the slot is zeroed instead.  The slot can then be broken up into
+ * registers by SROA, which also removes cells that are freed without ever
+ * being read.
+ */
+llvm::FunctionPass *createHeapToStackPass();
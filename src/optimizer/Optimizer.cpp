@@ -1,4 +1,5 @@
 #include "Optimizer.h"
+#include "HeapToStack.h"
 
 #include "llvm/Pass.h"
 #include "llvm/IR/Function.h"
@@ -36,6 +37,18 @@ void Optimizer::optimize(Module* theModule) {
   // Simplify the control flow graph (deleting unreachable blocks, etc).
   TheFPM->add(createCFGSimplificationPass());
 
+  /*
+   * Move heap cells that do not escape their function to the stack, break
+   * them up into registers and simplify.  A second round moves the cells
+   * that were only stored in cells moved by the first, e.g., the record of
+   * an alloc of a record.
+   */
+  for (int round = 0; round < 2; round++) {
+    TheFPM->add(createHeapToStackPass());
+    TheFPM->add(createSROAPass());
+    TheFPM->add(createInstructionCombiningPass());
+  }
+
   // initialize and run simplification pass on each function
   TheFPM->doInitialization();
   for (auto &fun : theModule->getFunctionList()) {
@@ -1,12 +1,84 @@
 #include "SemanticAnalysis.h"
 #include "CheckAssignable.h"
+#include "DeadFunctionEliminator.h"
+#include "TypeConstraintCollectVisitor.h"
+#include "ASTVisitorGroup.h"
+#include "loguru.hpp"
+#include "llvm/Support/TimeProfiler.h"
 
-std::unique_ptr<SemanticAnalysis> SemanticAnalysis::analyze(ASTProgram* ast) {
+#include <algorithm>
+
+std::unique_ptr<SemanticAnalysis> SemanticAnalysis::analyze(ASTProgram* ast, unsigned threads,
+                                                            TypeSummaryCache* cache, bool prune,
+                                                            unsigned unifyThreads) {
+  auto analysis = resolve(ast, threads, cache, prune, unifyThreads);
+  analysis->checkTypes();
+  return analysis;
+}
+
+/*
+ * Once names are resolved the assignability check and type constraint
+ * generation are independent of one another, so they share a single walk of
+ * the program and the constraints are kept until the types are checked.
+ * The assignability check runs first at each node and type errors are only
+ * reported when the constraints are solved, so errors are reported in the
+ * same order as when the passes are run one after the other.  When type
+ * constraints are generated on several threads, or the types are inferred
+ * per component of the function references with a cache, they are instead
+ * collected when the types are checked.  Functions that main cannot reach
+ * are removed, when asked, as soon as names are resolved so that no later
+ * phase spends time on them.
+ */
+std::unique_ptr<SemanticAnalysis> SemanticAnalysis::resolve(ASTProgram* ast, unsigned threads,
+                                                            TypeSummaryCache* cache, bool prune,
+                                                            unsigned unifyThreads) {
+  auto symTable = resolveNames(ast, prune);
+  auto analysis = std::make_unique<SemanticAnalysis>(ast, std::move(symTable), threads, cache, unifyThreads);
+
+  if (threads != 1 || cache != nullptr) {
+    LOG_S(1) << "Checking assignability";
+    llvm::TimeTraceScope scope("CheckAssignable");
+    CheckAssignable::check(ast);
+    return analysis;
+  }
+
+  LOG_S(1) << "Checking assignability and collecting constraints";
+  CheckAssignable assignable;
+  TypeConstraintCollectVisitor typeConstraints(analysis->getSymbolTable());
+  {
+    llvm::TimeTraceScope scope("CheckAssignableAndTypeConstraints");
+    ASTVisitorGroup group({&assignable, &typeConstraints});
+    ast->accept(&group);
+  }
+  analysis->constraints = std::move(typeConstraints.getCollectedConstraints());
+  analysis->constraintsCollected = true;
+  return analysis;
+}
+
+std::unique_ptr<SymbolTable> SemanticAnalysis::resolveNames(ASTProgram* ast, bool prune) {
   auto symTable = SymbolTable::build(ast);
-  CheckAssignable::check(ast);
-  auto callGraph = CallGraph::build(ast, symTable.get());
-  auto typeResults = TypeInference::check(ast, symTable.get());
-  return std::make_unique<SemanticAnalysis>(std::move(symTable), std::move(typeResults), std::move(callGraph));
+  if (prune && DeadFunctionEliminator::prune(ast) > 0) {
+    symTable = SymbolTable::build(ast);
+  }
+  return symTable;
+}
+
+void SemanticAnalysis::checkTypes(bool close) {
+  if (typeResults == nullptr) {
+    if (constraintsCollected) {
+      constraintsCollected = false;
+      typeResults = TypeInference::solve(ast, symTable.get(), std::move(constraints), unifyThreads);
+    } else if (cache != nullptr) {
+      CallGraph references(ast->getFunctions(), DeadFunctionEliminator::references(ast));
+      typeResults = TypeInference::checkIncremental(ast, symTable.get(), references.getComponents(),
+                                                    cache, threads, unifyThreads);
+    } else {
+      typeResults = TypeInference::check(ast, symTable.get(), threads, unifyThreads);
+    }
+  }
+  if (close) {
+    typeResults->close();
+  }
 }
 
 SymbolTable* SemanticAnalysis::getSymbolTable() {
@@ -14,9 +86,29 @@ SymbolTable* SemanticAnalysis::getSymbolTable() {
 }; 
 
 TypeInference* SemanticAnalysis::getTypeResults() {
+  checkTypes();
   return typeResults.get();
 }; 
 
 CallGraph* SemanticAnalysis::getCallGraph() {
+  if (callGraph == nullptr) {
+    callGraph = CallGraph::build(ast, symTable.get());
+  }
   return callGraph.get();
 };
+
+/*
+ * The constraints of the whole program are generated on first use, which
+ * takes time linear in its size, and each query solves the ones it needs.
+ * Symbol analysis numbers the functions first, in program order.
+ */
+std::vector<ASTFunction*> SemanticAnalysis::getCallTargets(ASTFunAppExpr* call) {
+  if (controlFlow == nullptr) {
+    controlFlow = std::make_unique<CFAnalyzer>(CFAnalyzer::analyze(ast, symTable.get(), true));
+  }
+  auto targets = controlFlow->getPossibleFunctionsForExpr(call->getFunction(), nullptr);
+  std::sort(targets.begin(), targets.end(), [](ASTFunction *f, ASTFunction *g) {
+    return f->getDecl()->getIndex() < g->getDecl()->getIndex();
+  });
+  return targets;
+}
@@ -7,36 +7,105 @@
 #include <memory>
 #include "cfa/CallGraph.h"  //call graph builder header
 
+class TypeSummaryCache;
+
 /*! \class SemanticAnalysis
  *  \brief Stores the results of semantic analysis passes.
  *
  * This class provides the analyze method to run a set of semantic analyses, including
  * l-value checking for assignment statements, proper use of symbols, and type checking and control flow analysis
+ *
+ * Only the passes that can report errors are run by analyze.  The remaining
+ * results are computed the first time they are requested: the call graph,
+ * which requires the cubic control flow analysis, the possible callees of
+ * single applications, which are solved from the same constraints on demand,
+ * and the closed types of declared names.  By default code generation needs
+ * none of them.  It queries the callees of applications to promote calls of
+ * function values (tipc --promote-calls) and uses the closed types to choose
+ * the representation of values (tipc --typed-codegen), and the types are
+ * also closed to print them.
  * \sa SymbolTable
  * \sa TypeInference
  * \sa CallGraph
  */
 class SemanticAnalysis {
+  ASTProgram* ast;
+  unsigned threads;
+  unsigned unifyThreads;
+  TypeSummaryCache* cache;
   std::unique_ptr<SymbolTable> symTable;
   std::unique_ptr<TypeInference> typeResults;
   std::unique_ptr<CallGraph> callGraph;
+  std::unique_ptr<CFAnalyzer> controlFlow;
 
+  // Type constraints collected while resolving, if they shared its walk.
+  std::vector<TypeConstraint> constraints;
+  bool constraintsCollected = false;
+
+  static std::unique_ptr<SymbolTable> resolveNames(ASTProgram* ast, bool prune);
 
 public:
-  SemanticAnalysis(std::unique_ptr<SymbolTable> s, std::unique_ptr<TypeInference> t, std::unique_ptr<CallGraph> cg)
-          : symTable(std::move(s)), typeResults(std::move(t)), callGraph(std::move(cg)) {}
+  /*! \brief Construct the analysis of a program whose names have been resolved.
+   * \param ast The program AST
+   * \param s The symbol table of the program
+   * \param threads The number of threads used to generate type constraints
+   * \param cache The type summary cache, or nullptr
+   * \param unifyThreads The number of threads used to unify type constraints
+   */
+  SemanticAnalysis(ASTProgram* ast, std::unique_ptr<SymbolTable> s, unsigned threads = 1,
+                   TypeSummaryCache* cache = nullptr, unsigned unifyThreads = 1)
+          : ast(ast), threads(threads), unifyThreads(unifyThreads), cache(cache), symTable(std::move(s)) {}
 
   /*! \fn analyze
    *  \brief Perform semantic analysis on program AST.
    *
-   * Run weeding, symbol, and type checking and control flow analysis.  Errors in any of these
+   * Run weeding, symbol, and type checking.  Errors in any of these
    * result in a SemanticError.  If no errors then ownership of semantic analysis
-   * results are transferred to caller.
+   * results are transferred to caller.  The control flow analysis is run when
+   * the call graph is first requested.
    * \sa SemanticError
    * \param ast The program AST
+   * \param threads The number of threads used to generate type constraints, 0 for one per hardware thread
+   * \param cache If not null, types are inferred one strongly connected component of the
+   * references between functions at a time and the solved types of unchanged components are
+   * taken from the cache
+   * \param prune If true, functions that are not reachable from main are first removed from the program
+   * \param unifyThreads The number of threads used to unify type constraints, 0 for one per hardware
+   * thread.  With more than one, free type variables may be named differently from run to run.
    * \return The unique pointer to the semantic analysis structure.
+   * \sa TypeInference::collect
+   * \sa TypeInference::checkIncremental
+   * \sa DeadFunctionEliminator
+   */
+  static std::unique_ptr<SemanticAnalysis> analyze(ASTProgram* ast, unsigned threads = 1,
+                                                   TypeSummaryCache* cache = nullptr, bool prune = false,
+                                                   unsigned unifyThreads = 1);
+
+  /*! \fn resolve
+   *  \brief Perform the semantic analysis of a program up to, but not including, type checking.
+   *
+   * Run weeding and symbol checking, reporting errors as analyze does.  The types
+   * must then be checked with checkTypes before the program is compiled.  With
+   * one thread and no cache the type constraints are collected in the same walk
+   * as the assignability check and kept for checkTypes.
+   * \sa analyze
+   */
+  static std::unique_ptr<SemanticAnalysis> resolve(ASTProgram* ast, unsigned threads = 1,
+                                                   TypeSummaryCache* cache = nullptr, bool prune = false,
+                                                   unsigned unifyThreads = 1);
+
+  /*! \fn checkTypes
+   *  \brief Solve the type constraints of the program, unless they have been solved already.
+   *
+   * Type errors are reported by raising a SemanticError.  The types of declared
+   * names are not closed until they are queried, unless close is true.  Clients
+   * that query the types on several threads must close them first.  checkTypes
+   * and getCallGraph may be called at the same time on different threads.
+   * \param close If true, the types of declared names are also closed
+   * \sa TypeInference::close
+   * \sa TypeInference::check
    */
-  static std::unique_ptr<SemanticAnalysis> analyze(ASTProgram* ast); 
+  void checkTypes(bool close = false);
 
   /*! \fn getSymbolTable
    *  \brief Returns the symbol table computed for the program.
@@ -45,15 +114,28 @@ public:
   SymbolTable* getSymbolTable(); 
 
   /*! \fn getTypeResults
-   *  \brief Returns the type inference results.
+   *  \brief Returns the type inference results, checking the types first if needed.
    * \sa TypeInference
    */
   TypeInference* getTypeResults();
 
   /*! \fn getCallGraph
-  *  \brief Returns the call graph for the program.
+  *  \brief Returns the call graph for the program, running the control flow analysis on first use.
   * \sa CallGraph
   */
   CallGraph* getCallGraph();
 
+  /*! \fn getCallTargets
+   *  \brief Returns the functions that an application may call, in program order.
+   *
+   * These are the possible callees CallGraph::getCallTargets reports, but the
+   * control flow constraints are only solved as far as the applications
+   * queried depend on them, which is far less work than the call graph when
+   * few applications are queried.  getCallTargets and getCallGraph may be
+   * called at the same time on different threads.
+   * \param call A function application of the program
+   * \sa DemandSolver
+   */
+  std::vector<ASTFunction*> getCallTargets(ASTFunAppExpr* call);
+
 };
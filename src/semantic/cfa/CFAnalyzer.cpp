@@ -1,78 +1,153 @@
 #include "CFAnalyzer.h"
 #include "loguru.hpp"
+#include "llvm/Support/TimeProfiler.h"
 
-CFAnalyzer CFAnalyzer::analyze(ASTProgram* p, SymbolTable* st)
+CFAnalyzer CFAnalyzer::analyze(ASTProgram* p, SymbolTable* st, bool onDemand)
 {
-    CFAnalyzer cfa(p, st);
+    llvm::TimeTraceScope scope("ControlFlowAnalysis");
+    CFAnalyzer cfa(p, st, onDemand);
     p->accept(&cfa);
     return cfa;
 }
 
 std::vector<ASTFunction*> CFAnalyzer::getPossibleFunctionsForExpr(ASTNode* n, ASTFunction* f)
 {
-    return s.getPossibleFunctionsForExpr(getCanonicalForFunction(n, f));
+    auto node = getCanonicalForFunction(n, f);
+    return demand ? demand->getPossibleFunctionsForExpr(node) : s.getPossibleFunctionsForExpr(node);
 }
 
-CFAnalyzer::CFAnalyzer(ASTProgram* p, SymbolTable* st): s(p->getFunctions()), symbolTable(st), pgr(p){}
+/*
+ * The exhaustive solver starts out empty, so it costs nothing when the
+ * constraints go to the demand-driven solver instead.
+ */
+CFAnalyzer::CFAnalyzer(ASTProgram* p, SymbolTable* st, bool onDemand): s(p->getFunctions()), symbolTable(st), pgr(p)
+{
+    if (onDemand) {
+        demand = std::make_unique<DemandSolver>(p->getFunctions());
+    }
+    for (ASTFunction* fun : p->getFunctions()) {
+        functionsByArity[fun->getFormals().size()].push_back(fun);
+        functionsByDecl[fun->getDecl()] = fun;
+
+        auto stmts = fun->getStmts();
+        ASTReturnStmt* ret;
+        if (!(ret = dynamic_cast<ASTReturnStmt*>(stmts[stmts.size() - 1]))) {
+            assert(false); // LCOV_EXCL_LINE
+        }
+        returns[fun] = getCanonicalForFunction(ret->getArg(), fun);
+    }
+}
 
 ASTNode* CFAnalyzer::getCanonical(ASTNode* n)
 {
     if (auto ve = dynamic_cast<ASTVariableExpr*>(n)) {
-        ASTDeclNode* canonical;
-        if ((canonical = symbolTable->getLocal(ve->getName(), scope.top()))) {
-            return canonical;
-        }
-        else if ((canonical = symbolTable->getFunction(ve->getName()))) {
-            return canonical;
-        }
-    }  // LCOV_EXCL_LINE
+        return ve->getDecl();
+    }
     return n;
 }
 
-ASTNode* CFAnalyzer::getCanonicalForFunction(ASTNode* n, ASTFunction* scp)
+/*
+ * Variable references are bound to their declarations during symbol analysis,
+ * so the scope of the reference no longer needs to be consulted.
+ */
+ASTNode* CFAnalyzer::getCanonicalForFunction(ASTNode* n, ASTFunction*)
 {
-    if (auto ve = dynamic_cast<ASTVariableExpr*>(n)) {
-        ASTDeclNode* canonical;
-        if ((canonical = symbolTable->getLocal(ve->getName(), scp->getDecl()))) {
-            return canonical;
-        }
-        else if ((canonical = symbolTable->getFunction(ve->getName()))) {
-            return canonical;
-        }
-    }  // LCOV_EXCL_LINE
-    return n;
+    return getCanonical(n);
+}
+
+void CFAnalyzer::addElementofConstraint(ASTFunction* fn, ASTNode* n)
+{
+    if (demand) {
+        demand->addElementofConstraint(fn, n);
+    } else {
+        s.addElementofConstraint(fn, n);
+    }
+}
+
+void CFAnalyzer::addSubseteqConstraint(ASTNode* from, ASTNode* to)
+{
+    if (demand) {
+        demand->addSubseteqConstraint(from, to);
+    } else {
+        s.addSubseteqConstraint(from, to);
+    }
+}
+
+void CFAnalyzer::addConditionalConstraint(ASTFunction* fn, ASTNode* in, ASTNode* from, ASTNode* to)
+{
+    if (demand) {
+        demand->addConditionalConstraint(fn, in, from, to);
+    } else {
+        s.addConditionalConstraint(fn, in, from, to);
+    }
 }
 
 bool CFAnalyzer::visit(ASTFunction* element)
 {
-    scope.push(element->getDecl());
-    s.addElementofConstraint(element, getCanonical(element->getDecl()));
+    addElementofConstraint(element, element->getDecl());
     return true;
 }
-void CFAnalyzer::endVisit(ASTFunction* element)
+
+void CFAnalyzer::endVisit(ASTProgram* element)
 {
-    scope.pop();
+    // A function name that is assigned to may hold other functions, so its direct calls need the general treatment
+    for (auto& call : directCalls) {
+        if (assignedFunctions.count(call.callee)) {
+            addConditionalCallConstraints(call);
+        }
+    }
+    directCalls.clear();
+}
+
+void CFAnalyzer::addCallConstraints(ASTFunction* fun, const CallSite& call)
+{
+    for (int i = 0; i < call.actuals.size(); i++) {
+        addSubseteqConstraint(call.actuals[i], fun->getFormals()[i]);
+    }
+    addSubseteqConstraint(returns[fun], call.result);
 }
+
+void CFAnalyzer::addConditionalCallConstraints(const CallSite& call)
+{
+    auto bucket = functionsByArity.find(call.actuals.size());
+    if (bucket == functionsByArity.end()) {
+        return;
+    }
+    for (ASTFunction* fun : bucket->second) {
+        for (int i = 0; i < call.actuals.size(); i++) {
+            addConditionalConstraint(fun, call.callee, call.actuals[i], fun->getFormals()[i]);
+        }
+        addConditionalConstraint(fun, call.callee, returns[fun], call.result);
+    }
+}
+
 bool CFAnalyzer::visit(ASTFunAppExpr* element)
 {
-    for (ASTFunction* fun : pgr->getFunctions()) {
-        if (fun->getFormals().size() == element->getActuals().size()) {
-            for (int i = 0; i < fun->getFormals().size(); i++) {
-                s.addConditionalConstraint(fun, getCanonical(element->getFunction()), getCanonical(element->getActuals()[i]), getCanonicalForFunction(fun->getFormals()[i], fun));
-                auto stmts = fun->getStmts();
-                ASTReturnStmt* ret;
-                if (!(ret = dynamic_cast<ASTReturnStmt*>(stmts[stmts.size() - 1]))) {
-                    assert(false); // LCOV_EXCL_LINE
-                }
-                s.addConditionalConstraint(fun, getCanonical(element->getFunction()), getCanonicalForFunction(ret->getArg(), fun), getCanonical(element));
-            }
+    CallSite call;
+    call.callee = getCanonical(element->getFunction());
+    for (auto actual : element->getActuals()) {
+        call.actuals.push_back(getCanonical(actual));
+    }
+    call.result = getCanonical(element);
+
+    auto direct = functionsByDecl.find(call.callee);
+    if (direct != functionsByDecl.end()) {
+        if (direct->second->getFormals().size() == call.actuals.size()) {
+            addCallConstraints(direct->second, call);
         }
+        directCalls.push_back(call);
+    } else {
+        addConditionalCallConstraints(call);
     }
     return true;
 }  // LCOV_EXCL_LINE
 
 bool CFAnalyzer::visit(ASTAssignStmt* element)
 {
-    s.addSubseteqConstraint(getCanonical(element->getRHS()), getCanonical(element->getLHS()));
+    ASTNode* lhs = getCanonical(element->getLHS());
+    if (functionsByDecl.count(lhs)) {
+        assignedFunctions.insert(lhs);
+    }
+    addSubseteqConstraint(getCanonical(element->getRHS()), lhs);
     return true;
 }
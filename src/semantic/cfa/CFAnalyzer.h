@@ -1,7 +1,13 @@
+#pragma once
+
 #include "ASTVisitor.h"
 #include "treetypes/AST.h"
 #include "CubicSolver.h"
-#include <stack>
+#include "DemandSolver.h"
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
 #include "SymbolTable.h"
 
 /*! \class CFAnalyzer
@@ -10,29 +16,70 @@
  * Overrides several ASTVisitor's methods that visit ASTFunction, ASTFunAppExpr, and ASTAssignStmt nodes to generate
  * constraints
  * Generated constraints are solved by the cubic solver
+ *
+ * Functions are bucketed by arity so that a call site only generates conditional constraints for the
+ * functions it could possibly invoke.  A call whose callee names a function directly is resolved with
+ * plain subset constraints, unless that function name is itself the target of an assignment in which
+ * case the conditional constraints are added once the whole program has been visited.
+ *
+ * On demand, the constraints are only recorded while the program is visited and each query solves
+ * just the constraints it depends on, which pays off when only a few expressions are queried.
+ * \sa DemandSolver
  */
 
-class CFAnalyzer : ASTVisitor {
+class CFAnalyzer : public ASTVisitor {
 public:
+    /*! \brief Prepares to generate the control flow constraints of a program.
+     * The constraints are generated by running the analyzer over the program, possibly alongside other visitors.
+     * Names must already have been resolved.
+     * \param p The AST of the program
+     * \param st The symbol table of a given program
+     * \param onDemand If true, constraints are solved as queries need them rather than as they are generated
+     */
+    CFAnalyzer(ASTProgram* p, SymbolTable* st, bool onDemand = false);
+
     /*! \brief analyzes the AST and symbol table for a given program. Generates control flow constraints.
      * \param The AST of the program
      * \param st The symbol table of a given program
+     * \param onDemand If true, constraints are solved as queries need them rather than as they are generated
      * \return the CFAnalyzer for subsequent use for the CallGraphBuilder
      */
 
-    static CFAnalyzer analyze(ASTProgram* p, SymbolTable* st);
+    static CFAnalyzer analyze(ASTProgram* p, SymbolTable* st, bool onDemand = false);
     bool visit(ASTFunction* element) override;
     bool visit(ASTFunAppExpr* element) override;
     bool visit(ASTAssignStmt* element) override;
-    void endVisit(ASTFunction* element) override;
+    void endVisit(ASTProgram* element) override;
     std::vector<ASTFunction*> getPossibleFunctionsForExpr(ASTNode* n, ASTFunction* f);
 
+    //! \brief Return the on demand solver, or nullptr if constraints are solved as they are generated.
+    DemandSolver* getDemandSolver() { return demand.get(); }
+
+    //! \brief Return the work done by the solver, or on demand by the solvers of the queries so far.
+    CubicSolver::Stats getSolverStats() const { return demand ? demand->getStats() : s.getStats(); }
+
 private:
-    CFAnalyzer(ASTProgram* p, SymbolTable* st);
+    /*! \brief The canonical nodes of a call site */
+    struct CallSite {
+        ASTNode* callee;
+        std::vector<ASTNode*> actuals;
+        ASTNode* result;
+    };
+
+    void addCallConstraints(ASTFunction* fun, const CallSite& call);
+    void addConditionalCallConstraints(const CallSite& call);
     ASTNode* getCanonical(ASTNode* n);
     ASTNode* getCanonicalForFunction(ASTNode* n, ASTFunction*);
+    void addElementofConstraint(ASTFunction* fn, ASTNode* n);
+    void addSubseteqConstraint(ASTNode* from, ASTNode* to);
+    void addConditionalConstraint(ASTFunction* fn, ASTNode* in, ASTNode* from, ASTNode* to);
     CubicSolver s;
-    std::stack<ASTDeclNode*> scope;
+    std::unique_ptr<DemandSolver> demand;
     SymbolTable* symbolTable;
     ASTProgram* pgr;
+    std::map<int, std::vector<ASTFunction*>> functionsByArity;
+    std::map<ASTNode*, ASTFunction*> functionsByDecl;
+    std::map<ASTFunction*, ASTNode*> returns;
+    std::set<ASTNode*> assignedFunctions;
+    std::vector<CallSite> directCalls;
 };
\ No newline at end of file
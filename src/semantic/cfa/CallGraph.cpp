@@ -1,27 +1,152 @@
 #include "CallGraph.h"
 #include "loguru.hpp"
+#include "llvm/Support/TimeProfiler.h"
+
+#include <algorithm>
 
 std::unique_ptr<CallGraph> CallGraph::build(ASTProgram* ast, SymbolTable* st){
   LOG_S(1) << "Building call graph";
   auto cfa = CFAnalyzer::analyze(ast,st);
+  return build(ast, cfa);
+}
+
+std::unique_ptr<CallGraph> CallGraph::build(ASTProgram* ast, CFAnalyzer& cfa){
+  llvm::TimeTraceScope scope("CallGraph");
   auto cgb = CallGraphBuilder::build(ast,cfa);
-  return std::make_unique<CallGraph>(cgb.getCallGraph(), ast -> getFunctions(), cgb.getFunMap());
+  auto graph = std::make_unique<CallGraph>(ast -> getFunctions(), cgb.getCallGraph());
+  graph->solverStats = cfa.getSolverStats();
+  for (auto &site : cgb.getCallSites()) {
+    auto &targets = graph->callTargets[site.first];
+    for (auto f : site.second) {
+      auto v = graph->getVertexIndex(f);
+      if (v != -1) targets.push_back(v);
+    }
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+  }
+  return graph;
+}
+
+/*
+ * The edges are counted per vertex, the counts turned into offsets, and the
+ * edges then placed at the offsets, which yields sorted rows since callers
+ * and callees are visited in increasing order.
+ */
+CallGraph::CallGraph(std::vector<ASTFunction*> funs, std::map<ASTFunction*, std::set<ASTFunction*> > const &cGraph)
+    : vertices(std::move(funs)) {
+  int n = vertices.size();
+  for (int v = 0; v < n; v++) {
+    vertexIndex[vertices[v]] = v;
+    nameIndex[vertices[v]->getName()] = v;
+  }
+
+  std::vector<std::vector<int>> callees(n);
+  for (auto &pair : cGraph) {
+    auto caller = vertexIndex.find(pair.first);
+    if (caller == vertexIndex.end()) continue;
+    for (auto dest : pair.second) {
+      auto callee = vertexIndex.find(dest);
+      if (callee != vertexIndex.end()) callees[caller->second].push_back(callee->second);
+    }
+  }
+
+  calleeOffsets.assign(n + 1, 0);
+  callerOffsets.assign(n + 1, 0);
+  for (int v = 0; v < n; v++) {
+    std::sort(callees[v].begin(), callees[v].end());
+    calleeOffsets[v + 1] = calleeOffsets[v] + callees[v].size();
+    for (auto w : callees[v]) {
+      callerOffsets[w + 1]++;
+    }
+    calleeTargets.insert(calleeTargets.end(), callees[v].begin(), callees[v].end());
+  }
+  for (int v = 0; v < n; v++) {
+    callerOffsets[v + 1] += callerOffsets[v];
+  }
+
+  callerSources.resize(calleeTargets.size());
+  std::vector<int> next(callerOffsets.begin(), callerOffsets.end() - 1);
+  for (int v = 0; v < n; v++) {
+    for (auto w : getCalleeIndices(v)) {
+      callerSources[next[w]++] = v;
+    }
+  }
+
+  computeComponents();
+}
+
+/*
+ * Tarjan's algorithm, with an explicit stack since call chains can be long,
+ * emits each strongly connected component after all of the components it
+ * calls, so the components are produced in reverse topological order.
+ */
+void CallGraph::computeComponents() {
+  int n = vertices.size();
+  std::vector<int> index(n, -1), lowlink(n);
+  std::vector<bool> onStack(n, false);
+  std::vector<int> stack;
+  std::vector<std::pair<int, int>> frames;  // vertex and position of its next callee
+  int next = 0;
+
+  componentOf.assign(n, -1);
+  for (int root = 0; root < n; root++) {
+    if (index[root] != -1) {
+      continue;
+    }
+    index[root] = lowlink[root] = next++;
+    stack.push_back(root);
+    onStack[root] = true;
+    frames.emplace_back(root, calleeOffsets[root]);
+
+    while (!frames.empty()) {
+      int v = frames.back().first;
+      int &edge = frames.back().second;
+
+      if (edge < calleeOffsets[v + 1]) {
+        int w = calleeTargets[edge++];
+        if (index[w] == -1) {
+          index[w] = lowlink[w] = next++;
+          stack.push_back(w);
+          onStack[w] = true;
+          frames.emplace_back(w, calleeOffsets[w]);
+        } else if (onStack[w]) {
+          lowlink[v] = std::min(lowlink[v], index[w]);
+        }
+        continue;
+      }
+
+      if (lowlink[v] == index[v]) {
+        std::vector<int> component;
+        int w;
+        do {
+          w = stack.back();
+          stack.pop_back();
+          onStack[w] = false;
+          componentOf[w] = components.size();
+          component.push_back(w);
+        } while (w != v);
+        std::sort(component.begin(), component.end());
+        components.push_back(std::move(component));
+      }
+
+      frames.pop_back();
+      if (!frames.empty()) {
+        int caller = frames.back().first;
+        lowlink[caller] = std::min(lowlink[caller], lowlink[v]);
+      }
+    }
+  }
 }
 
 int CallGraph::getTotalVertices()
 {
-    return total_vertices;
+    return vertices.size();
 }
 
 int CallGraph::getTotalEdges()
 {
-    int total_edges = 0;
-    for (auto pair : callGraph) {
-        for (auto dest : pair.second)
-            total_edges++;
-    }
-    return total_edges;
-}  // LCOV_EXCL_LINE
+    return calleeTargets.size();
+}
 
 std::vector<ASTFunction*> CallGraph::getVertices()
 {
@@ -30,64 +155,109 @@ std::vector<ASTFunction*> CallGraph::getVertices()
 
 std::vector<std::pair<ASTFunction*, ASTFunction*>> CallGraph::getEdges()
 {
-    for (auto pair : callGraph) {
-        for (auto dest : pair.second) {
-            std::pair edge = std::make_pair(pair.first, dest);
-            edges.push_back(edge);
+    std::vector<std::pair<ASTFunction*, ASTFunction*>> edges;
+    edges.reserve(calleeTargets.size());
+    for (int v = 0; v < vertices.size(); v++) {
+        for (auto w : getCalleeIndices(v)) {
+            edges.emplace_back(vertices[v], vertices[w]);
         }
     }
     return edges;
-}  // LCOV_EXCL_LINE
+}
 
-std::set<ASTFunction*> CallGraph::getCallees(ASTFunction* f)
+int CallGraph::getVertexIndex(ASTFunction* f)
 {
-   return callGraph.find(f)->second;
+    auto v = vertexIndex.find(f);
+    return v == vertexIndex.end() ? -1 : v->second;
 }
 
-std::set<ASTFunction*> CallGraph::getCallees(std::string caller)
+std::vector<ASTFunction*> CallGraph::getCallTargets(ASTFunAppExpr* call)
+{
+    std::vector<ASTFunction*> targets;
+    auto site = callTargets.find(call);
+    if (site == callTargets.end()) return targets;
+    for (auto v : site->second) targets.push_back(vertices[v]);
+    return targets;
+}
+
+CallGraph::Neighbors CallGraph::getCalleeIndices(int v)
+{
+    auto base = calleeTargets.data();
+    return Neighbors(base + calleeOffsets[v], base + calleeOffsets[v + 1]);
+}
+
+CallGraph::Neighbors CallGraph::getCallerIndices(int v)
+{
+    auto base = callerSources.data();
+    return Neighbors(base + callerOffsets[v], base + callerOffsets[v + 1]);
+}
+
+std::set<ASTFunction*> CallGraph::getCallees(ASTFunction* f)
 {
-   //iterate map and if function name matches return the list
    std::set<ASTFunction*> callees;
-   for (auto fun : callGraph)
-      if(fun.first->getName().compare(caller) == 0) callees=callGraph.find(fun.first)->second;
+   auto v = getVertexIndex(f);
+   if (v == -1) return callees;
+   for (auto w : getCalleeIndices(v)) callees.insert(vertices[w]);
    return callees;
 }
 
+std::set<ASTFunction*> CallGraph::getCallees(std::string caller)
+{
+   return getCallees(getASTFun(caller));
+}
+
 std::set<std::string> CallGraph::getCallers(std::string callee)
 {
       std::set<std::string> callers;
-      for (auto pair : callGraph){
-         for (auto callee_ : pair.second) {
-               if(callee_->getName().compare(callee) == 0)
-                 callers.insert(pair.first->getName());
-         }
-      }
+      for (auto f : getCallers(getASTFun(callee))) callers.insert(f->getName());
       return callers;
 }
 
 std::set<ASTFunction*> CallGraph::getCallers(ASTFunction* f)
 {
-
       std::set<ASTFunction*> callers;
-      for (auto pair : callGraph){
-         if(pair.second.find(f)!=pair.second.end()) callers.insert(pair.first);
-      }
+      auto v = getVertexIndex(f);
+      if (v == -1) return callers;
+      for (auto w : getCallerIndices(v)) callers.insert(vertices[w]);
       return callers;
 }
 
+std::vector<std::vector<ASTFunction*>> CallGraph::getComponents()
+{
+    std::vector<std::vector<ASTFunction*>> result;
+    result.reserve(components.size());
+    for (auto &component : components) {
+        std::vector<ASTFunction*> functions;
+        for (auto v : component) functions.push_back(vertices[v]);
+        result.push_back(std::move(functions));
+    }
+    return result;
+}
+
+int CallGraph::getComponent(ASTFunction* f)
+{
+    return componentOf[vertexIndex.at(f)];
+}
+
+std::vector<ASTFunction*> CallGraph::getTopologicalOrder()
+{
+    std::vector<ASTFunction*> order;
+    order.reserve(vertices.size());
+    for (auto c = components.rbegin(); c != components.rend(); ++c) {
+        for (auto v : *c) order.push_back(vertices[v]);
+    }
+    return order;
+}
+
 void CallGraph::print(std::ostream& str)
 {
     str << "digraph CFG{\n";
-    std::map<ASTFunction*, int> inds;
-    int i = 0;
-
-    for (auto f : vertices) {
-        inds[f] = i++;
-        str << "a" << inds[f] << " [label=\"" << f->getName() << "\"];\n";
+    for (int v = 0; v < vertices.size(); v++) {
+        str << "a" << v << " [label=\"" << vertices[v]->getName() << "\"];\n";
     }
-    for (auto pair : callGraph) {
-        for (auto dest : pair.second) {
-            str << "a" << inds[pair.first] << " -> a" << inds[dest] << ";\n";
+    for (int v = 0; v < vertices.size(); v++) {
+        for (auto w : getCalleeIndices(v)) {
+            str << "a" << v << " -> a" << w << ";\n";
         }
     }
     str << "}\n";
@@ -95,14 +265,15 @@ void CallGraph::print(std::ostream& str)
 
 bool CallGraph::existEdge(std::string caller, std::string callee)
 {
-      for(std::pair<ASTFunction*, ASTFunction*> edge : getEdges()){
-         if((edge.first->getName().compare(caller) == 0) && (edge.second->getName().compare(callee) == 0))
-            return true;
-      }
-      return false;
+      auto from = nameIndex.find(caller);
+      auto to = nameIndex.find(callee);
+      if (from == nameIndex.end() || to == nameIndex.end()) return false;
+      auto callees = getCalleeIndices(from->second);
+      return std::binary_search(callees.begin(), callees.end(), to->second);
 }
 
 ASTFunction* CallGraph::getASTFun(std::string f_name)
 {
-      return fromFunNameToASTFuns[f_name];
+      auto v = nameIndex.find(f_name);
+      return v == nameIndex.end() ? nullptr : vertices[v->second];
 }
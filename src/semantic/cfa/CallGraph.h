@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include "ASTVisitor.h"
 #include "treetypes/AST.h"
@@ -14,23 +15,56 @@
  *  in a computer program. Each node represents a subroutine and each edge (a1, a0) indicates that procedure a1 calls procedure a0.
  *  A cycle in the graph indicates recursive procedure calls, e.g., a0 -> a0 indicates that a0 calls itself recursively
  *  this call graph is sometimes approximations. Not all the call relationship that exist in the graph will occur in the actual runs of the program.
+ *
+ *  Vertices are numbered in program order and the edges are stored in compressed
+ *  sparse row form, once by caller and once by callee, so the callees and the
+ *  callers of a function are contiguous ranges.  The strongly connected components
+ *  are computed with the graph.
  */
 
 class CallGraph {
 
     std::vector<ASTFunction*> vertices;
-    std::vector<std::pair<ASTFunction*, ASTFunction*> > edges;
-    int total_edges;
-    int total_vertices;
-    std::map<ASTFunction*, std::set<ASTFunction*> > callGraph;
-    std::map<std::string, ASTFunction*> fromFunNameToASTFuns;
+    std::unordered_map<ASTFunction*, int> vertexIndex;
+    std::map<std::string, int> nameIndex;
 
+    // The callees of vertex v are calleeTargets[calleeOffsets[v] .. calleeOffsets[v+1]),
+    // and its callers are callerSources[callerOffsets[v] .. callerOffsets[v+1]).
+    std::vector<int> calleeOffsets;
+    std::vector<int> calleeTargets;
+    std::vector<int> callerOffsets;
+    std::vector<int> callerSources;
 
+    // Components in reverse topological order and the component of each vertex.
+    std::vector<std::vector<int>> components;
+    std::vector<int> componentOf;
+
+    // The work done by the control flow analysis the graph was built from.
+    CubicSolver::Stats solverStats;
+
+    // The vertex numbers of the possible callees of each call site, in increasing order.
+    std::unordered_map<ASTFunAppExpr*, std::vector<int>> callTargets;
+
+    void computeComponents();
 
 public:
 
-    CallGraph(std::map<ASTFunction*, std::set<ASTFunction*> > cGraph, std::vector<ASTFunction*> funs, std::map<std::string, ASTFunction*> fmap)
-        : callGraph(cGraph), vertices(funs), total_vertices(vertices.size()), fromFunNameToASTFuns(fmap){}
+    //! \brief A contiguous range of vertex numbers.
+    class Neighbors {
+        const int *first;
+        const int *last;
+    public:
+        Neighbors(const int *first, const int *last) : first(first), last(last) {}
+        const int *begin() const { return first; }
+        const int *end() const { return last; }
+        std::size_t size() const { return last - first; }
+    };
+
+    /*! \brief Construct the call graph with the given vertices and edges.
+     * \param funs The functions of the program, in program order
+     * \param cGraph For each caller with calls, the functions it may call
+     */
+    CallGraph(std::vector<ASTFunction*> funs, std::map<ASTFunction*, std::set<ASTFunction*> > const &cGraph);
 
 
 
@@ -40,6 +74,11 @@ public:
 
     static std::unique_ptr<CallGraph> build(ASTProgram*, SymbolTable* st);
 
+    /*! \brief Return the unique pointer of the call graph for a program whose control flow constraints have been generated.
+     * \param The AST of the program and the analyzer that was run over it
+     */
+    static std::unique_ptr<CallGraph> build(ASTProgram*, CFAnalyzer& cfa);
+
     /*! \brief Return the total num of vertices for a given call graph.
     */
     int getTotalVertices();
@@ -84,8 +123,56 @@ public:
 
     /*! \brief Returns the ASTFunction* for a given function name .
      * \param str name of the subroutines
-     * \return ASTFunction*
+     * \return ASTFunction*, or nullptr if there is no such function
      */
     ASTFunction* getASTFun(std::string f_name);
 
+    /*! \brief Returns the number of a function, its position in the program.
+     * \return The vertex number, or -1 if f is not a function of the program
+     */
+    int getVertexIndex(ASTFunction* f);
+
+    //! \brief Returns the function with the given vertex number.
+    ASTFunction* getVertex(int v) { return vertices[v]; }
+
+    //! \brief Returns the vertex numbers of the callees of vertex v, in increasing order.
+    Neighbors getCalleeIndices(int v);
+
+    //! \brief Returns the vertex numbers of the callers of vertex v, in increasing order.
+    Neighbors getCallerIndices(int v);
+
+    /*! \brief Returns the strongly connected components of the call graph.
+     *
+     * The components are in reverse topological order, i.e., each component
+     * comes after every component it calls, and the functions of a component
+     * are in program order.  Mutually recursive functions form one component.
+     */
+    std::vector<std::vector<ASTFunction*>> getComponents();
+
+    /*! \brief Returns the number of the strongly connected component of f.
+     * \return A position in getComponents()
+     */
+    int getComponent(ASTFunction* f);
+
+    /*! \brief Returns the functions in topological order.
+     *
+     * Callers precede their callees, except for calls within a strongly
+     * connected component.  This is the reverse of the components concatenated.
+     */
+    std::vector<ASTFunction*> getTopologicalOrder();
+
+    /*! \brief Returns the functions that a function application may call.
+     *
+     * These are the functions the control flow analysis found to flow to the
+     * callee expression of the application, in program order.  The analysis
+     * does not follow functions through the heap, so the callee may also be
+     * a function that is not among them.
+     * \param call A function application of the program the graph was built for
+     * \return The possible callees, which is empty for applications of an unknown program
+     */
+    std::vector<ASTFunction*> getCallTargets(ASTFunAppExpr* call);
+
+    //! \brief Returns the work done by the control flow analysis the graph was built from.
+    CubicSolver::Stats getSolverStats() const { return solverStats; }
+
 };
@@ -2,14 +2,14 @@
 #include "loguru.hpp"
 
 
-CallGraphBuilder CallGraphBuilder::build(ASTProgram* ast, CFAnalyzer cfa){
+CallGraphBuilder CallGraphBuilder::build(ASTProgram* ast, CFAnalyzer& cfa){
     CallGraphBuilder cgb(cfa);
     ast -> accept(&cgb);
     return cgb;//.graph;
 }
 
 
-CallGraphBuilder::CallGraphBuilder(CFAnalyzer p) : cfa(p){}
+CallGraphBuilder::CallGraphBuilder(CFAnalyzer& p) : cfa(p){}
 
 bool CallGraphBuilder::visit(ASTFunction *element) {
     cfun = element;
@@ -17,11 +17,10 @@ bool CallGraphBuilder::visit(ASTFunction *element) {
 }
 
 bool CallGraphBuilder::visit(ASTFunAppExpr *element) {
+    auto &targets = callSites[element];
     for(ASTFunction* f : cfa.getPossibleFunctionsForExpr(element -> getFunction(), cfun)){
         graph[cfun].insert(f);
-        fromFunNameToASTFun[cfun->getName()]= cfun;
-        fromFunNameToASTFun[f->getName()]=f;
-
+        targets.push_back(f);
     }
     return true;
 }  // LCOV_EXCL_LINE
@@ -29,8 +28,6 @@ bool CallGraphBuilder::visit(ASTFunAppExpr *element) {
 bool CallGraphBuilder::visit(ASTVariableExpr *element) {
     for(ASTFunction* f : cfa.getPossibleFunctionsForExpr(element, cfun)){
         graph[cfun].insert(f);
-           fromFunNameToASTFun[cfun->getName()]= cfun;
-               fromFunNameToASTFun[f->getName()]=f;
     }
     return true;
 }  // LCOV_EXCL_LINE
@@ -40,11 +37,6 @@ std::map<ASTFunction*, std::set<ASTFunction*>> CallGraphBuilder::getCallGraph(){
   return graph;
 }
 
-std::map<std::string, ASTFunction*> CallGraphBuilder::getFunMap(){
-
-  return fromFunNameToASTFun;
-
+std::map<ASTFunAppExpr*, std::vector<ASTFunction*>> CallGraphBuilder::getCallSites(){
+  return callSites;
 }
-
-
-
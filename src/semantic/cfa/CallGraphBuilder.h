@@ -18,7 +18,7 @@ public:
     * \param cfa The control flow analyzer
     * \return the CallGraphBuilder for the given program
     */
-    static CallGraphBuilder build(ASTProgram* ast, CFAnalyzer cfa);
+    static CallGraphBuilder build(ASTProgram* ast, CFAnalyzer& cfa);
     bool visit(ASTFunction* element) override;
     bool visit(ASTFunAppExpr* element) override;
     bool visit(ASTVariableExpr* element) override;
@@ -27,17 +27,16 @@ public:
     */
     std::map<ASTFunction*, std::set<ASTFunction*> > getCallGraph();
 
-    /*! \brief Returns the map from a function name to its ASTFunction*, ASTFunction* is then used to fetch further information from the graph
-    * such as to fetch the subroutines called by a function, or that call the function
-    * \return std::map<std::string, ASTFunction*> fromFunNameToASTFun
+    /*! \brief Returns the functions that each function application may call
     */
-    std::map<std::string, ASTFunction*> getFunMap();
+    std::map<ASTFunAppExpr*, std::vector<ASTFunction*> > getCallSites();
+
 
 private:
-    CallGraphBuilder(CFAnalyzer pass);
+    CallGraphBuilder(CFAnalyzer& pass);
     ASTNode* getCanonical(ASTNode* n);
     ASTFunction* cfun;
-    CFAnalyzer cfa;
+    CFAnalyzer& cfa;
     std::map<ASTFunction*, std::set<ASTFunction*> > graph;
-    std::map<std::string, ASTFunction*> fromFunNameToASTFun;
+    std::map<ASTFunAppExpr*, std::vector<ASTFunction*> > callSites;
 };
@@ -1,220 +1,255 @@
 #include "CubicSolver.h"
 #include "loguru.hpp"
-#include <queue>
-#include <map>
+#include <algorithm>
+#include <bitset>
+
+namespace {
+
+std::uint64_t edgeKey(int from, int to) {
+    return (static_cast<std::uint64_t>(from) << 32) | static_cast<std::uint32_t>(to);
+}
 
-CubicSolverNode::CubicSolverNode(int count) {
-    bitvector = new bool[count];
-    for(int i = 0; i < count; i++){
-        bitvector[i] = false;
-    }
-    size = count;
-    conditionalConstraints = new std::vector<std::pair<ASTNode*, ASTNode*>>[count];
-    supsets = {};
-    subsets = {};
 }
 
 CubicSolver::CubicSolver(std::vector <ASTFunction*> functions){
     for(int i = 0; i < functions.size(); i++){
         fmapping[functions[i]] = i;
     }
+    words = (fmapping.size() + wordBits - 1) / wordBits;
 }
 
-void CubicSolver::addEmptyVariableIfNecessary(ASTNode * node) {
-    if(dagmapping.find(node) != dagmapping.end()){
-        return;
+int CubicSolver::addEmptyVariableIfNecessary(ASTNode * node) {
+    auto found = dagmapping.find(node);
+    if(found != dagmapping.end()){
+        return find(found->second);
+    }
+    int id = parents.size();
+    dagmapping[node] = id;
+    parents.push_back(id);
+    bits.resize(bits.size() + words, 0);
+    deltas.resize(deltas.size() + words, 0);
+    supsets.emplace_back();
+    conditionals.emplace_back();
+    queued.push_back(false);
+    return id;
+}
+
+/*! \brief Union-find lookup of the representative of a variable, with path halving.
+ */
+int CubicSolver::find(int n) {
+    while(parents[n] != n){
+        parents[n] = parents[parents[n]];
+        n = parents[n];
     }
-    dagmapping[node] = new CubicSolverNode(fmapping.size());
+    return n;
+}
+
+bool CubicSolver::test(int n, int fn) const {
+    return (bits[n * words + fn / wordBits] >> (fn % wordBits)) & 1;
 }
 
 void CubicSolver::addElementofConstraint(ASTFunction * fn, ASTNode * node) {
     LOG_S(1) << "Generating control flow constraint: " <<fn -> getName() << " \u2208 \u27e6" << *node << "\u27e7";
-    addEmptyVariableIfNecessary(node);
-    dagmapping[node]->bitvector[fmapping[fn]] = true;
-    propegateNodeChanges(dagmapping[node]);
+    int n = addEmptyVariableIfNecessary(node);
+    std::vector<Word> element(words, 0);
+    int i = fmapping[fn];
+    element[i / wordBits] = Word(1) << (i % wordBits);
+    addBits(n, element.data());
+    solve();
 }
 
 void CubicSolver::addConditionalConstraint(ASTFunction* condition, ASTNode* in, ASTNode* from, ASTNode* to) {
     LOG_S(1) << "Generating control flow constraint: " <<condition -> getName() << " \u2208 \u27e6" << *in << "\u27e7 \u21d2 \u27e6" << *from << "\u27e7 \u2286 \u27e6" << *to << "\u27e7";
-    addEmptyVariableIfNecessary(in);
-    addEmptyVariableIfNecessary(from);
-    addEmptyVariableIfNecessary(to);
-    dagmapping[in]->conditionalConstraints[fmapping[condition]].push_back(std::pair(from, to));
-    propegateNodeChanges(dagmapping[in]);
+    int i = addEmptyVariableIfNecessary(in);
+    int f = addEmptyVariableIfNecessary(from);
+    int t = addEmptyVariableIfNecessary(to);
+    int fn = fmapping[condition];
+    i = find(i);
+    if(test(i, fn)){
+        addEdge(f, t);
+    } else {
+        conditionals[i].push_back(Conditional{fn, f, t});
+    }
+    solve();
 }
 
 void CubicSolver::addSubseteqConstraint(ASTNode* from, ASTNode* to) {
     LOG_S(1) << "Generating control flow constraint: " <<"\u27e6" << *from << "\u27e7 \u2286 \u27e6" << *to << "\u27e7";
-    addEmptyVariableIfNecessary(from);
-    addEmptyVariableIfNecessary(to);
-    if(dagmapping[from] == dagmapping[to]){
+    int f = addEmptyVariableIfNecessary(from);
+    int t = addEmptyVariableIfNecessary(to);
+    addEdge(f, t);
+    solve();
+}
+
+/*! \brief Add a subset edge and push the full solution of its source along it.
+ */
+void CubicSolver::addEdge(int from, int to) {
+    from = find(from);
+    to = find(to);
+    if(from == to || !edges.insert(edgeKey(from, to)).second){
         return;
     }
-    dagmapping[from] -> supsets.insert(dagmapping[to]);
-    dagmapping[to] -> subsets.insert(dagmapping[from]);
-    killCyclesAt(dagmapping[from]);
-    propegateNodeChanges(dagmapping[from]);
+    supsets[from].push_back(to);
+    addBits(to, bits.data() + from * words);
 }
 
-void CubicSolver::propegateNodeChanges(CubicSolverNode* node){
-    for(int i = 0; i < node -> size; i++){
-        if(node -> bitvector[i]){
-            auto constraints = node->conditionalConstraints[i];
-            node->conditionalConstraints[i].clear();
-            for(auto pair : constraints){
-                activateConditionalConstraint(pair.first, pair.second);
-            }
-        }
-    }
-    for(CubicSolverNode* sups : node->supsets){
-        for(int i = 0; i < node -> size; i++){
-            sups->bitvector[i] |= node->bitvector[i];
-        }
-        assert(sups != node);
-        propegateNodeChanges(sups);
-    }
+/*! \brief OR the given bits into the solution of n, recording the new ones in its delta.
+ * \return true if the solution of n changed
+ */
+bool CubicSolver::addBits(int n, const Word* source) {
+    Word* target = bits.data() + n * words;
+    Word* delta = deltas.data() + n * words;
+    Word changed = 0;
+    for(int w = 0; w < words; w++){
+        Word fresh = source[w] & ~target[w];
+        target[w] |= fresh;
+        delta[w] |= fresh;
+        changed |= fresh;
+        stats.propagated += std::bitset<wordBits>(fresh).count();
+    }
+    if(changed){
+        enqueue(n);
+    }
+    return changed != 0;
 }
 
-void CubicSolver::activateConditionalConstraint(ASTNode * from, ASTNode * to) {
-    if(dagmapping[from] == dagmapping[to]){
-        return;
+void CubicSolver::enqueue(int n) {
+    if(!queued[n]){
+        queued[n] = true;
+        worklist.push_back(n);
     }
-    dagmapping[from]->supsets.insert(dagmapping[to]);
-    dagmapping[to]->subsets.insert(dagmapping[from]);
-    killCyclesAt(dagmapping[from]);
-    propegateNodeChanges(dagmapping[from]);
 }
 
-CubicSolverNode * CubicSolver::killCyclesAt(CubicSolverNode * n) {
-    bool collapsed;
-    do{
-        collapsed = false;
-        for(CubicSolverNode* t : n->supsets){
-            auto path = findPath(t, n);
-            if(path.size() == 0){
-                continue;
-            }
-            n = mergePath(path);
-            collapsed = true;
-            break;
-        }
-    }while(collapsed);
-    return n;
-}  // LCOV_EXCL_LINE
-
-CubicSolverNode * CubicSolver::mergePath(std::vector<CubicSolverNode *>& path) {
-    assert(path.size() != 0);
-    while(true){
-        if(path.size() == 1){
-            return path[0];
+void CubicSolver::solve() {
+    while(!worklist.empty()){
+        int n = worklist.front();
+        worklist.pop_front();
+        queued[n] = false;
+        if(find(n) == n){
+            process(n);
         }
-        CubicSolverNode * a = path.back();
-        path.pop_back();
-        CubicSolverNode * b = path.back();
-        path.pop_back();
-        path.push_back(mergeNodes(a, b));
     }
 }
 
-CubicSolverNode * CubicSolver::mergeNodes(CubicSolverNode * n1, CubicSolverNode * n2) {
-    for(auto& pair : dagmapping){
-        if(pair.second == n2){
-            pair.second = n1;
-        }
-    }
-    for(int i = 0; i < n1->size; i++){
-        n1->bitvector[i] |= n2->bitvector[i];
-        for(auto a : n2 -> conditionalConstraints[i]){
-            n1->conditionalConstraints[i].push_back(a);
-        }
-    }
-    for(auto a : n2 -> supsets){
-        if(n1 == a){
+/*! \brief Propagate the delta of a representative variable.
+ *
+ * Conditional constraints whose function has become an element are turned
+ * into edges, then the delta is pushed to every superset.  Edges that leave
+ * both ends with the same solution are candidates for cycle collapsing.
+ */
+void CubicSolver::process(int n) {
+    std::vector<Word> delta(deltas.begin() + n * words, deltas.begin() + (n + 1) * words);
+    std::fill(deltas.begin() + n * words, deltas.begin() + (n + 1) * words, 0);
+
+    std::vector<Conditional> pending;
+    std::vector<Conditional> activated;
+    for(auto &c : conditionals[n]){
+        (test(n, c.fn) ? activated : pending).push_back(c);
+    }
+    conditionals[n] = std::move(pending);
+    for(auto &c : activated){
+        addEdge(c.from, c.to);
+    }
+
+    std::vector<int> candidates;
+    for(int i = 0; i < supsets[n].size(); i++){
+        int s = find(supsets[n][i]);
+        if(s == n){
             continue;
         }
-        a -> subsets.erase(a->subsets.find(n2));
-        a -> subsets.insert(n1);
-        n1 -> supsets.insert(a);
-    }
-    for(auto a : n2 -> subsets){
-        if(n1 == a){
-            continue;
+        addBits(s, delta.data());
+        if(std::equal(bits.begin() + s * words, bits.begin() + (s + 1) * words, bits.begin() + n * words)
+           && checkedEdges.insert(edgeKey(n, s)).second){
+            candidates.push_back(s);
         }
-        a -> supsets.erase(a->supsets.find(n2));
-        a -> supsets.insert(n1);
-        n1 -> subsets.insert(a);
     }
-    if(n1->supsets.find(n2) != n1->supsets.end()){
-        n1->supsets.erase(n1->supsets.find(n2));
-    }
-    if(n1->subsets.find(n2) != n1->subsets.end()){
-        n1->subsets.erase(n1->subsets.find(n2));
-    }
-    delete n2;
-    return n1;
-}
 
-std::vector<CubicSolverNode*> CubicSolver::findPath(CubicSolverNode* source, CubicSolverNode* target){
-    std::map<CubicSolverNode*, int> distances;
-    distances[source] = 0;
-    std::queue<CubicSolverNode*> q;
-
-    auto populateDistances = [&](CubicSolverNode* node){
-        assert(node != NULL);
-        for(CubicSolverNode* n : node -> supsets){
-            if(distances.find(n) != distances.end()){
-                continue;
+    for(int s : candidates){
+        std::vector<int> path;
+        if(find(s) != find(n) && findPath(find(s), find(n), path)){
+            int rep = find(n);
+            for(int p : path){
+                mergeNodes(rep, find(p));
             }
-            distances[n] = distances[node] + 1;
-            q.push(n);
-        }
-    };
-
-    populateDistances(source);
-
-    while(!q.empty()){
-        CubicSolverNode* curr = q.front();
-        populateDistances(curr);
-        q.pop();
-        if(distances.find(target) != distances.end()){
-            break;
         }
     }
+}
 
-    std::vector<CubicSolverNode*> out;
-
-    if(distances.find(target) == distances.end()){
-        return out;
-    }
-    else{
-        CubicSolverNode* curr = target;
-        out.push_back(target);
-        while(curr != source){
-            for(CubicSolverNode* n : curr -> subsets){
-                if(distances.find(n) == distances.end()){
-                    continue;
-                }
-                if(distances[n] == distances[curr] - 1){
-                    curr = n;
-                }
-                break;
+/*! \brief Depth-first search for a path of subset edges from source to target.
+ * \return true if there is a path, which is stored in path
+ */
+bool CubicSolver::findPath(int source, int target, std::vector<int>& path) {
+    std::unordered_map<int, int> predecessor;
+    std::vector<int> stack {source};
+    predecessor[source] = source;
+    while(!stack.empty()){
+        int curr = stack.back();
+        stack.pop_back();
+        if(curr == target){
+            for(int p = target; p != source; p = predecessor[p]){
+                path.push_back(p);
+            }
+            path.push_back(source);
+            return true;
+        }
+        for(int next : supsets[curr]){
+            next = find(next);
+            if(predecessor.emplace(next, curr).second){
+                stack.push_back(next);
             }
-            out.push_back(curr);
         }
-        return out;
     }
+    return false;
 }
 
+/*! \brief Collapse n2 into n1.
+ *
+ * The merged variable is reprocessed with its full solution as delta so
+ * that the edges and conditional constraints of both sides see every bit.
+ */
+void CubicSolver::mergeNodes(int n1, int n2) {
+    if(n1 == n2){
+        return;
+    }
+    parents[n2] = n1;
+    stats.merges++;
+    for(int w = 0; w < words; w++){
+        bits[n1 * words + w] |= bits[n2 * words + w];
+        deltas[n1 * words + w] = bits[n1 * words + w];
+        bits[n2 * words + w] = 0;
+        deltas[n2 * words + w] = 0;
+    }
+    supsets[n1].insert(supsets[n1].end(), supsets[n2].begin(), supsets[n2].end());
+    conditionals[n1].insert(conditionals[n1].end(), conditionals[n2].begin(), conditionals[n2].end());
+    std::vector<int>().swap(supsets[n2]);
+    std::vector<Conditional>().swap(conditionals[n2]);
+    enqueue(n1);
+}
 
 std::vector<ASTFunction*> CubicSolver::getPossibleFunctionsForExpr(ASTNode* n){
     std::vector<ASTFunction*> out;
-    if(dagmapping.find(n) == dagmapping.end()){
+    auto found = dagmapping.find(n);
+    if(found == dagmapping.end()){
         return out;
     }
+    int id = find(found->second);
     for(auto pair : fmapping){
-        if(dagmapping[n] -> bitvector[pair.second]){
+        if(test(id, pair.second)){
             out.push_back(pair.first);
         }
     }
     return out;
 }
+
+CubicSolver::Stats CubicSolver::getStats() const {
+    Stats result = stats;
+    result.variables = parents.size();
+    return result;
+}
+
+CubicSolver::Stats &CubicSolver::Stats::operator+=(Stats const &other) {
+    variables += other.variables;
+    merges += other.merges;
+    propagated += other.propagated;
+    return *this;
+}
@@ -1,38 +1,82 @@
-#include <set>
-#include <vector>
+#pragma once
+
+#include <cstdint>
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 #include "ASTNode.h"
 #include "ASTFunction.h"
 
-class CubicSolver;
-
-class CubicSolverNode{
-private:
-    friend CubicSolver;
-    CubicSolverNode(int count);
-    std::set<CubicSolverNode*> supsets;
-    std::set<CubicSolverNode*> subsets;
-    bool* bitvector;
-    int size;
-    std::vector<std::pair<ASTNode*, ASTNode*>>* conditionalConstraints;
-};
-
+/*! \class CubicSolver
+ * \brief Solver for the cubic control flow constraints generated by the CFAnalyzer
+ *
+ * Each constraint variable holds the set of functions it may evaluate to as
+ * a word-packed bitset.  Subset constraints are edges in a graph over the
+ * variables along which the sets are propagated with word-wise ORs.  Only
+ * the bits that a variable gained since it was last processed (its delta)
+ * are propagated, driven by a global worklist.  Variables found to lie on a
+ * cycle of subset edges must have equal solutions, so they are collapsed
+ * into a single representative with a union-find structure.  Cycles are
+ * detected lazily: when propagation along an edge leaves both ends with
+ * equal sets the edge is checked for a cycle once.
+ *
+ * The solution is kept up to date as each constraint is added.
+ */
 class CubicSolver{
 public:
+    //! \brief Counters of the work done by a solver.
+    struct Stats {
+        std::uint64_t variables = 0;   //!< constraint variables created
+        std::uint64_t merges = 0;      //!< variables collapsed into another on a cycle
+        std::uint64_t propagated = 0;  //!< bits added to the solutions of variables
+        Stats &operator+=(Stats const &other);
+    };
+
     CubicSolver(std::vector<ASTFunction*> functions);
     void addElementofConstraint(ASTFunction*, ASTNode*);
     void addConditionalConstraint(ASTFunction*, ASTNode* in, ASTNode* from, ASTNode* to);
     void addSubseteqConstraint(ASTNode*, ASTNode*);
     std::vector<ASTFunction*> getPossibleFunctionsForExpr(ASTNode*);
+    Stats getStats() const;
 private:
-    void activateConditionalConstraint(ASTNode*, ASTNode*);
-    void addEmptyVariableIfNecessary(ASTNode*);
-    CubicSolverNode* killCyclesAt(CubicSolverNode*);
-    std::vector<CubicSolverNode*> findPath(CubicSolverNode* source, CubicSolverNode* target);
-    CubicSolverNode* mergePath(std::vector<CubicSolverNode*>&);
-    CubicSolverNode* mergeNodes(CubicSolverNode*, CubicSolverNode*);
-    void propegateNodeChanges(CubicSolverNode*);
+    using Word = std::uint64_t;
+    static constexpr int wordBits = 64;
+
+    // A pending conditional constraint: fn in the owner implies from subseteq to.
+    struct Conditional {
+        int fn;
+        int from;
+        int to;
+    };
+
+    int addEmptyVariableIfNecessary(ASTNode*);
+    int find(int);
+    bool test(int, int) const;
+    void addEdge(int, int);
+    bool addBits(int, const Word*);
+    void enqueue(int);
+    void solve();
+    void process(int);
+    bool findPath(int source, int target, std::vector<int>& path);
+    void mergeNodes(int, int);
+
     std::map<ASTFunction*, int> fmapping;
-    std::map<ASTNode*, CubicSolverNode*> dagmapping;
+    std::unordered_map<ASTNode*, int> dagmapping;
+    int words;
+
+    // Per variable state, indexed by variable id.  Only meaningful for representatives.
+    std::vector<int> parents;
+    std::vector<Word> bits;
+    std::vector<Word> deltas;
+    std::vector<std::vector<int>> supsets;
+    std::vector<std::vector<Conditional>> conditionals;
+
+    std::unordered_set<std::uint64_t> edges;
+    std::unordered_set<std::uint64_t> checkedEdges;
+    std::deque<int> worklist;
+    std::vector<bool> queued;
+    Stats stats;
 };
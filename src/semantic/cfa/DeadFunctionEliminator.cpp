@@ -0,0 +1,90 @@
+#include "DeadFunctionEliminator.h"
+#include "ASTVisitor.h"
+#include "loguru.hpp"
+#include "llvm/Support/TimeProfiler.h"
+
+#include <map>
+#include <set>
+
+namespace {
+
+// Collects the functions a function body refers to by name.
+class FunctionReferences : public ASTVisitor {
+  std::map<ASTDeclNode*, ASTFunction*> const &functions;
+public:
+  std::vector<ASTFunction*> referenced;
+
+  explicit FunctionReferences(std::map<ASTDeclNode*, ASTFunction*> const &functions)
+      : functions(functions) {}
+
+  void endVisit(ASTVariableExpr *element) override {
+    auto f = functions.find(element->getDecl());
+    if (f != functions.end()) {
+      referenced.push_back(f->second);
+    }
+  }
+};
+
+}
+
+std::vector<ASTFunction*> DeadFunctionEliminator::reachable(ASTProgram* p) {
+  auto all = p->getFunctions();
+  auto main = p->findFunctionByName("main");
+  if (main == nullptr) {
+    return all;
+  }
+
+  std::map<ASTDeclNode*, ASTFunction*> functions;
+  for (auto f : all) {
+    functions[f->getDecl()] = f;
+  }
+
+  std::set<ASTFunction*> live = {main};
+  std::vector<ASTFunction*> worklist = {main};
+  while (!worklist.empty()) {
+    auto f = worklist.back();
+    worklist.pop_back();
+
+    FunctionReferences references(functions);
+    f->accept(&references);
+    for (auto g : references.referenced) {
+      if (live.insert(g).second) {
+        worklist.push_back(g);
+      }
+    }
+  }
+
+  std::vector<ASTFunction*> result;
+  for (auto f : all) {
+    if (live.count(f) != 0) {
+      result.push_back(f);
+    }
+  }
+  return result;
+}
+
+std::map<ASTFunction*, std::set<ASTFunction*>> DeadFunctionEliminator::references(ASTProgram* p) {
+  llvm::TimeTraceScope scope("FunctionReferences");
+  std::map<ASTDeclNode*, ASTFunction*> functions;
+  for (auto f : p->getFunctions()) {
+    functions[f->getDecl()] = f;
+  }
+
+  std::map<ASTFunction*, std::set<ASTFunction*>> result;
+  for (auto f : p->getFunctions()) {
+    FunctionReferences visitor(functions);
+    f->accept(&visitor);
+    if (!visitor.referenced.empty()) {
+      result[f].insert(visitor.referenced.begin(), visitor.referenced.end());
+    }
+  }
+  return result;
+}
+
+int DeadFunctionEliminator::prune(ASTProgram* p) {
+  llvm::TimeTraceScope scope("DeadFunctionElimination");
+  auto live = reachable(p);
+  int removed = p->retainFunctions(std::set<ASTFunction*>(live.begin(), live.end()));
+  LOG_S(1) << "Removed " << removed << " functions unreachable from main";
+  return removed;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ASTProgram.h"
+#include "SymbolTable.h"
+#include <map>
+#include <set>
+#include <vector>
+
+/*! \class DeadFunctionEliminator
+ *  \brief Removes the functions of a program that main can never reach.
+ *
+ * A function can only be called, directly or through a function value, if
+ * its name is evaluated by code that runs, so the live functions are those
+ * reachable from main through the function names their bodies refer to.
+ * This is never smaller than the part of the call graph reachable from main:
+ * a function that is named but never called is kept, since its address is
+ * still taken, and the control flow analysis may add calls to functions that
+ * are only named by dead code.  Pruning therefore only needs the references
+ * bound by symbol analysis, and runs before the control flow analysis and
+ * type inference.
+ *
+ * A program without a main function is left unchanged.
+ *
+ * The same references are the only way the types of one function constrain
+ * those of another, so the components of a CallGraph over them are the
+ * groups in which types can be inferred separately.  Finding them takes time
+ * linear in the size of the program, unlike the control flow analysis.
+ * \sa CallGraph
+ */
+class DeadFunctionEliminator {
+public:
+  /*! \fn reachable
+   *  \brief Return the functions reachable from main, in program order.
+   * \param p The AST for the program, whose references have been bound by symbol analysis
+   * \return The reachable functions, or all functions if there is no main
+   */
+  static std::vector<ASTFunction*> reachable(ASTProgram* p);
+
+  /*! \fn prune
+   *  \brief Remove the functions that are not reachable from main.
+   *
+   * The symbol table of the program must be rebuilt if any function is removed.
+   * \return The number of functions removed
+   */
+  static int prune(ASTProgram* p);
+
+  /*! \fn references
+   *  \brief Return the functions that each function refers to by name.
+   * \param p The AST for the program, whose references have been bound by symbol analysis
+   * \return For each function that refers to another, the functions it refers to
+   */
+  static std::map<ASTFunction*, std::set<ASTFunction*>> references(ASTProgram* p);
+};
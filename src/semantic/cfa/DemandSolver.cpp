@@ -0,0 +1,119 @@
+#include "DemandSolver.h"
+#include "CubicSolver.h"
+#include "loguru.hpp"
+
+DemandSolver::DemandSolver(std::vector<ASTFunction*> functions) : functions(std::move(functions)) {}
+
+int DemandSolver::variable(ASTNode* node) {
+    auto found = ids.find(node);
+    if (found != ids.end()) {
+        return found->second;
+    }
+    int id = nodes.size();
+    ids[node] = id;
+    nodes.push_back(node);
+    elements.emplace_back();
+    subsets.emplace_back();
+    conditionals.emplace_back();
+    solved.push_back(false);
+    solutions.emplace_back();
+    return id;
+}
+
+/*
+ * Constraints are only expected before the first query, so rather than
+ * tracking which solutions a new constraint invalidates they are all dropped.
+ */
+void DemandSolver::invalidate() {
+    if (numSolved > 0) {
+        solved.assign(solved.size(), false);
+        numSolved = 0;
+    }
+}
+
+void DemandSolver::addElementofConstraint(ASTFunction* fn, ASTNode* node) {
+    elements[variable(node)].push_back(fn);
+    invalidate();
+}
+
+void DemandSolver::addConditionalConstraint(ASTFunction* fn, ASTNode* in, ASTNode* from, ASTNode* to) {
+    int i = variable(in);
+    int f = variable(from);
+    conditionals[variable(to)].push_back({fn, i, f});
+    invalidate();
+}
+
+void DemandSolver::addSubseteqConstraint(ASTNode* from, ASTNode* to) {
+    int f = variable(from);
+    subsets[variable(to)].push_back(f);
+    invalidate();
+}
+
+std::vector<ASTFunction*> DemandSolver::getPossibleFunctionsForExpr(ASTNode* n) {
+    auto found = ids.find(n);
+    if (found == ids.end()) {
+        return {};
+    }
+    if (!solved[found->second]) {
+        solve(found->second);
+    }
+    return solutions[found->second];
+}
+
+/*! \brief Solve the unsolved variables that the given variable depends on.
+ *
+ * Solved variables on the frontier of the region enter the CubicSolver as
+ * constants, one element constraint per function in their solution.
+ */
+void DemandSolver::solve(int root) {
+    std::vector<int> region = {root};
+    std::vector<int> frontier;
+    std::vector<bool> seen(nodes.size(), false);
+    seen[root] = true;
+    auto reach = [&](int v) {
+        if (seen[v]) return;
+        seen[v] = true;
+        if (solved[v]) {
+            frontier.push_back(v);
+        } else {
+            region.push_back(v);
+        }
+    };
+    for (int i = 0; i < region.size(); i++) {
+        int v = region[i];
+        for (auto u : subsets[v]) {
+            reach(u);
+        }
+        for (auto &c : conditionals[v]) {
+            reach(c.in);
+            reach(c.from);
+        }
+    }
+
+    LOG_S(1) << "Solving " << region.size() << " of " << nodes.size() << " control flow variables on demand";
+
+    CubicSolver s(functions);
+    for (auto v : frontier) {
+        for (auto fn : solutions[v]) {
+            s.addElementofConstraint(fn, nodes[v]);
+        }
+    }
+    for (auto v : region) {
+        for (auto fn : elements[v]) {
+            s.addElementofConstraint(fn, nodes[v]);
+        }
+        for (auto u : subsets[v]) {
+            s.addSubseteqConstraint(nodes[u], nodes[v]);
+        }
+        for (auto &c : conditionals[v]) {
+            s.addConditionalConstraint(c.fn, nodes[c.in], nodes[c.from], nodes[v]);
+        }
+    }
+
+    for (auto v : region) {
+        solutions[v] = s.getPossibleFunctionsForExpr(nodes[v]);
+        solved[v] = true;
+    }
+    numSolved += region.size();
+    stats += s.getStats();
+}
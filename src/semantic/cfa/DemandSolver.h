@@ -0,0 +1,67 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "ASTNode.h"
+#include "ASTFunction.h"
+#include "CubicSolver.h"
+
+/*! \class DemandSolver
+ * \brief Demand-driven solver for the control flow constraints generated by the CFAnalyzer
+ *
+ * Constraints are only recorded as they are added.  The solution of a
+ * variable depends only on the constraints whose right-hand side is that
+ * variable, and for a conditional constraint also on the variable its
+ * condition tests.  A query therefore explores the variables that can reach
+ * the queried one backwards along these dependencies, stopping at variables
+ * already solved by earlier queries, and solves just the constraints into the
+ * variables found with a CubicSolver.  The solutions of all of these
+ * variables are kept, so later queries reuse them.
+ *
+ * Since the explored variables are closed under dependencies the answers are
+ * exactly those of a CubicSolver given all of the constraints.  Adding a
+ * constraint discards the solutions computed so far.
+ * \sa CubicSolver
+ */
+class DemandSolver {
+public:
+    DemandSolver(std::vector<ASTFunction*> functions);
+    void addElementofConstraint(ASTFunction*, ASTNode*);
+    void addConditionalConstraint(ASTFunction*, ASTNode* in, ASTNode* from, ASTNode* to);
+    void addSubseteqConstraint(ASTNode*, ASTNode*);
+    std::vector<ASTFunction*> getPossibleFunctionsForExpr(ASTNode*);
+
+    //! \brief Return the number of variables whose solution has been computed.
+    int getNumSolved() const { return numSolved; }
+
+    //! \brief Return the number of constraint variables.
+    int getNumVariables() const { return nodes.size(); }
+
+    //! \brief Return the work done by the solvers of all of the queries so far.
+    CubicSolver::Stats getStats() const { return stats; }
+
+private:
+    // A conditional constraint on its right-hand side: fn in in implies from subseteq the variable.
+    struct Conditional {
+        ASTFunction* fn;
+        int in;
+        int from;
+    };
+
+    int variable(ASTNode*);
+    void invalidate();
+    void solve(int);
+
+    std::vector<ASTFunction*> functions;
+    std::unordered_map<ASTNode*, int> ids;
+    int numSolved = 0;
+    CubicSolver::Stats stats;
+
+    // Per variable state, indexed by variable id.
+    std::vector<ASTNode*> nodes;
+    std::vector<std::vector<ASTFunction*>> elements;
+    std::vector<std::vector<int>> subsets;
+    std::vector<std::vector<Conditional>> conditionals;
+    std::vector<bool> solved;
+    std::vector<std::vector<ASTFunction*>> solutions;
+};
@@ -15,6 +15,8 @@ class FieldNameCollector :  public ASTVisitor {
 public:
     FieldNameCollector() = default;
     static std::vector<std::string> build(ASTProgram* p);
+    //! \brief Return the field names collected so far, in order of first reference.
+    const std::vector<std::string>& getFields() const { return fields; }
     virtual void endVisit(ASTFieldExpr * element) override;
     virtual void endVisit(ASTAccessExpr * element) override;
 };
@@ -0,0 +1,58 @@
+#include "NameResolver.h"
+#include "IdentifierTable.h"
+#include "InternalError.h"
+
+NameResolver::NameResolver(ASTProgram* p) : bindings(IdentifierTable::size(), nullptr) {
+  for (auto f : p->getFunctions()) {
+    number(f->getDecl());
+    bind(f->getDecl(), f->getDecl());
+  }
+}
+
+std::vector<ASTDeclNode*> NameResolver::build(ASTProgram* p) {
+  NameResolver visitor(p);
+  p->accept(&visitor);
+  return visitor.declarations;
+}
+
+void NameResolver::number(ASTDeclNode* decl) {
+  decl->setIndex(declarations.size());
+  declarations.push_back(decl);
+}
+
+void NameResolver::bind(ASTDeclNode* decl, ASTDeclNode* binding) {
+  bindings[decl->getId()] = binding;
+}
+
+bool NameResolver::visit(ASTFunction * element) {
+  for (auto formal : element->getFormals()) {
+    number(formal);
+    bind(formal, formal);
+  }
+  for (auto declStmt : element->getDeclarations()) {
+    for (auto local : declStmt->getVars()) {
+      number(local);
+      bind(local, local);
+    }
+  }
+  return true;
+}
+
+void NameResolver::endVisit(ASTFunction * element) {
+  for (auto formal : element->getFormals()) {
+    bind(formal, nullptr);
+  }
+  for (auto declStmt : element->getDeclarations()) {
+    for (auto local : declStmt->getVars()) {
+      bind(local, nullptr);
+    }
+  }
+}
+
+void NameResolver::endVisit(ASTVariableExpr * element) {
+  auto binding = bindings[element->getId()];
+  if (binding == nullptr) {
+    throw InternalError("Unresolved name " + element->getName()); // LCOV_EXCL_LINE
+  }
+  element->bind(binding);
+}
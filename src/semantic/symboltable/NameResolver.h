@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ASTVisitor.h"
+#include <vector>
+
+/*! \class NameResolver
+ *  \brief Numbers declarations and binds variable references to them.
+ *
+ * This pass runs after the function and local name collectors have checked
+ * the scope rules.  Function declarations are numbered first, in program
+ * order, followed by the parameters and locals of each function.  Every
+ * ASTVariableExpr is then bound to its declaration so that later phases
+ * can resolve names without string lookups.
+ *
+ * Bindings in scope are kept in a vector indexed by the interned identifier
+ * of the name.  Since locals may not shadow functions, the locals of a
+ * function are simply added on entry and removed on exit.
+ * \sa IdentifierTable
+ */
+class NameResolver : public ASTVisitor {
+  std::vector<ASTDeclNode*> bindings;
+  std::vector<ASTDeclNode*> declarations;
+
+  void number(ASTDeclNode* decl);
+  void bind(ASTDeclNode* decl, ASTDeclNode* binding);
+public:
+  /*! \brief Prepare to resolve the names in a program.
+   *
+   * The function declarations are numbered and bound up front, since they
+   * are in scope everywhere.  The resolver can then be run over the program,
+   * possibly alongside other visitors.
+   * \param p The AST for the program
+   */
+  explicit NameResolver(ASTProgram* p);
+
+  /*! \brief Resolve the names in a program.
+   * \param p The AST for the program
+   * \return The declarations of the program indexed by their number
+   */
+  static std::vector<ASTDeclNode*> build(ASTProgram* p);
+
+  //! \brief Return the declarations numbered so far indexed by their number.
+  const std::vector<ASTDeclNode*>& getDeclarations() const { return declarations; }
+
+  virtual bool visit(ASTFunction * element) override;
+  virtual void endVisit(ASTFunction * element) override;
+  virtual void endVisit(ASTVariableExpr * element) override;
+};
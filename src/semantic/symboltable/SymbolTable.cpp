@@ -2,20 +2,49 @@
 #include "FunctionNameCollector.h"
 #include "LocalNameCollector.h"
 #include "FieldNameCollector.h"
+#include "NameResolver.h"
+#include "IdentifierTable.h"
+#include "ASTVisitorGroup.h"
 
 #include <sstream>
 
 #include "loguru.hpp"
+#include "llvm/Support/TimeProfiler.h"
 
 std::unique_ptr<SymbolTable> SymbolTable::build(ASTProgram* p) {
   LOG_S(1) << "Building symbol table";
+  llvm::TimeTraceScope scope("SymbolTable");
   auto fMap = FunctionNameCollector::build(p);
-  auto lMap = LocalNameCollector::build(p, fMap);
-  auto fSet = FieldNameCollector::build(p); 
-  return std::make_unique<SymbolTable>(fMap, lMap, fSet);
+
+  /*
+   * The remaining passes only need the function names so they share a single
+   * walk of the program.  Scope errors are detected by the local name collector
+   * before the resolver reaches the offending node.
+   */
+  LocalNameCollector locals(fMap);
+  FieldNameCollector fields;
+  NameResolver resolver(p);
+  ASTVisitorGroup group({&locals, &fields, &resolver});
+  p->accept(&group);
+
+  return std::make_unique<SymbolTable>(fMap, locals.lMap, fields.getFields(), resolver.getDeclarations());
 }
 
-ASTDeclNode* SymbolTable::getFunction(std::string s) {
+SymbolTable::SymbolTable(std::map<std::string, ASTDeclNode*> fMap,
+                         std::map<ASTDeclNode*, std::map<std::string, ASTDeclNode*>> lMap,
+                         std::vector<std::string> fSet,
+                         std::vector<ASTDeclNode*> decls)
+    : functionNames(fMap), localNames(lMap), fieldNames(fSet), declarations(decls) {
+  for (int i = 0; i < fieldNames.size(); i++) {
+    int id = IdentifierTable::intern(fieldNames[i]);
+    if (id >= fieldIndex.size()) {
+      fieldIndex.resize(id + 1, -1);
+    }
+    fieldIndex[id] = i;
+  }
+}
+
+ASTDeclNode* SymbolTable::getFunction(const std::string& s) {
   auto func = functionNames.find(s);
   if(func == functionNames.end()) {
     return nullptr;
@@ -31,8 +60,8 @@ std::vector<ASTDeclNode*> SymbolTable::getFunctions() {
   return funDecls;
 }
 
-ASTDeclNode* SymbolTable::getLocal(std::string s, ASTDeclNode* f) {
-  auto lMap = localNames.find(f)->second;
+ASTDeclNode* SymbolTable::getLocal(const std::string& s, ASTDeclNode* f) {
+  auto& lMap = localNames.find(f)->second;
   auto local = lMap.find(s);
   if(local == lMap.end()) {
     return nullptr;
@@ -41,7 +70,7 @@ ASTDeclNode* SymbolTable::getLocal(std::string s, ASTDeclNode* f) {
 }
 
 std::vector<ASTDeclNode*> SymbolTable::getLocals(ASTDeclNode* f) {
-  auto lMap = localNames.find(f)->second;
+  auto& lMap = localNames.find(f)->second;
   std::vector<ASTDeclNode*> localDecls;
   for (auto &pair : lMap) {
     localDecls.push_back(pair.second); 
@@ -50,10 +79,17 @@ std::vector<ASTDeclNode*> SymbolTable::getLocals(ASTDeclNode* f) {
 }
 
 
-std::vector<std::string> SymbolTable::getFields() {
+const std::vector<std::string>& SymbolTable::getFields() {
   return fieldNames;
 }
 
+int SymbolTable::getFieldIndex(int id) {
+  if (id < 0 || id >= fieldIndex.size()) {
+    return -1;
+  }
+  return fieldIndex[id];
+}
+
 void SymbolTable::print(std::ostream &s) {
   s << "Functions : {"; 
   auto skip = true;
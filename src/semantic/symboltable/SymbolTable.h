@@ -11,23 +11,29 @@
  * There is a global map of for function names and a local map for
  * each function.  In addition it records the set of field names used
  * in the program.  Errors are reported by raising a SemanticError exception.
+ *
+ * Declarations are numbered densely, functions first in program order, and
+ * every variable reference is bound to its declaration.
+ * \sa NameResolver
  * \sa SemanticError
  */ 
 class SymbolTable {
   std::map<std::string, ASTDeclNode*> functionNames;
   std::map<ASTDeclNode*, std::map<std::string, ASTDeclNode*>> localNames;
   std::vector<std::string> fieldNames;
+  std::vector<int> fieldIndex;
+  std::vector<ASTDeclNode*> declarations;
 public:
   SymbolTable(std::map<std::string, ASTDeclNode*> fMap,
               std::map<ASTDeclNode*, std::map<std::string, ASTDeclNode*>> lMap,
-              std::vector<std::string> fSet)
-      : functionNames(fMap), localNames(lMap), fieldNames(fSet) {}
+              std::vector<std::string> fSet,
+              std::vector<ASTDeclNode*> decls = {});
 
   /*! \brief Return the declaration node for a given function name.
    * \param s The Function name
    * \return The declaration node of the function
    */
-  ASTDeclNode* getFunction(std::string s);
+  ASTDeclNode* getFunction(const std::string& s);
 
   /*! \brief Return the declaration nodes for functions in the program.
    */
@@ -38,16 +44,32 @@ public:
    * \param f The declaration node of the function
    * \return The declaration node of the local or parameter
    */
-  ASTDeclNode* getLocal(std::string s, ASTDeclNode* f);
+  ASTDeclNode* getLocal(const std::string& s, ASTDeclNode* f);
 
   /*! \brief Return the declaration nodes for locals and parameters in a function.
    * \param f The declaration node of the function.
    */
   std::vector<ASTDeclNode*> getLocals(ASTDeclNode* f);
 
+  /*! \brief Return the declaration node with a given number.
+   * \param i The number assigned to the declaration
+   */
+  ASTDeclNode* getDeclaration(int i) { return declarations[i]; }
+
+  /*! \brief Return the number of declarations in the program.
+   */
+  int getNumDeclarations() { return declarations.size(); }
+
   /*! \brief Returns the record field names referenced in the program.
    */
-  std::vector<std::string> getFields();
+  const std::vector<std::string>& getFields();
+
+  /*! \brief Return the position of a field among the fields of the program.
+   * \param id The interned identifier of the field name
+   * \return The position of the field in getFields(), or -1 if it is not referenced
+   * \sa IdentifierTable
+   */
+  int getFieldIndex(int id);
 
   /*! \fn build
    *  \brief Perform symbol analysis and construct symbol table.
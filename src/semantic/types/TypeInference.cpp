@@ -2,10 +2,20 @@
 #include "TypeConstraint.h"
 #include "TypeConstraintCollectVisitor.h"
 #include "AbsentFieldChecker.h"
+#include "TipTypeFactory.h"
+#include "TypeSummary.h"
+#include "TypeSummaryCache.h"
+#include "SemanticError.h"
 #include "Unifier.h"
 #include "loguru.hpp"
+#include "llvm/Support/TimeProfiler.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
 #include <memory>
+#include <thread>
 
 /*
  * This implementation collects the constraints and then solves them with a
@@ -13,26 +23,248 @@
  * can be subsequently queried.   It also checks for accesses to absent
  * fields.
  */
-std::unique_ptr<TypeInference> TypeInference::check(ASTProgram* ast, SymbolTable* symbols) {
+std::unique_ptr<TypeInference> TypeInference::check(ASTProgram* ast, SymbolTable* symbols, unsigned threads,
+                                                    unsigned unifyThreads) {
   LOG_S(1) << "Performing type inference";
+  return solve(ast, symbols, collect(ast, symbols, threads), unifyThreads);
+}
+
+/*
+ * Workers claim the next unprocessed function from a shared counter, so
+ * large functions do not hold up the others, and each writes its constraints
+ * to the slot of the function.  A worker stops at the first function that
+ * throws and records the exception in the slot of that function.  Once all
+ * of the workers have finished, the exception of the earliest function in
+ * the program is rethrown on the calling thread, so the error reported is
+ * the one a sequential walk would have reported.
+ */
+std::vector<TypeConstraint> TypeInference::collect(ASTProgram* ast, SymbolTable* symbols, unsigned threads) {
+  llvm::TimeTraceScope scope("TypeConstraints");
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  auto functions = ast->getFunctions();
+  if (threads == 1 || functions.size() <= 1) {
+    TypeConstraintCollectVisitor visitor(symbols);
+    ast->accept(&visitor);
+    return std::move(visitor.getCollectedConstraints());
+  }
+  threads = std::min<std::size_t>(threads, functions.size());
+
+  LOG_S(1) << "Generating type constraints on " << threads << " threads";
+
+  std::vector<std::vector<TypeConstraint>> perFunction(functions.size());
+  std::vector<std::exception_ptr> errors(functions.size());
+  std::atomic<std::size_t> next(0);
+  auto work = [&]() {
+    for (auto i = next++; i < functions.size(); i = next++) {
+      try {
+        TypeConstraintCollectVisitor visitor(symbols);
+        functions[i]->accept(&visitor);
+        perFunction[i] = std::move(visitor.getCollectedConstraints());
+      } catch (...) {
+        errors[i] = std::current_exception();
+        return;
+      }
+    }
+  };
 
-  TypeConstraintCollectVisitor visitor(symbols);
-  ast->accept(&visitor);
+  std::vector<std::thread> pool;
+  for (unsigned w = 1; w < threads; w++) {
+    pool.emplace_back(work);
+  }
+  work();
+  for (auto &t : pool) {
+    t.join();
+  }
+  for (auto &e : errors) {
+    if (e) {
+      std::rethrow_exception(e);
+    }
+  }
 
+  std::size_t total = 0;
+  for (auto &constraints : perFunction) {
+    total += constraints.size();
+  }
+  std::vector<TypeConstraint> collected;
+  collected.reserve(total);
+  for (auto &constraints : perFunction) {
+    std::move(constraints.begin(), constraints.end(), std::back_inserter(collected));
+  }
+  return collected;
+}
+
+std::unique_ptr<TypeInference> TypeInference::solve(ASTProgram* ast, SymbolTable* symbols,
+                                                    std::vector<TypeConstraint> constraints,
+                                                    unsigned threads) {
   LOG_S(1) << "Solving type constraints";
 
-  auto unifier =  std::make_unique<Unifier>(visitor.getCollectedConstraints());
-  unifier->solve();
+  auto unifier =  std::make_unique<Unifier>(std::move(constraints));
+  {
+    llvm::TimeTraceScope scope("Unify");
+    unifier->solve(threads);
+  }
 
   LOG_S(1) << "Checking that field accesses are defined";
 
-  AbsentFieldChecker::check(ast, unifier.get());
+  {
+    llvm::TimeTraceScope scope("AbsentFieldCheck");
+    AbsentFieldChecker::check(ast, unifier.get());
+  }
 
   return std::make_unique<TypeInference>(symbols, std::move(unifier));
 }
 
+/*
+ * A group whose constraints cannot be unified on their own, or a program
+ * whose summaries cannot be unified together, is checked again as a whole
+ * so that the error reported does not depend on the grouping.
+ *
+ * Groups only constrain one another through the functions their summaries
+ * refer to, so groups that are not connected by such references form
+ * independent systems.  A system made of the same groups as one that was
+ * solved before cannot fail and does not affect the others, so its
+ * summaries are only unified if the types are queried.
+ */
+std::unique_ptr<TypeInference> TypeInference::checkIncremental(ASTProgram* ast, SymbolTable* symbols,
+                                                               std::vector<std::vector<ASTFunction*>> const &components,
+                                                               TypeSummaryCache* cache,
+                                                               unsigned threads, unsigned unifyThreads) {
+  LOG_S(1) << "Performing type inference on " << components.size() << " components";
+
+  std::vector<std::string> keys;
+  std::vector<std::vector<TypeConstraint>> equations(components.size());
+  std::vector<std::vector<std::string>> externals(components.size());
+
+  int reused = 0;
+  for (std::size_t c = 0; c < components.size(); c++) {
+    auto &component = components[c];
+    llvm::TimeTraceScope scope("TypeSummary", component.front()->getName());
+    keys.push_back(TypeSummary::key(component, symbols));
+    auto summary = cache->find(keys.back());
+    if (summary != nullptr && summary->instantiate(component, symbols, equations[c])) {
+      reused++;
+    } else {
+      summary = TypeSummary::summarize(component, symbols);
+      if (summary == nullptr) {
+        return check(ast, symbols, threads, unifyThreads);
+      }
+      summary->instantiate(component, symbols, equations[c]);
+      cache->insert(keys.back(), summary);
+    }
+    externals[c] = summary->getExternals();
+  }
+
+  std::map<ASTDeclNode*, int> componentOf;
+  for (std::size_t c = 0; c < components.size(); c++) {
+    for (auto f : components[c]) {
+      componentOf[f->getDecl()] = c;
+    }
+  }
+  std::vector<int> system(components.size());
+  for (std::size_t c = 0; c < components.size(); c++) {
+    system[c] = c;
+  }
+  auto root = [&](int c) {
+    while (system[c] != c) {
+      c = system[c] = system[system[c]];
+    }
+    return c;
+  };
+  for (std::size_t c = 0; c < components.size(); c++) {
+    for (auto &name : externals[c]) {
+      auto callee = componentOf.find(symbols->getFunction(name));
+      if (callee != componentOf.end()) {
+        system[root(c)] = root(callee->second);
+      }
+    }
+  }
+
+  std::map<int, std::vector<int>> systems;
+  for (std::size_t c = 0; c < components.size(); c++) {
+    systems[root(c)].push_back(c);
+  }
+
+  std::vector<TypeConstraint> constraints, deferred;
+  std::vector<std::string> checked;
+  for (auto &[_, members] : systems) {
+    std::vector<std::string> memberKeys;
+    for (auto c : members) {
+      memberKeys.push_back(keys[c]);
+    }
+    auto key = TypeSummary::key(memberKeys);
+    auto &target = cache->isSolved(key) ? deferred : constraints;
+    if (&target == &constraints) {
+      checked.push_back(key);
+    }
+    for (auto c : members) {
+      std::move(equations[c].begin(), equations[c].end(), std::back_inserter(target));
+    }
+  }
+
+  LOG_S(1) << "Reused the types of " << reused << " of " << components.size() << " components, "
+           << systems.size() - checked.size() << " of " << systems.size() << " independent parts are unchanged";
+
+  try {
+    auto result = solve(ast, symbols, std::move(constraints), unifyThreads);
+    result->deferred = std::move(deferred);
+    for (auto &key : checked) {
+      cache->markSolved(key);
+    }
+    return result;
+  } catch (SemanticError &e) {
+    return check(ast, symbols, threads, unifyThreads);
+  }
+}
+
+/*
+ * Close the types of all functions and their locals together so that the
+ * unifier can share the work on common subterms.
+ */
+void TypeInference::closeAll() {
+  for (auto &c : deferred) {
+    unifier->unify(c.lhs, c.rhs);
+  }
+  deferred.clear();
+
+  std::vector<ASTDeclNode*> decls;
+  for (auto f : symbols->getFunctions()) {
+    decls.push_back(f);
+    for (auto l : symbols->getLocals(f)) {
+      decls.push_back(l);
+    }
+  }
+
+  std::vector<std::shared_ptr<TipType>> vars;
+  for (auto d : decls) {
+    vars.push_back(TipTypeFactory::var(d));
+  }
+
+  auto types = unifier->inferredAll(vars);
+  for (std::size_t i = 0; i < decls.size(); i++) {
+    inferredTypes[decls[i]] = types[i];
+  }
+  closedAll = true;
+}
+
+void TypeInference::close() {
+  if (!closedAll) {
+    closeAll();
+  }
+}
+
 std::shared_ptr<TipType> TypeInference::getInferredType(ASTDeclNode *node) {
-  auto var = std::make_shared<TipVar>(node);
+  close();
+
+  auto found = inferredTypes.find(node);
+  if (found != inferredTypes.end()) {
+    return found->second;
+  }
+
+  // Not a name declared in the symbol table
+  auto var = TipTypeFactory::var(node);
   return unifier->inferred(var);
 };
 
@@ -4,8 +4,12 @@
 #include "ASTDeclNode.h"
 #include "SymbolTable.h"
 #include "Unifier.h"
+#include "TypeConstraint.h"
+#include <map>
 #include <memory>
 
+class TypeSummaryCache;
+
 /*! \class TypeInference
  *  \brief Perform type inference and checking.
  *
@@ -15,6 +19,14 @@
 class TypeInference {
   SymbolTable* symbols;
   std::unique_ptr<Unifier> unifier;
+
+  // Inferred types of the declared names, computed on first query.
+  std::map<ASTDeclNode*, std::shared_ptr<TipType>> inferredTypes;
+  bool closedAll = false;
+  void closeAll();
+
+  // Constraints known to be solvable, unified on the first query.
+  std::vector<TypeConstraint> deferred;
 public:
   TypeInference(SymbolTable* s, std::unique_ptr<Unifier> u) : symbols(s), unifier(std::move(u)) {}
 
@@ -30,8 +42,78 @@ public:
    * \sa SemanticError
    * \param ast The program AST
    * \param symbols The symbol table
+   * \param threads The number of threads used to generate constraints
+   * \param unifyThreads The number of threads used to unify constraints
+   * \sa collect
+   * \sa solve
+   */
+  static std::unique_ptr<TypeInference> check(ASTProgram* ast, SymbolTable* symbols, unsigned threads = 1,
+                                              unsigned unifyThreads = 1);
+
+  /*! \fn collect
+   *  \brief Generate the type constraints for a program.
+   *
+   * The constraints for a function depend only on the symbol table, so with
+   * more than one thread the functions are distributed over a pool of worker
+   * threads.  The constraints of each function are then concatenated in
+   * program order, so the result is the same as that of a single walk.
+   * \param ast The program AST
+   * \param symbols The symbol table
+   * \param threads The number of threads to use, 0 for one per hardware thread
+   * \return The constraints in the order they are generated by a walk of the program
+   */
+  static std::vector<TypeConstraint> collect(ASTProgram* ast, SymbolTable* symbols, unsigned threads = 1);
+
+  /*! \fn solve
+   *  \brief Unify type constraints that have already been collected and report any errors.
+   *
+   * This performs the second half of check, for clients that collect the
+   * constraints in a walk of the AST shared with other passes.  Errors are
+   * reported as for check.
+   * \sa TypeConstraintCollectVisitor
+   * \param ast The program AST
+   * \param symbols The symbol table
+   * \param constraints The type constraints collected for the program
+   * \param threads The number of threads used to unify the constraints.  With
+   * more than one the names of free type variables in the inferred types may
+   * differ from run to run.
+   * \sa Unifier::solve
+   */
+  static std::unique_ptr<TypeInference> solve(ASTProgram* ast, SymbolTable* symbols,
+                                              std::vector<TypeConstraint> constraints,
+                                              unsigned threads = 1);
+
+  /*! \fn checkIncremental
+   *  \brief Check the program one group of functions at a time, reusing cached results.
+   *
+   * The constraints of each group are replaced by its TypeSummary, which is
+   * taken from the cache if the text of the group is unchanged and is
+   * otherwise computed and added to the cache.  The summaries mention the
+   * types of the functions a group calls without depending on them, so an
+   * edit to one group requires only its summary to be recomputed.  The
+   * summaries are then solved together, callees first.  Groups that refer to
+   * one another, directly or not, form a system that is independent of the
+   * rest of the program.  If the cache records that the same system was
+   * solved before, its summaries are not unified until a type is queried.
+   *
+   * The inferred types of declared names are those computed by check, up to
+   * the names of free type variables, so the types printed for a program may
+   * differ in those names from the types printed without a cache.  Types of
+   * other nodes are not retained.
+   * If the program has a type error then the error is the one raised by check.
+   * \param ast The program AST
+   * \param symbols The symbol table
+   * \param components The groups of functions, typically the strongly connected
+   * components of the references between functions in reverse topological order
+   * \param cache The cache of summaries
+   * \param threads The number of threads used to generate constraints if the program is checked as a whole
+   * \param unifyThreads The number of threads used to unify the summaries
+   * \sa TypeSummary
    */
-  static std::unique_ptr<TypeInference> check(ASTProgram* ast, SymbolTable* symbols); 
+  static std::unique_ptr<TypeInference> checkIncremental(ASTProgram* ast, SymbolTable* symbols,
+                                                         std::vector<std::vector<ASTFunction*>> const &components,
+                                                         TypeSummaryCache* cache,
+                                                         unsigned threads = 1, unsigned unifyThreads = 1);
 
   /*! \fn getInferredType
    *  \brief Returns the type expression inferred for the given ASTDeclNode.
@@ -41,6 +123,8 @@ public:
    * inferred type will be a free type variable.  A managed pointer is returned for exactly
    * this case -- when a fresh variable is generated and returned.  In other cases, the
    * resulting type will be shared with those computed during inference -- hence a shared pointer.
+   * The first query closes the types of all names declared in the symbol table in a single
+   * pass, so subsequent queries are lookups.
    *
    * \sa TipType
    * \sa ASTDeclNode
@@ -49,6 +133,21 @@ public:
    */
   std::shared_ptr<TipType> getInferredType(ASTDeclNode *node);
 
+  /*! \fn close
+   *  \brief Close the types of all names declared in the symbol table, unless they are closed already.
+   *
+   * The first query of getInferredType otherwise closes them, which updates the
+   * unifier.  Once they are closed, queries for declared names only read the
+   * results, so they may be made by several threads at the same time.
+   */
+  void close();
+
   //! Print type inference results to output stream
   void print(std::ostream &os);
+
+  //! \brief Returns the number of type constraints that were solved.
+  std::size_t getNumConstraints() const { return unifier->getNumConstraints(); }
+
+  //! \brief Returns the number of terms the unifier has created for the constraints and the queries so far.
+  std::size_t getNumTerms() const { return unifier->getNumTerms(); }
 };
@@ -6,6 +6,10 @@
 TipAbsentField::TipAbsentField() { }
 
 bool TipAbsentField::operator==(const TipType &other) const {
+    if(this == &other) {
+        return true;
+    }
+
     auto otherTipAbsentField = dynamic_cast<TipAbsentField const *>(&other);
     if(!otherTipAbsentField) {
         return false;
@@ -17,6 +17,10 @@ std::ostream &TipAlpha::print(std::ostream &out) const {
 }
 
 bool TipAlpha::operator==(const TipType &other) const {
+    if(this == &other) {
+        return true;
+    }
+
     auto otherTipAlpha = dynamic_cast<const TipAlpha *>(&other);
     if(!otherTipAlpha) {
         return false;
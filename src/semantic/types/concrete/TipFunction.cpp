@@ -33,6 +33,10 @@ std::ostream &TipFunction::print(std::ostream &out) const {
 }
 
 bool TipFunction::operator==(const TipType &other) const {
+    if(this == &other) {
+        return true;
+    }
+
     auto otherTipFunction = dynamic_cast<const TipFunction *>(&other);
     if(!otherTipFunction) {
         return false;
@@ -6,6 +6,10 @@
 TipInt::TipInt() { }
 
 bool TipInt::operator==(const TipType &other) const {
+    if(this == &other) {
+        return true;
+    }
+
     auto otherTipInt = dynamic_cast<TipInt const *>(&other);
     if(!otherTipInt) {
         return false;
@@ -14,6 +14,10 @@ const std::shared_ptr<TipType> &TipMu::getT() const {
 }
 
 bool TipMu::operator==(const TipType &other) const {
+    if(this == &other) {
+        return true;
+    }
+
     auto mu = dynamic_cast<const TipMu *>(&other);
     if(!mu) {
       return false;
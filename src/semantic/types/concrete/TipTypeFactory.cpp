@@ -0,0 +1,177 @@
+#include "TipTypeFactory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace { // Anonymous namespace for local helpers
+
+enum Kind { VAR, ALPHA, INT, ABSENT, REF, FUNCTION, RECORD, MU };
+
+/*
+ * Terms are keyed by their constructor, their node (for variables), their
+ * names (for alphas and records), and the identity of their arguments.
+ */
+struct Key {
+  Kind kind;
+  ASTNode *node;
+  std::vector<TipType const *> args;
+  std::vector<std::string> names;
+
+  bool operator==(Key const &other) const {
+    return kind == other.kind && node == other.node && args == other.args && names == other.names;
+  }
+};
+
+struct KeyHash {
+  std::size_t operator()(Key const &key) const {
+    std::size_t h = std::hash<int>{}(key.kind);
+    auto combine = [&h](std::size_t v) { h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2); };
+    combine(std::hash<ASTNode *>{}(key.node));
+    for (auto a : key.args) {
+      combine(std::hash<TipType const *>{}(a));
+    }
+    for (auto &n : key.names) {
+      combine(std::hash<std::string>{}(n));
+    }
+    return h;
+  }
+};
+
+using Table = std::unordered_map<Key, std::weak_ptr<TipType>, KeyHash>;
+
+/*
+ * The terms are spread over shards by the hash of their key, each with its
+ * own lock, so that threads generating constraints for different functions
+ * seldom wait on one another.  Shards are padded to a cache line so that
+ * their locks are not falsely shared.
+ */
+struct alignas(64) Shard {
+  std::mutex mutex;
+  Table table;
+  // Expired entries are swept when the table grows past this bound
+  std::size_t sweepBound = 1024;
+
+  void sweep() {
+    for (auto it = table.begin(); it != table.end();) {
+      if (it->second.expired()) {
+        it = table.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    sweepBound = std::max<std::size_t>(1024, 2 * table.size());
+  }
+};
+
+constexpr std::size_t NUM_SHARDS = 64;
+
+Shard *shards() {
+  static Shard s[NUM_SHARDS];
+  return s;
+}
+
+template <typename T, typename... Args>
+std::shared_ptr<T> intern(Key key, Args&&... args) {
+  auto &shard = shards()[KeyHash{}(key) % NUM_SHARDS];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto &t = shard.table;
+  auto found = t.find(key);
+  if (found != t.end()) {
+    if (auto existing = found->second.lock()) {
+      return std::static_pointer_cast<T>(existing);
+    }
+  }
+
+  if (t.size() >= shard.sweepBound) {
+    shard.sweep();
+  }
+
+  auto term = std::make_shared<T>(std::forward<Args>(args)...);
+  t[std::move(key)] = term;
+  return term;
+}
+
+std::vector<TipType const *> identities(std::vector<std::shared_ptr<TipType>> const &args) {
+  std::vector<TipType const *> ids;
+  ids.reserve(args.size());
+  for (auto &a : args) {
+    ids.push_back(a.get());
+  }
+  return ids;
+}
+
+} // namespace
+
+std::shared_ptr<TipVar> TipTypeFactory::var(ASTNode *node) {
+  return intern<TipVar>(Key{VAR, node, {}, {}}, node);
+}
+
+std::shared_ptr<TipAlpha> TipTypeFactory::alpha(ASTNode *node, std::string const &name) {
+  return intern<TipAlpha>(Key{ALPHA, node, {}, {name}}, node, name);
+}
+
+std::shared_ptr<TipInt> TipTypeFactory::intType() {
+  return intern<TipInt>(Key{INT, nullptr, {}, {}});
+}
+
+std::shared_ptr<TipAbsentField> TipTypeFactory::absentField() {
+  return intern<TipAbsentField>(Key{ABSENT, nullptr, {}, {}});
+}
+
+std::shared_ptr<TipRef> TipTypeFactory::ref(std::shared_ptr<TipType> of) {
+  return intern<TipRef>(Key{REF, nullptr, {of.get()}, {}}, of);
+}
+
+std::shared_ptr<TipFunction> TipTypeFactory::function(std::vector<std::shared_ptr<TipType>> params,
+                                                      std::shared_ptr<TipType> ret) {
+  auto ids = identities(params);
+  ids.push_back(ret.get());
+  return intern<TipFunction>(Key{FUNCTION, nullptr, std::move(ids), {}}, params, ret);
+}
+
+std::shared_ptr<TipRecord> TipTypeFactory::record(std::vector<std::shared_ptr<TipType>> inits,
+                                                  std::vector<std::string> names) {
+  return intern<TipRecord>(Key{RECORD, nullptr, identities(inits), names}, inits, names);
+}
+
+std::shared_ptr<TipMu> TipTypeFactory::mu(std::shared_ptr<TipVar> v, std::shared_ptr<TipType> t) {
+  return intern<TipMu>(Key{MU, nullptr, {v.get(), t.get()}, {}}, v, t);
+}
+
+/*! \brief Dispatch on the dynamic subtype of c.
+ * Like TipCons::doMatch, this explicitly tests the subtypes and must be
+ * extended if a new subtype of TipCons is added.
+ */
+std::shared_ptr<TipCons> TipTypeFactory::cons(TipCons const *c, std::vector<std::shared_ptr<TipType>> args) {
+  if (dynamic_cast<TipFunction const *>(c)) {
+    auto ret = args.back();
+    args.pop_back();
+    return function(args, ret);
+  } else if (auto r = dynamic_cast<TipRecord const *>(c)) {
+    return record(args, r->getNames());
+  } else if (dynamic_cast<TipRef const *>(c)) {
+    return ref(args.front());
+  } else if (dynamic_cast<TipInt const *>(c)) {
+    return intType();
+  }
+
+  assert(dynamic_cast<TipAbsentField const *>(c));
+  return absentField();
+}
+
+std::size_t TipTypeFactory::size() {
+  std::size_t live = 0;
+  for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+    auto &shard = shards()[i];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (auto &entry : shard.table) {
+      if (!entry.second.expired()) {
+        live++;
+      }
+    }
+  }
+  return live;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Type.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*! \class TipTypeFactory
+ *  \brief Interning factory for type terms.
+ *
+ * The factory hash-conses type terms: a request for a term whose kind,
+ * associated AST node, names, and argument objects match a live term
+ * returns that term rather than allocating a new one.  When arguments are
+ * themselves obtained from the factory, structurally equal types are a
+ * single object, so the equality operators succeed on their pointer
+ * comparison fast path and rebuilding a type with unchanged arguments
+ * shares the existing subtree.
+ *
+ * Interned terms must be treated as immutable since they may be shared.
+ * The factory only holds weak references, so terms are reclaimed once the
+ * last user releases them.
+ *
+ * The factory may be used from several threads at once.
+ */
+class TipTypeFactory {
+public:
+    static std::shared_ptr<TipVar> var(ASTNode *node);
+    static std::shared_ptr<TipAlpha> alpha(ASTNode *node, std::string const &name = "");
+    static std::shared_ptr<TipInt> intType();
+    static std::shared_ptr<TipAbsentField> absentField();
+    static std::shared_ptr<TipRef> ref(std::shared_ptr<TipType> of);
+    static std::shared_ptr<TipFunction> function(std::vector<std::shared_ptr<TipType>> params,
+                                                 std::shared_ptr<TipType> ret);
+    static std::shared_ptr<TipRecord> record(std::vector<std::shared_ptr<TipType>> inits,
+                                             std::vector<std::string> names);
+    static std::shared_ptr<TipMu> mu(std::shared_ptr<TipVar> v, std::shared_ptr<TipType> t);
+
+    /*! \brief Produce a term of the same constructor as c with the given arguments.
+     *
+     * The arguments follow the TipCons conventions, e.g., for functions the
+     * return type is the last argument.
+     */
+    static std::shared_ptr<TipCons> cons(TipCons const *c, std::vector<std::shared_ptr<TipType>> args);
+
+    //! \brief The number of live interned terms.
+    static std::size_t size();
+};
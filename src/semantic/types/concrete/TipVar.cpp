@@ -8,6 +8,10 @@
 TipVar::TipVar(ASTNode * node): node(node) {};
 
 bool TipVar::operator==(const TipType &other) const {
+    if(this == &other) {
+        return true;
+    }
+
     auto otherTipVar = dynamic_cast<TipVar const *>(&other);
     auto otherTipAlpha = dynamic_cast<TipAlpha const *>(&other);
     if(!otherTipVar || otherTipAlpha) {
@@ -1,6 +1,7 @@
 #include "AbsentFieldChecker.h"
 #include "TipVar.h"
 #include "TipAbsentField.h"
+#include "TipTypeFactory.h"
 #include "SemanticError.h"
 
 #include <sstream>
@@ -9,6 +10,13 @@ void AbsentFieldChecker::check(ASTProgram* p, Unifier* u)
 {
   AbsentFieldChecker visitor(u);
   p->accept(&visitor);
+  visitor.checkAccesses();
+}
+
+/*! \brief Record the access so that all accesses can be checked together.
+ */
+void AbsentFieldChecker::endVisit(ASTAccessExpr * element) {
+  accesses.push_back(element);
 }
 
 /*! \brief Check that the accessed field is defined somewhere in the program.
@@ -16,22 +24,26 @@ void AbsentFieldChecker::check(ASTProgram* p, Unifier* u)
  * This check is a bit less nuanced than in the TIP scala implementation.
  * We simply report absent field accesses and do not distinguish reads from writes.
  */
-void AbsentFieldChecker::endVisit(ASTAccessExpr * element) {
-  // Generate a new type variable for the access expression
-  auto typeVar = std::make_shared<TipVar>(element);
+void AbsentFieldChecker::checkAccesses() {
+  // Generate a new type variable for each access expression
+  std::vector<std::shared_ptr<TipType>> typeVars;
+  for (auto a : accesses) {
+    typeVars.push_back(TipTypeFactory::var(a));
+  }
 
-  // Look up the inferred type for this variable in the type judgements
-  auto inferredType = unifier->inferred(typeVar);
+  // Look up the inferred types for these variables in the type judgements
+  auto inferredTypes = unifier->inferredAll(typeVars);
 
-  // If the inferred type is an absent field, exit with an error message
-  if (std::dynamic_pointer_cast<TipAbsentField>(inferredType) != nullptr) {
-    std::stringstream sstream; 
-    sstream << element;
-    throw SemanticError("Access to absent field on line " + 
-          std::to_string(element->getLine()) + " in column " + 
-          std::to_string(element->getColumn()) + ": " + 
-          sstream.str());
+  // If an inferred type is an absent field, exit with an error message
+  for (std::size_t i = 0; i < accesses.size(); i++) {
+    if (std::dynamic_pointer_cast<TipAbsentField>(inferredTypes[i]) != nullptr) {
+      auto element = accesses[i];
+      std::stringstream sstream; 
+      sstream << element;
+      throw SemanticError("Access to absent field on line " + 
+            std::to_string(element->getLine()) + " in column " + 
+            std::to_string(element->getColumn()) + ": " + 
+            sstream.str());
+    }
   }
-
 }
-
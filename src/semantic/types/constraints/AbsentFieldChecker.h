@@ -2,6 +2,7 @@
 
 #include "ASTVisitor.h"
 #include "Unifier.h"
+#include <vector>
 
 /*! \class AbsentFieldChecker
  *  \brief Visits AST and checks that all field accesses are to defined fields
@@ -17,6 +18,7 @@
  */
 class AbsentFieldChecker : public ASTVisitor {
   Unifier* unifier;
+  std::vector<ASTAccessExpr*> accesses;
 public:
   AbsentFieldChecker(Unifier* u) : unifier(u) {} 
 
@@ -29,6 +31,11 @@ public:
    */
   static void check(ASTProgram* p, Unifier* u);
 
+  /*! \fn checkAccesses
+   *  \brief Check the collected field accesses, in visit order, using a single batch of inferred types.
+   */
+  void checkAccesses();
+
   void endVisit(ASTAccessExpr * element) override;
 };
 
@@ -6,6 +6,7 @@
 #include "TipRecord.h"
 #include "TipAbsentField.h"
 #include "TipInt.h"
+#include "TipTypeFactory.h"
 
 TypeConstraintVisitor::TypeConstraintVisitor(SymbolTable* st, std::unique_ptr<ConstraintHandler> handler)
   : symbolTable(st), constraintHandler(std::move(handler)) {};
@@ -14,26 +15,16 @@ TypeConstraintVisitor::TypeConstraintVisitor(SymbolTable* st, std::unique_ptr<Co
  *  \brief Convert an AST node to a type variable.
  *
  * Utility function that creates type variables and uses declaration nodes
- * as a canonical representative for program variables.  There are two case
- * that need to be checked: if the variable is local to a function or if
- * it is a function value.
+ * as a canonical representative for program variables.  Variable references
+ * are bound to the declaration of the local or function they name during
+ * symbol analysis.
  */
 std::shared_ptr<TipType> TypeConstraintVisitor::astToVar(ASTNode * n) {
   if (auto ve = dynamic_cast<ASTVariableExpr*>(n)) {
-    ASTDeclNode * canonical;
-    if ((canonical = symbolTable->getLocal(ve->getName(), scope.top()))) {
-      return std::make_shared<TipVar>(canonical);
-    } else if ((canonical = symbolTable->getFunction(ve->getName()))) {
-      return std::make_shared<TipVar>(canonical);
-    } 
+    return TipTypeFactory::var(ve->getDecl());
   }  // LCOV_EXCL_LINE
 
-  return std::make_shared<TipVar>(n);
-}
-
-bool TypeConstraintVisitor::visit(ASTFunction * element) {
-    scope.push(element->getDecl());
-    return true;
+  return TipTypeFactory::var(n);
 }
 
 /*! \brief Type constraints for function definition.
@@ -51,15 +42,15 @@ void TypeConstraintVisitor::endVisit(ASTFunction * element) {
     for(auto &f : element->getFormals()) {
       formals.push_back(astToVar(f));
       // all formals are int
-      constraintHandler->handle(astToVar(f), std::make_shared<TipInt>());
+      constraintHandler->handle(astToVar(f), TipTypeFactory::intType());
     }
 
     // Return is the last statement and must be int
     auto ret = dynamic_cast<ASTReturnStmt*>(element->getStmts().back());
-    constraintHandler->handle(astToVar(ret->getArg()), std::make_shared<TipInt>());
+    constraintHandler->handle(astToVar(ret->getArg()), TipTypeFactory::intType());
 
     constraintHandler->handle(astToVar(element->getDecl()),
-                              std::make_shared<TipFunction>(formals, astToVar(ret->getArg())));
+                              TipTypeFactory::function(formals, astToVar(ret->getArg())));
   } else {
     std::vector<std::shared_ptr<TipType>> formals;
     for(auto &f : element->getFormals()) {
@@ -70,7 +61,7 @@ void TypeConstraintVisitor::endVisit(ASTFunction * element) {
     auto ret = dynamic_cast<ASTReturnStmt*>(element->getStmts().back());
 
     constraintHandler->handle(astToVar(element->getDecl()),
-                              std::make_shared<TipFunction>(formals, astToVar(ret->getArg())));
+                              TipTypeFactory::function(formals, astToVar(ret->getArg())));
   }
 }
 
@@ -80,7 +71,7 @@ void TypeConstraintVisitor::endVisit(ASTFunction * element) {
  *   [[I]] = int
  */
 void TypeConstraintVisitor::endVisit(ASTNumberExpr * element) {
-    constraintHandler->handle(astToVar(element), std::make_shared<TipInt>());
+    constraintHandler->handle(astToVar(element), TipTypeFactory::intType());
 }
 
 /*! \brief Type constraints for binary operator.
@@ -94,7 +85,7 @@ void TypeConstraintVisitor::endVisit(ASTNumberExpr * element) {
  */
 void TypeConstraintVisitor::endVisit(ASTBinaryExpr  * element) {
   auto op = element->getOp();
-  auto intType = std::make_shared<TipInt>();
+  auto intType = TipTypeFactory::intType();
 
   // result type is integer
   constraintHandler->handle(astToVar(element), intType);
@@ -115,7 +106,7 @@ void TypeConstraintVisitor::endVisit(ASTBinaryExpr  * element) {
  *  [[input]] = int
  */
 void TypeConstraintVisitor::endVisit(ASTInputExpr * element) {
-  constraintHandler->handle(astToVar(element), std::make_shared<TipInt>());
+  constraintHandler->handle(astToVar(element), TipTypeFactory::intType());
 }
 
 /*! \brief Type constraints for function application.
@@ -129,7 +120,7 @@ void TypeConstraintVisitor::endVisit(ASTFunAppExpr  * element) {
     actuals.push_back(astToVar(a));
   }
   constraintHandler->handle(astToVar(element->getFunction()),
-                            std::make_shared<TipFunction>(actuals, astToVar(element)));
+                            TipTypeFactory::function(actuals, astToVar(element)));
 }
 
 /*! \brief Type constraints for heap allocation.
@@ -139,7 +130,7 @@ void TypeConstraintVisitor::endVisit(ASTFunAppExpr  * element) {
  */
 void TypeConstraintVisitor::endVisit(ASTAllocExpr * element) {
   constraintHandler->handle(astToVar(element),
-                            std::make_shared<TipRef>(astToVar(element->getInitializer())));
+                            TipTypeFactory::ref(astToVar(element->getInitializer())));
 }
 
 /*! \brief Type constraints for address of.
@@ -149,7 +140,7 @@ void TypeConstraintVisitor::endVisit(ASTAllocExpr * element) {
  */
 void TypeConstraintVisitor::endVisit(ASTRefExpr * element) {
   constraintHandler->handle(astToVar(element),
-                            std::make_shared<TipRef>(astToVar(element->getVar())));
+                            TipTypeFactory::ref(astToVar(element->getVar())));
 }
 
 /*! \brief Type constraints for pointer dereference.
@@ -159,7 +150,7 @@ void TypeConstraintVisitor::endVisit(ASTRefExpr * element) {
  */
 void TypeConstraintVisitor::endVisit(ASTDeRefExpr * element) {
   constraintHandler->handle(astToVar(element->getPtr()),
-                            std::make_shared<TipRef>(astToVar(element)));
+                            TipTypeFactory::ref(astToVar(element)));
 }
 
 /*! \brief Type constraints for null literal.
@@ -169,7 +160,7 @@ void TypeConstraintVisitor::endVisit(ASTDeRefExpr * element) {
  */
 void TypeConstraintVisitor::endVisit(ASTNullExpr * element) {
   constraintHandler->handle(astToVar(element),
-                            std::make_shared<TipRef>(std::make_shared<TipAlpha>(element)));
+                            TipTypeFactory::ref(TipTypeFactory::alpha(element)));
 }
 
 /*! \brief Type rules for assignments.
@@ -188,7 +179,7 @@ void TypeConstraintVisitor::endVisit(ASTAssignStmt  * element) {
   // If this is an assignment through a pointer, use the second rule above
   if (auto lptr = dynamic_cast<ASTDeRefExpr*>(element->getLHS())) {
     constraintHandler->handle(astToVar(lptr->getPtr()),
-                              std::make_shared<TipRef>(astToVar(element->getRHS())));
+                              TipTypeFactory::ref(astToVar(element->getRHS())));
   } else {
     constraintHandler->handle(astToVar(element->getLHS()), astToVar(element->getRHS()));
   }
@@ -200,7 +191,7 @@ void TypeConstraintVisitor::endVisit(ASTAssignStmt  * element) {
  *   [[E]] = int
  */
 void TypeConstraintVisitor::endVisit(ASTWhileStmt * element) {
-  constraintHandler->handle(astToVar(element->getCondition()), std::make_shared<TipInt>());
+  constraintHandler->handle(astToVar(element->getCondition()), TipTypeFactory::intType());
 }
 
 /*! \brief Type constraints for if statement.
@@ -209,7 +200,7 @@ void TypeConstraintVisitor::endVisit(ASTWhileStmt * element) {
  *   [[E]] = int
  */
 void TypeConstraintVisitor::endVisit(ASTIfStmt * element) {
-  constraintHandler->handle(astToVar(element->getCondition()), std::make_shared<TipInt>());
+  constraintHandler->handle(astToVar(element->getCondition()), TipTypeFactory::intType());
 }
 
 /*! \brief Type constraints for output statement.
@@ -218,7 +209,7 @@ void TypeConstraintVisitor::endVisit(ASTIfStmt * element) {
  *   [[E]] = int
  */
 void TypeConstraintVisitor::endVisit(ASTOutputStmt * element) {
-  constraintHandler->handle(astToVar(element->getArg()), std::make_shared<TipInt>());
+  constraintHandler->handle(astToVar(element->getArg()), TipTypeFactory::intType());
 }
 
 /*! \brief Type constraints for record expression.
@@ -229,22 +220,21 @@ void TypeConstraintVisitor::endVisit(ASTOutputStmt * element) {
  * and vi = [[Ei]] if fi = Xi and \alpha otherwise
  */
 void TypeConstraintVisitor::endVisit(ASTRecordExpr * element) {
-  auto allFields = symbolTable->getFields();
-  std::vector<std::shared_ptr<TipType>> fieldTypes;
-  for (auto &f : allFields) {
-    bool matched = false;
-    for (auto &fe : element->getFields()) {
-      if (f == fe->getField()) {
-        fieldTypes.push_back(astToVar(fe->getInitializer()));
-        matched = true;
-        break;
-      }
+  auto &allFields = symbolTable->getFields();
+  std::vector<std::shared_ptr<TipType>> fieldTypes(allFields.size());
+  for (auto &fe : element->getFields()) {
+    auto &fieldType = fieldTypes[symbolTable->getFieldIndex(fe->getFieldId())];
+    // the first initializer of a repeated field is the one that counts
+    if (fieldType == nullptr) {
+      fieldType = astToVar(fe->getInitializer());
     }
-    if (matched) continue;
-
-    fieldTypes.push_back(std::make_shared<TipAbsentField>());
-  } 
-  constraintHandler->handle(astToVar(element), std::make_shared<TipRecord>(fieldTypes, allFields));
+  }
+  for (auto &fieldType : fieldTypes) {
+    if (fieldType == nullptr) {
+      fieldType = TipTypeFactory::absentField();
+    }
+  }
+  constraintHandler->handle(astToVar(element), TipTypeFactory::record(fieldTypes, allFields));
 }
 
 /*! \brief Type constraints for field access.
@@ -255,17 +245,18 @@ void TypeConstraintVisitor::endVisit(ASTRecordExpr * element) {
  * and vi = [[E.X]] if fi = X and \alpha otherwise
  */
 void TypeConstraintVisitor::endVisit(ASTAccessExpr * element) {
-  auto allFields = symbolTable->getFields();
+  auto &allFields = symbolTable->getFields();
+  auto accessed = symbolTable->getFieldIndex(element->getFieldId());
   std::vector<std::shared_ptr<TipType>> fieldTypes;
-  for (auto &f : allFields) {
-    if (f == element->getField()) {
+  for (int i = 0; i < allFields.size(); i++) {
+    if (i == accessed) {
       fieldTypes.push_back(astToVar(element));
     } else {
-      fieldTypes.push_back(std::make_shared<TipAlpha>(element, f));
+      fieldTypes.push_back(TipTypeFactory::alpha(element, allFields[i]));
     }
   } 
   constraintHandler->handle(astToVar(element->getRecord()),
-                            std::make_shared<TipRecord>(fieldTypes, allFields));
+                            TipTypeFactory::record(fieldTypes, allFields));
 }
 
 /*! \brief Type constraints for error statement.
@@ -274,6 +265,6 @@ void TypeConstraintVisitor::endVisit(ASTAccessExpr * element) {
  *   [[E]] = int
  */
 void TypeConstraintVisitor::endVisit(ASTErrorStmt * element) {
-  constraintHandler->handle(astToVar(element->getArg()), std::make_shared<TipInt>());
+  constraintHandler->handle(astToVar(element->getArg()), TipTypeFactory::intType());
 }
 
@@ -6,7 +6,6 @@
 #include "TipType.h"
 #include <memory>
 #include <set>
-#include <stack>
 #include <string>
 #include <vector>
 
@@ -35,7 +34,6 @@ public:
      */
     TypeConstraintVisitor(SymbolTable* st, std::unique_ptr<ConstraintHandler> handler);
 
-    bool visit(ASTFunction * element) override;
     void endVisit(ASTAccessExpr * element) override;
     void endVisit(ASTAllocExpr * element) override;
     void endVisit(ASTAssignStmt * element) override;
@@ -57,7 +55,6 @@ protected:
     std::unique_ptr<ConstraintHandler> constraintHandler;
 
 private:
-    std::stack<ASTDeclNode *> scope;
     SymbolTable *symbolTable;
     std::shared_ptr<TipType> astToVar(ASTNode * n);
 };
@@ -0,0 +1,101 @@
+#include "ConcurrentUnionFind.h"
+
+ConcurrentUnionFind::ConcurrentUnionFind(std::size_t size)
+    : count(size), words(new std::atomic<Word>[size]) {
+    for (std::size_t id = 0; id < size; id++) {
+        words[id].store(pack(id, none), std::memory_order_relaxed);
+    }
+}
+
+ConcurrentUnionFind::Word ConcurrentUnionFind::pack(std::size_t parent, std::size_t cons) {
+    return (Word(parent) << 32) | Word(cons & none);
+}
+
+std::size_t ConcurrentUnionFind::parentOf(Word w) {
+    return w >> 32;
+}
+
+std::size_t ConcurrentUnionFind::consOf(Word w) {
+    return w & none;
+}
+
+/*! \fn priority
+ *
+ * A bit mixing of the id, so that linking behaves like linking by random
+ * priorities, which keeps the trees shallow in expectation.
+ */
+std::uint32_t ConcurrentUnionFind::priority(std::size_t id) {
+    std::uint64_t x = id + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return std::uint32_t(x ^ (x >> 31));
+}
+
+void ConcurrentUnionFind::setCons(std::size_t id, std::size_t cons) {
+    words[id].store(pack(id, cons), std::memory_order_relaxed);
+}
+
+/*! \fn find
+ *
+ * Path splitting points each node on the path at its grandparent.  A failed
+ * compare-and-swap means another thread already shortened the path.
+ */
+std::size_t ConcurrentUnionFind::find(std::size_t id) {
+    while (true) {
+        Word w = words[id].load(std::memory_order_acquire);
+        auto parent = parentOf(w);
+        if (parent == id) {
+            return id;
+        }
+        Word pw = words[parent].load(std::memory_order_acquire);
+        auto grandparent = parentOf(pw);
+        if (grandparent != parent) {
+            words[id].compare_exchange_weak(w, pack(grandparent, consOf(w)),
+                                            std::memory_order_release, std::memory_order_relaxed);
+        }
+        id = parent;
+    }
+}
+
+std::size_t ConcurrentUnionFind::cons(std::size_t root) const {
+    return consOf(words[root].load(std::memory_order_acquire));
+}
+
+bool ConcurrentUnionFind::link(std::size_t r1, std::size_t r2, std::size_t &detached) {
+    auto p1 = priority(r1), p2 = priority(r2);
+    auto child = (p1 < p2 || (p1 == p2 && r1 < r2)) ? r1 : r2;
+    auto parent = child == r1 ? r2 : r1;
+
+    Word w = words[child].load(std::memory_order_acquire);
+    if (parentOf(w) != child || parentOf(words[parent].load(std::memory_order_acquire)) != parent) {
+        return false;
+    }
+    if (!words[child].compare_exchange_strong(w, pack(parent, none),
+                                              std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return false;
+    }
+    detached = consOf(w);
+    return true;
+}
+
+std::size_t ConcurrentUnionFind::attachCons(std::size_t id, std::size_t cons) {
+    while (true) {
+        auto root = find(id);
+        Word w = words[root].load(std::memory_order_acquire);
+        if (parentOf(w) != root) {
+            continue;
+        }
+
+        auto existing = consOf(w);
+        if (existing == cons) {
+            return none;
+        }
+        if (existing != none && existing < cons) {
+            return existing;
+        }
+        if (words[root].compare_exchange_weak(w, pack(root, cons),
+                                              std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return existing;
+        }
+    }
+}
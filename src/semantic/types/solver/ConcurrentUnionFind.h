@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*!
+ * \class ConcurrentUnionFind
+ *
+ * \brief A union-find structure over dense integer ids that may be updated
+ * from several threads at once without locks.
+ *
+ * Each class may carry one distinguished member, the constructor term that
+ * unification uses as the proper type of the class.  The parent of an id
+ * and the constructor of its class are packed into a single atomic word, so
+ * that linking a root and updating the constructor of a root are both
+ * single compare-and-swap operations that fail if the other happened first.
+ *
+ * Roots are linked in a fixed priority order, which rules out cycles between
+ * concurrent links and makes the root of every class its highest priority
+ * member, independent of the order of the links.  Finds use path splitting,
+ * each step of which is a compare-and-swap that is simply skipped if it
+ * loses a race.
+ */
+class ConcurrentUnionFind {
+public:
+    static constexpr std::size_t none = 0xffffffff;
+
+    /*! \brief Create singleton classes for the ids 0 to size - 1, none of which carry a constructor. */
+    explicit ConcurrentUnionFind(std::size_t size);
+
+    /*! \brief Record that the class of a fresh id carries a constructor.
+     * \pre No other thread is using the structure.
+     */
+    void setCons(std::size_t id, std::size_t cons);
+
+    //! \brief Return the root of the class of id.
+    std::size_t find(std::size_t id);
+
+    //! \brief Return the constructor of the class rooted at root, or none.
+    std::size_t cons(std::size_t root) const;
+
+    /*! \brief Link the classes rooted at r1 and r2.
+     *
+     * \return false if either is no longer a root, in which case nothing is
+     * changed and the caller should find the roots again.  On success, the
+     * constructor of the class that was linked below the other is stored in
+     * detached and must be reattached with attachCons, or none.
+     */
+    bool link(std::size_t r1, std::size_t r2, std::size_t &detached);
+
+    /*! \brief Make cons the constructor of the class of id if it does not have one.
+     *
+     * If the class already has a constructor, the one with the lower id is kept
+     * so the outcome does not depend on the order of the calls.
+     * \return The constructor cons must be unified with, or none.
+     */
+    std::size_t attachCons(std::size_t id, std::size_t cons);
+
+private:
+    using Word = std::uint64_t;
+
+    static Word pack(std::size_t parent, std::size_t cons);
+    static std::size_t parentOf(Word w);
+    static std::size_t consOf(Word w);
+    static std::uint32_t priority(std::size_t id);
+
+    std::size_t count;
+    std::unique_ptr<std::atomic<Word>[]> words;
+};
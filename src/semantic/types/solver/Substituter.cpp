@@ -1,4 +1,5 @@
 #include "Substituter.h"
+#include "TipTypeFactory.h"
 
 #include <iterator>
 #include <algorithm>
@@ -27,12 +28,12 @@ void Substituter::endVisit(TipFunction * element) {
 
   std::shared_ptr<TipType> retType = argTypes.back();
   argTypes.pop_back();
-  visitedTypes.push_back(std::make_shared<TipFunction>(argTypes, retType));
+  visitedTypes.push_back(TipTypeFactory::function(argTypes, retType));
 }
 
 void Substituter::endVisit(TipInt * element) {
   // Zero element in visitedTypes (a special case of Cons)
-  visitedTypes.push_back(std::make_shared<TipInt>());
+  visitedTypes.push_back(TipTypeFactory::intType());
 }
 
 void Substituter::endVisit(TipMu * element) {
@@ -44,7 +45,7 @@ void Substituter::endVisit(TipMu * element) {
   auto vType = std::dynamic_pointer_cast<TipVar>(visitedTypes.back());
   visitedTypes.pop_back();
 
-  visitedTypes.push_back(std::make_shared<TipMu>(vType, tType));
+  visitedTypes.push_back(TipTypeFactory::mu(vType, tType));
 }
 
 void Substituter::endVisit(TipRecord * element) {
@@ -58,19 +59,19 @@ void Substituter::endVisit(TipRecord * element) {
   // so we set them right here
   std::reverse(initTypes.begin(), initTypes.end());
 
-  visitedTypes.push_back(std::make_shared<TipRecord>(initTypes, element->getNames()));
+  visitedTypes.push_back(TipTypeFactory::record(initTypes, element->getNames()));
 }
 
 void Substituter::endVisit(TipAbsentField * element) {
   // Zero element in visitedTypes (a special case of Cons)
-  visitedTypes.push_back(std::make_shared<TipAbsentField>());
+  visitedTypes.push_back(TipTypeFactory::absentField());
 }
 
 void Substituter::endVisit(TipRef * element) {
   // One element in visitedTypes (a special case of Cons)
   auto pointedToType = visitedTypes.back();
   visitedTypes.pop_back();
-  visitedTypes.push_back(std::make_shared<TipRef>(pointedToType));
+  visitedTypes.push_back(TipTypeFactory::ref(pointedToType));
 }
 
 /*! \brief Substitute if variable is the target.
@@ -80,7 +81,7 @@ void Substituter::endVisit(TipVar * element) {
     auto copy = Copier::copy(substitution);
     visitedTypes.push_back(copy);
   } else {
-    visitedTypes.push_back(std::make_shared<TipVar>(element->getNode()));
+    visitedTypes.push_back(TipTypeFactory::var(element->getNode()));
   }
 }
 
@@ -89,7 +90,7 @@ void Substituter::endVisit(TipAlpha * element) {
     auto copy = Copier::copy(substitution);
     visitedTypes.push_back(copy);
   } else {
-    visitedTypes.push_back(std::make_shared<TipAlpha>(element->getNode(), element->getName()));
+    visitedTypes.push_back(TipTypeFactory::alpha(element->getNode(), element->getName()));
   }
 }
 
@@ -105,11 +106,11 @@ std::shared_ptr<TipType> Copier::copy(std::shared_ptr<TipType> t) {
 }
 
 void Copier::endVisit(TipVar * element) {
-  visitedTypes.push_back(std::make_shared<TipVar>(element->getNode()));
+  visitedTypes.push_back(TipTypeFactory::var(element->getNode()));
 }
 
 void Copier::endVisit(TipAlpha * element) {
-  visitedTypes.push_back(std::make_shared<TipAlpha>(element->getNode(), element->getName()));
+  visitedTypes.push_back(TipTypeFactory::alpha(element->getNode(), element->getName()));
 }
 
 
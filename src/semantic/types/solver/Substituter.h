@@ -21,7 +21,9 @@ public:
    * be directly substituted for the variable without having to be reconstructed.
    * This simplifies things when the substitution is a complex type expression.
    * It does lead to a bit of asymmetry in the API and it will lead to sharing
-   * among type expressions, which is why we use shared_ptrs.
+   * among type expressions, which is why we use shared_ptrs.  Types are
+   * rebuilt through the TipTypeFactory, so subtrees that do not contain the
+   * target variable are shared with the original type.
    *
    * \param t The type on which substitution is performed.
    * \param v The target variable. 
@@ -46,6 +48,8 @@ public:
  *
  * This subtype of the Substituter overrides the behavior for TipVar
  * and TipAlpha to just copy that node rather than perform a substitution.
+ * Since types are built with the TipTypeFactory the copy is the interned
+ * term equivalent to the original, which is shared rather than reallocated.
  */
 class Copier: public Substituter {
 public:
@@ -0,0 +1,74 @@
+#include "TypeHasher.h"
+
+#include <functional>
+#include <string>
+
+namespace { // Anonymous namespace for local helpers
+
+// Distinct seeds for each kind of type term
+enum Tag : std::size_t { ALPHA = 1, FUNCTION, INT, MU, RECORD, ABSENT, REF, VAR };
+
+std::size_t combine(std::size_t seed, std::size_t value) {
+  return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+}
+
+std::size_t TypeHasher::hash(TipType* t) {
+  TypeHasher visitor;
+  t->accept(&visitor);
+  return visitor.getResult();
+}
+
+std::size_t TypeHasher::getResult() {
+  return visitedHashes.back();
+}
+
+/*! \brief Replace the hashes of the arguments on top of the stack by their combination.
+ *
+ * The post-order visit leaves the argument hashes on the stack in order, so
+ * they are combined from the deepest entry up to preserve argument order.
+ */
+void TypeHasher::combineArguments(std::size_t tag, std::size_t arity) {
+  std::size_t h = combine(tag, arity);
+  auto first = visitedHashes.end() - arity;
+  for (auto it = first; it != visitedHashes.end(); ++it) {
+    h = combine(h, *it);
+  }
+  visitedHashes.erase(first, visitedHashes.end());
+  visitedHashes.push_back(h);
+}
+
+void TypeHasher::endVisit(TipFunction * element) {
+  combineArguments(FUNCTION, element->getArguments().size());
+}
+
+void TypeHasher::endVisit(TipInt * element) {
+  visitedHashes.push_back(combine(INT, 0));
+}
+
+void TypeHasher::endVisit(TipMu * element) {
+  combineArguments(MU, 2);
+}
+
+// Field names do not participate in record equality so they are not hashed
+void TypeHasher::endVisit(TipRecord * element) {
+  combineArguments(RECORD, element->getArguments().size());
+}
+
+void TypeHasher::endVisit(TipAbsentField * element) {
+  visitedHashes.push_back(combine(ABSENT, 0));
+}
+
+void TypeHasher::endVisit(TipRef * element) {
+  combineArguments(REF, 1);
+}
+
+void TypeHasher::endVisit(TipVar * element) {
+  visitedHashes.push_back(combine(VAR, std::hash<ASTNode *>{}(element->getNode())));
+}
+
+void TypeHasher::endVisit(TipAlpha * element) {
+  auto h = combine(ALPHA, std::hash<ASTNode *>{}(element->getNode()));
+  visitedHashes.push_back(combine(h, std::hash<std::string>{}(element->getName())));
+}
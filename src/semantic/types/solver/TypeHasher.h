@@ -0,0 +1,40 @@
+#pragma once
+
+#include "TipTypeVisitor.h"
+#include <cstddef>
+#include <vector>
+
+/*! \brief Computes a structural hash of a type expression.
+ *
+ * The hash is consistent with the structural equality defined by the
+ * TipType operator==, i.e., types that compare equal hash to the same
+ * value.  In particular, type variables hash by the AST node they are
+ * associated with and record hashes ignore the field names.
+ */
+class TypeHasher: public TipTypeVisitor {
+  std::vector<std::size_t> visitedHashes;
+
+public:
+  TypeHasher() = default;
+
+  /*! \brief Compute the structural hash of a type expression.
+   *
+   * \param t The type to hash.
+   * \return The hash value.
+   */
+  static std::size_t hash(TipType* t);
+
+  std::size_t getResult();
+
+  virtual void endVisit(TipAlpha * element) override;
+  virtual void endVisit(TipFunction * element) override;
+  virtual void endVisit(TipInt * element) override;
+  virtual void endVisit(TipMu * element) override;
+  virtual void endVisit(TipRecord * element) override;
+  virtual void endVisit(TipAbsentField * element) override;
+  virtual void endVisit(TipRef * element) override;
+  virtual void endVisit(TipVar * element) override;
+
+private:
+  void combineArguments(std::size_t tag, std::size_t arity);
+};
@@ -1,4 +1,5 @@
 #include "TypeVars.h"
+#include "TipTypeFactory.h"
 
 std::set<std::shared_ptr<TipVar>> TypeVars::collect(TipType* t) {
   TypeVars visitor;
@@ -11,9 +12,9 @@ void TypeVars::endVisit(TipMu * element) {
 }
 
 void TypeVars::endVisit(TipVar * element) {
-  vars.insert(std::make_shared<TipVar>(element->getNode()));
+  vars.insert(TipTypeFactory::var(element->getNode()));
 }
 
 void TypeVars::endVisit(TipAlpha * element) {
-  vars.insert(std::make_shared<TipAlpha>(element->getNode(), element->getName()));
+  vars.insert(TipTypeFactory::alpha(element->getNode(), element->getName()));
 }
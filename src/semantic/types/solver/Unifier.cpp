@@ -1,15 +1,21 @@
 #include "Unifier.h"
+#include "ConcurrentUnionFind.h"
 #include "Substituter.h"
 #include "TipAlpha.h"
 #include "TipCons.h"
 #include "TipMu.h"
+#include "TipTypeFactory.h"
 #include "TypeVars.h"
 #include "UnificationError.h"
 
 #include "loguru.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <utility>
 
 /*
@@ -24,6 +30,23 @@
 
 namespace { // Anonymous namespace for local helper functions
 
+bool disjoint(std::set<std::shared_ptr<TipVar>> const &s1, std::set<std::shared_ptr<TipVar>> const &s2) {
+  for (auto &e : s2) {
+    if (s1.count(e)) return false;
+  }
+  return true;
+}
+
+/*! \brief The interned variable structurally equal to v.
+ * Sets of canonical variables can be compared by identity.
+ */
+std::shared_ptr<TipVar> canonical(std::shared_ptr<TipVar> v) {
+  if (auto a = std::dynamic_pointer_cast<TipAlpha>(v)) {
+    return TipTypeFactory::alpha(a->getNode(), a->getName());
+  }
+  return TipTypeFactory::var(v->getNode());
+}
+
 bool contains(std::set<std::shared_ptr<TipVar>> s, std::shared_ptr<TipVar> t) {
   for (auto e : s) {
     if (*e.get() == *t.get()) return true;
@@ -46,8 +69,13 @@ std::string print(std::set<std::shared_ptr<TipVar>> varSet) {
 Unifier::Unifier() : unionFind(std::move(std::make_unique<UnionFind>())) {}
 
 Unifier::Unifier(std::vector<TypeConstraint> constrs) : constraints(std::move(constrs)) {
+    unionFind = std::make_unique<UnionFind>(seedTerms());
+}
+
+// The terms of the constraints and their immediate arguments
+std::vector<std::shared_ptr<TipType>> Unifier::seedTerms() const {
     std::vector<std::shared_ptr<TipType>> types;
-    for(TypeConstraint& constraint : constraints) {
+    for(const TypeConstraint& constraint : constraints) {
         auto lhs = constraint.lhs;
         auto rhs = constraint.rhs;
         types.push_back(lhs);
@@ -64,16 +92,160 @@ Unifier::Unifier(std::vector<TypeConstraint> constrs) : constraints(std::move(co
             }
         }
     }
-
-    unionFind = std::make_unique<UnionFind>(types);
+    return types;
 }
 
-void Unifier::solve() {
+void Unifier::solve(unsigned threads) {
+    if(threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if(threads > 1 && constraints.size() > 1) {
+        if(solveConcurrently(threads)) {
+            return;
+        }
+
+        // Replay the constraints serially to report the error the serial solver would
+        LOG_S(1) << "Constraints are not unifiable, solving serially to report the error";
+        unionFind = std::make_unique<UnionFind>(seedTerms());
+        closed.clear();
+    }
+
     for(TypeConstraint &constraint: constraints) {
         unify(constraint.lhs, constraint.rhs);
     }
 }
 
+/*! \fn solveConcurrently
+ *  \brief Solve the constraints on several threads, returning false if they cannot be unified.
+ *
+ * All of the terms and their subterms are first given dense ids by the
+ * union-find structure.  Worker threads then claim chunks of constraints and
+ * unify their ids.  Linking two classes that both carry a constructor leaves
+ * the arguments of the constructors to be unified; these pairs are pushed on
+ * the worker's own stack and processed before it claims more constraints.
+ * Once all workers are done, the classes are copied into the union-find
+ * structure with the constructor of each class as its representative.
+ */
+bool Unifier::solveConcurrently(unsigned threads) {
+    // Intern every subterm, recording the argument ids of the constructors
+    std::vector<std::vector<std::size_t>> argIds;
+    std::vector<TipCons const *> consTerms;
+    std::vector<bool> expanded;
+    std::function<std::size_t(std::shared_ptr<TipType> const &)> intern = [&](std::shared_ptr<TipType> const &t) {
+        auto id = unionFind->insert(t);
+        if(id >= expanded.size()) {
+            expanded.resize(id + 1, false);
+            argIds.resize(id + 1);
+            consTerms.resize(id + 1, nullptr);
+        }
+        if(!expanded[id]) {
+            expanded[id] = true;
+            if(auto c = std::dynamic_pointer_cast<TipCons>(t)) {
+                std::vector<std::size_t> ids;
+                for(auto &a : c->getArguments()) {
+                    ids.push_back(intern(a));
+                }
+                argIds[id] = std::move(ids);
+                consTerms[id] = c.get();
+            }
+        }
+        return id;
+    };
+
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    pairs.reserve(constraints.size());
+    for(auto &constraint : constraints) {
+        auto l = intern(constraint.lhs);
+        auto r = intern(constraint.rhs);
+        pairs.emplace_back(l, r);
+    }
+
+    auto size = unionFind->size();
+    argIds.resize(size);
+    consTerms.resize(size, nullptr);
+    ConcurrentUnionFind forest(size);
+    for(std::size_t id = 0; id < size; id++) {
+        if(consTerms[id] != nullptr) {
+            forest.setCons(id, id);
+        }
+    }
+
+    LOG_S(1) << "Solving " << pairs.size() << " type constraints on " << threads << " threads";
+
+    const std::size_t chunk = 256;
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> failed(false);
+
+    auto work = [&]() {
+        std::vector<std::pair<std::size_t, std::size_t>> pending;
+        while(!failed.load(std::memory_order_relaxed)) {
+            auto start = next.fetch_add(chunk);
+            if(start >= pairs.size()) {
+                break;
+            }
+            auto end = std::min(start + chunk, pairs.size());
+            for(auto i = start; i < end; i++) {
+                pending.push_back(pairs[i]);
+                while(!pending.empty() && !failed.load(std::memory_order_relaxed)) {
+                    auto [a, b] = pending.back();
+                    pending.pop_back();
+
+                    auto ra = forest.find(a);
+                    auto rb = forest.find(b);
+                    if(ra == rb) {
+                        continue;
+                    }
+                    std::size_t detached;
+                    if(!forest.link(ra, rb, detached)) {
+                        // Lost a race with another link, try again with the new roots
+                        pending.emplace_back(a, b);
+                        continue;
+                    }
+                    if(detached == ConcurrentUnionFind::none) {
+                        continue;
+                    }
+
+                    auto other = forest.attachCons(ra, detached);
+                    if(other == ConcurrentUnionFind::none) {
+                        continue;
+                    }
+                    if(!consTerms[detached]->doMatch(consTerms[other])) {
+                        failed = true;
+                        break;
+                    }
+                    for(std::size_t arg = 0; arg < argIds[detached].size(); arg++) {
+                        pending.emplace_back(argIds[detached][arg], argIds[other][arg]);
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(unsigned w = 1; w < threads; w++) {
+        pool.emplace_back(work);
+    }
+    work();
+    for(auto &t : pool) {
+        t.join();
+    }
+
+    if(failed) {
+        return false;
+    }
+
+    // A proper type is the representative of its class, as in the serial solver
+    std::vector<std::size_t> representativeOf(size);
+    for(std::size_t id = 0; id < size; id++) {
+        auto root = forest.find(id);
+        auto cons = forest.cons(root);
+        representativeOf[id] = cons != ConcurrentUnionFind::none ? cons : root;
+    }
+    unionFind->assign(representativeOf);
+    closed.clear();
+    return true;
+}
+
 /*! \fn unify
  *  \brief Attempts to unify the two type terms. Throws a UnificationError on failure.
  *
@@ -95,6 +267,9 @@ void Unifier::solve() {
 void Unifier::unify(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2) {
     LOG_S(2) << "Unifying " << *t1 << " and " << *t2;
 
+    // Closed types computed from an earlier solution are stale
+    closed.clear();
+
     auto rep1 = unionFind->find(t1);
     auto rep2 = unionFind->find(t2);
 
@@ -138,51 +313,61 @@ void Unifier::unify(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2) {
  * structure after solving.  It also makes use of two helper classes to
  * perform substitutions of variables and to identify the free variables in
  * the type expression (i.e., the one's not bound in mu quantifiers).
+ *
+ * The closed type of a term only depends on the variables in visited if
+ * closing it reaches one of them; this is how cyclic references are cut
+ * and later bound by a mu.  Closing therefore accumulates the canonical
+ * variables it reaches in reached.  A result computed without reaching any
+ * visited variable is memoized together with its reached set and is reused
+ * by any later closing whose visited set is disjoint from it.
  * \sa Substituter
  * \sa TypeVars
  */
-std::shared_ptr<TipType> Unifier::close(
-        std::shared_ptr<TipType> type, std::set<std::shared_ptr<TipVar>> visited) {
+std::shared_ptr<TipType> Unifier::close(std::shared_ptr<TipType> type,
+                                        std::set<std::shared_ptr<TipVar>> &visited,
+                                        std::set<std::shared_ptr<TipVar>> &reached) {
+  auto memo = closed.find(type);
+  if (memo != closed.end() && disjoint(memo->second.reached, visited)) {
+    reached.insert(memo->second.reached.begin(), memo->second.reached.end());
+    return memo->second.type;
+  }
+
+  std::set<std::shared_ptr<TipVar>> typeReached;
+  std::shared_ptr<TipType> result;
 
   if (isVar(type)) {
-    auto v = std::dynamic_pointer_cast<TipVar>(type);
+    auto v = canonical(std::dynamic_pointer_cast<TipVar>(type));
+    typeReached.insert(v);
 
     LOG_S(2) << "Close starting var " << *v << " with visited " << print(visited);
 
-    if (!contains(visited, v) && (unionFind->find(type) != v)) {
+    if (!visited.count(v) && (*unionFind->find(type) != *v)) {
       // No cyclic reference to v and it does not map to itself
       visited.insert(v);
-
-      auto closedV = close(unionFind->find(type), visited);
+      auto closedV = close(unionFind->find(type), visited, typeReached);
+      visited.erase(v);
 
       // If the variable is an alpha, then reuse it else create a new
       // alpha with the node.
-      auto newV = (isAlpha(v)) ? v : std::make_shared<TipAlpha>(v->getNode());
+      auto newV = (isAlpha(v)) ? v : TipTypeFactory::alpha(v->getNode());
       auto freeV = TypeVars::collect(closedV.get());
       if (contains(freeV,newV)) {
         // Cyclic reference requires a mu type constructor
         auto substClosedV = Substituter::substitute(closedV.get(), v.get(), newV);
-        auto mu = std::make_shared<TipMu>(newV, substClosedV);
-
-        LOG_S(2) << "Close making " << *mu << " to end var " << *v;
-        return mu;
-
+        result = TipTypeFactory::mu(newV, substClosedV);
       } else {
         // No cyclic reference in closed type
-        LOG_S(2) << "Close making " << *closedV << " to end var " << *v;
-        return closedV;
+        result = closedV;
       }
     } else {
       // Unconstrained type variable - should we start with fresh names to make output cleaner?
-      auto alpha = std::make_shared<TipAlpha>(v->getNode());
+      result = TipTypeFactory::alpha(v->getNode());
+    }
 
-      LOG_S(2) << "Close making " << *alpha << " to end var " << *v;
-      return alpha;
-    } 
+    LOG_S(2) << "Close making " << *result << " to end var " << *v;
 
   } else if (isCons(type)) {
     auto c = std::dynamic_pointer_cast<TipCons>(type);
-    auto copy = Copier::copy(c);
 
     LOG_S(2) << "Close starting cons " << *c << " with visited " << print(visited);
 
@@ -192,7 +377,7 @@ std::shared_ptr<TipType> Unifier::close(
     std::vector<std::shared_ptr<TipType>> temp;
     auto current = c->getArguments();
     for (auto v : freeV) {
-      auto closedV = close(v, visited);
+      auto closedV = close(v, visited, typeReached);
       for (auto a : current) {
 
     LOG_S(2) << "Close cons substituting " << *closedV << " for " << *v << " in " << *a;
@@ -204,49 +389,118 @@ std::shared_ptr<TipType> Unifier::close(
       temp.clear();
     }
 
-    // replace arguments with current
-    c->setArguments(current);
-
-    LOG_S(2) << "Close making " << *c << " to end cons " << *copy;
+    // build a cons with the closed arguments; the solution is left intact
+    result = TipTypeFactory::cons(c.get(), current);
 
-    return c;
+    LOG_S(2) << "Close making " << *result << " to end cons " << *c;
 
   } else if (isMu(type)) {
     auto m = std::dynamic_pointer_cast<TipMu>(type);
 
     LOG_S(2) << "Close starting mu " << *m << " with visited " << print(visited);
 
-    auto closedMu = std::make_shared<TipMu>(m->getV(), close(m->getT(), visited));
+    result = TipTypeFactory::mu(m->getV(), close(m->getT(), visited, typeReached));
 
-    LOG_S(2) << "Close making " << *closedMu << " to end mu " << *m;
+    LOG_S(2) << "Close making " << *result << " to end mu " << *m;
 
-    return closedMu;
-  } 
+  } else {
+    /* This should be unreachable since all subtypes of TipType are
+     * subtypes of TipVar, TipCons, or TipMu -- the three cases above.
+     * We could have left the final "else if" implicit above, but add the
+     * assertion here to catch any problematic type extensions.  Note
+     * that this necessitates the return statement.
+     */
+    assert(false);  // LCOV_EXCL_LINE
+    return type;  // LCOV_EXCL_LINE
+  }
 
-  /* This should be unreachable since all subtypes of TipType are
-   * subtypes of TipVar, TipCons, or TipMu -- the three cases above.
-   * We could have left the final "else if" implicit above, but add the
-   * assertion here to catch any problematic type extensions.  Note
-   * that this necessitates the return statement.
-   */
-  assert(false);  // LCOV_EXCL_LINE
-  return type;  // LCOV_EXCL_LINE
+  if (disjoint(typeReached, visited)) {
+    closed[type] = Closure{result, typeReached};
+  }
+  reached.insert(typeReached.begin(), typeReached.end());
+  return result;
 }
 
 /*! \brief Looks up the inferred type in the type solution.
  *
  * Here we want to produce an inferred type that is "closed" in the
  * sense that all variables in the type definition are replaced with
- * their base types.  Because the close() function may destructively update
- * the unionFind structure, by generating new types, we save a copy
- * and restore it after closing.
+ * their base types.  Closing never modifies the solution, so the
+ * closed types are memoized and repeated queries are lookups.
  */ 
 std::shared_ptr<TipType> Unifier::inferred(std::shared_ptr<TipType> v) {
-  auto unionFindCopy = unionFind->copy();
   std::set<std::shared_ptr<TipVar>> visited;
-  auto closedV = close(v, visited);
-  unionFind = std::move(unionFindCopy);
-  return closedV;
+  std::set<std::shared_ptr<TipVar>> reached;
+  return close(v, visited, reached);
+}
+
+/*! \brief Close all of the given types in a single pass.
+ *
+ * Subterms shared among the types are closed once and reused.
+ */
+std::vector<std::shared_ptr<TipType>> Unifier::inferredAll(std::vector<std::shared_ptr<TipType>> const &types) {
+  std::vector<std::shared_ptr<TipType>> closedTypes;
+  closedTypes.reserve(types.size());
+  for (auto &t : types) {
+    closedTypes.push_back(inferred(t));
+  }
+  return closedTypes;
+}
+
+/*
+ * Each class that has a proper type is named by the first of its variables
+ * in the union-find structure, and every variable reached is equated with
+ * the name of its class.  The proper types keep their own arguments, so
+ * the solution of the equations has the same representatives as this one.
+ */
+std::vector<TypeConstraint> Unifier::reduced(std::vector<std::shared_ptr<TipType>> const &types) {
+  std::map<TipType*, std::shared_ptr<TipType>> names;
+  for (std::size_t id = 0; id < unionFind->size(); id++) {
+    auto t = unionFind->term(id);
+    if (isVar(t)) {
+      names.emplace(unionFind->find(t).get(), t);
+    }
+  }
+
+  std::vector<TypeConstraint> equations;
+  std::set<TipType*> reached, named;
+  for (auto &t : types) {
+    reduce(t, names, reached, named, equations);
+  }
+  return equations;
+}
+
+/*
+ * Adds the equations for a term reached from the given terms, unless it
+ * was reached before, and then for the terms those equations mention.
+ */
+void Unifier::reduce(std::shared_ptr<TipType> const &t, std::map<TipType*, std::shared_ptr<TipType>> const &names,
+                     std::set<TipType*> &reached, std::set<TipType*> &named,
+                     std::vector<TypeConstraint> &equations) {
+  if (!reached.insert(t.get()).second) {
+    return;
+  }
+
+  if (isCons(t)) {
+    for (auto &a : std::dynamic_pointer_cast<TipCons>(t)->getArguments()) {
+      reduce(a, names, reached, named, equations);
+    }
+    return;
+  }
+
+  auto rep = unionFind->find(t);
+  if (isCons(rep)) {
+    auto name = names.at(rep.get());
+    if (named.insert(rep.get()).second) {
+      equations.emplace_back(name, rep);
+      reduce(rep, names, reached, named, equations);
+    }
+    rep = name;
+  }
+  if (*rep != *t) {
+    equations.emplace_back(t, rep);
+    reduce(rep, names, reached, named, equations);
+  }
 }
 
 void Unifier::throwUnifyException(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2) {
@@ -4,6 +4,7 @@
 #include "TipVar.h"
 #include "TypeConstraint.h"
 #include "UnionFind.h"
+#include <map>
 #include <set>
 #include <vector>
 
@@ -39,8 +40,17 @@ public:
 
     /*! \brief Solve the system of constraints that have presented to this unifier.
      *  \pre The unifier has been constructed with seed values. That is, we are not unifying on-the-fly.
+     *
+     * With more than one thread the constraints are partitioned among worker
+     * threads that unify them against a shared ConcurrentUnionFind.  If the
+     * constraints cannot be unified they are solved again serially, so the
+     * UnificationError raised is the one the serial solver would raise.  The
+     * solution is the same as the serial one up to the choice of class
+     * representatives among type variables.
+     * \param threads The number of threads to use, 0 for one per hardware thread
+     * \sa ConcurrentUnionFind
      */
-    void solve();
+    void solve(unsigned threads = 1);
 
     /*! \brief Returns the inferred type for a given type.
      * \pre The unifier has computed a solution.
@@ -49,16 +59,53 @@ public:
      * proper type. 
      */
     std::shared_ptr<TipType> inferred(std::shared_ptr<TipType> t);
+
+    /*! \brief Returns the inferred types for a collection of types.
+     * \pre The unifier has computed a solution.
+     * Equivalent to calling inferred on each type, in order.
+     */
+    std::vector<std::shared_ptr<TipType>> inferredAll(std::vector<std::shared_ptr<TipType>> const &types);
+    /*! \brief Returns equations over the given terms that have the same solutions as the constraints.
+     * \pre The unifier has computed a solution.
+     *
+     * The equations relate each given term to its solution, in which the
+     * classes reached are named by one of their variables, and each named
+     * class with a proper type to that type.  Variables that do not occur in
+     * the equations are thereby eliminated, which makes the equations a
+     * summary of the constraints as far as the given terms are concerned.
+     */
+    std::vector<TypeConstraint> reduced(std::vector<std::shared_ptr<TipType>> const &types);
+
+    //! \brief Returns the number of constraints the unifier was seeded with.
+    std::size_t getNumConstraints() const { return constraints.size(); }
+
+    //! \brief Returns the number of terms in the union-find structure.
+    std::size_t getNumTerms() const { return unionFind->size(); }
 private:
     static bool isCons(std::shared_ptr<TipType> type);
     static bool isMu(std::shared_ptr<TipType> type);
     static bool isVar(std::shared_ptr<TipType> type);
     static bool isAlpha(std::shared_ptr<TipType> type);
     static bool isProperType(std::shared_ptr<TipType> type);
-    std::shared_ptr<TipType> close(std::shared_ptr<TipType> type, std::set<std::shared_ptr<TipVar>> visited);
+    std::shared_ptr<TipType> close(std::shared_ptr<TipType> type,
+                                   std::set<std::shared_ptr<TipVar>> &visited,
+                                   std::set<std::shared_ptr<TipVar>> &reached);
+    void reduce(std::shared_ptr<TipType> const &t, std::map<TipType*, std::shared_ptr<TipType>> const &names,
+                std::set<TipType*> &reached, std::set<TipType*> &named, std::vector<TypeConstraint> &equations);
     void throwUnifyException(std::shared_ptr<TipType> TipType1, std::shared_ptr<TipType> TipType2);
+    std::vector<std::shared_ptr<TipType>> seedTerms() const;
+    bool solveConcurrently(unsigned threads);
 
     std::vector<TypeConstraint> constraints;
     std::unique_ptr<UnionFind> unionFind;
+
+    // A closed type and the canonical variables reached while closing it.
+    struct Closure {
+        std::shared_ptr<TipType> type;
+        std::set<std::shared_ptr<TipVar>> reached;
+    };
+
+    // Memoized closed types, valid until the next unification.
+    std::map<std::shared_ptr<TipType>, Closure> closed;
 };
 
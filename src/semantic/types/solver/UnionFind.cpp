@@ -1,123 +1,143 @@
 #include "UnionFind.h"
 #include "Substituter.h"
+#include "TypeHasher.h"
 
 #include "loguru.hpp"
 #include <iostream>
 
-namespace { // Anonymous namespace for local helpers
-bool verbose = false;
-}
-
 UnionFind::UnionFind(std::vector<std::shared_ptr<TipType>> seed) {
     for(auto &term : seed) {
         smart_insert(term);
     }
 }
 
-/*
-std::ostream& operator<<(std::ostream& os, const UnionFind& obj) {
-  return obj.print(os);
-}
+/*! \brief Returns a deep copy of the union-find structure.
+ *
+ * The forest is copied as is and each term is deep copied.  The index
+ * is rebuilt from the copied terms so that it reflects their structure.
+ */
+std::unique_ptr<UnionFind> UnionFind::copy() {
+  auto ufCopy = std::make_unique<UnionFind>();
 
-std::ostream &UnionFind::print(std::ostream &out) const {
-  out << "UnionFind edges {\n"; 
-  for(auto const &edge : edges) {
-    out << *edge.first << " -> " << *edge.second << std::endl;
+  ufCopy->terms.reserve(terms.size());
+  for(std::size_t id = 0; id < terms.size(); id++) {
+    auto term = Copier::copy(terms[id]);
+    ufCopy->index.emplace(TypeHasher::hash(term.get()), id);
+    ufCopy->terms.push_back(term);
   }
-  out << "}\n"; 
-  return out; 
-}
-*/
-
-std::unique_ptr<UnionFind> UnionFind::copy() {
-  std::vector<std::shared_ptr<TipType>> emptySeed;
-  auto ufCopy = std::make_unique<UnionFind>(emptySeed);
-
-  // Insert the vertices and edges in the copy
-  for(auto const &edge : edges) {
-    auto src = Copier::copy(edge.first);
-    auto dest = Copier::copy(edge.second);
-    ufCopy->edges.insert(std::pair<std::shared_ptr<TipType>, std::shared_ptr<TipType>>(src, dest));
-  } 
-  return std::move(ufCopy);
+  ufCopy->parents = parents;
+  ufCopy->ranks = ranks;
+  ufCopy->representatives = representatives;
+  return ufCopy;
 }
 
-/*
- * Add path compression instead of iterative parent lookup.
- */
 std::shared_ptr<TipType> UnionFind::find(std::shared_ptr<TipType> t) {
     LOG_S(3) << "UnionFind looking for representive of " << *t;
 
-    // Effectively a noop if the term is already in the map.
-    smart_insert(t);
+    // Effectively a noop if the term is already in the structure.
+    auto rep = terms[representatives[root(smart_insert(t))]];
 
-    auto parent = t;
-    while(*get_parent(parent) != *parent) {
-        parent = get_parent(parent);
-    }
+    LOG_S(3) << "UnionFind found representative " << *rep;
 
-    LOG_S(3) << "UnionFind found representative " << *parent;
-
-    return parent;
+    return rep;
 }
 
+/*! \fn quick_union
+ *
+ * Merges the classes of the two terms.  The tree with the lower rank is
+ * attached below the other, but regardless of which root survives the
+ * representative of t2 becomes the representative of the merged class.
+ */
 void UnionFind::quick_union(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2) {
-    smart_insert(t1);
-    smart_insert(t2);
-
-    auto t1_root = find(t1);
-    auto t2_root = find(t2);
-
-    // semantics-based insert
-    for(auto const &edge : edges) {
-        if(*t1_root == *edge.first) {
-            edges.erase(edge.first);
-            edges.insert(std::pair<std::shared_ptr<TipType>, std::shared_ptr<TipType>>(t1_root, t2_root));
-            break;
+    auto t1_root = root(smart_insert(t1));
+    auto t2_root = root(smart_insert(t2));
+    if(t1_root == t2_root) {
+        return;
+    }
+
+    auto rep = representatives[t2_root];
+    if(ranks[t1_root] < ranks[t2_root]) {
+        parents[t1_root] = t2_root;
+    } else if(ranks[t1_root] > ranks[t2_root]) {
+        parents[t2_root] = t1_root;
+        representatives[t1_root] = rep;
+    } else {
+        parents[t1_root] = t2_root;
+        ranks[t2_root]++;
+    }
+}
+
+/*! \fn assign
+ *
+ * Every term is made a child of the representative of its class, which is
+ * the root of the class.
+ */
+void UnionFind::assign(std::vector<std::size_t> const &representativeOf) {
+    for(std::size_t id = 0; id < terms.size(); id++) {
+        auto rep = representativeOf[id];
+        parents[id] = rep;
+        representatives[id] = id;
+        ranks[id] = 0;
+    }
+    for(std::size_t id = 0; id < terms.size(); id++) {
+        if(representativeOf[id] != id) {
+            ranks[representativeOf[id]] = 1;
         }
     }
 }
 
 bool UnionFind::connected(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2) {
-    return *find(t1) == *find(t2);
+    return root(smart_insert(t1)) == root(smart_insert(t2));
 }  // LCOV_EXCL_LINE
 
-/*! \fn get_parent
+/*! \fn root
  *
- * Unification ensures that the forest that includes all relevant type nodes.
- * A tree within the forest is traversed by directed edges to the parent.
- * During closure of terms, new type nodes may be generated by substitution.
- * When they are encountered they are added to the forest.
+ * Walks to the root of the tree containing id and then compresses the
+ * path so that every node visited points directly at the root.
  */
-std::shared_ptr<TipType> UnionFind::get_parent(std::shared_ptr<TipType> t) {
-    for(auto const &edge : edges) {
-        if(*t == *edge.first) {
-            return edge.second;
-        }
+std::size_t UnionFind::root(std::size_t id) {
+    auto r = id;
+    while(parents[r] != r) {
+        r = parents[r];
+    }
+
+    while(parents[id] != r) {
+        auto next = parents[id];
+        parents[id] = r;
+        id = next;
     }
-    
-    smart_insert(t);
-    return t;
+    return r;
 }
 
-/**
- * Inserts should be based on the dereferenced value.
+/*! \fn smart_insert
+ *
+ * Inserts should be based on the dereferenced value.  Returns the id of
+ * the term, allocating a new singleton class if no structurally equal term
+ * is present.  During closure of terms, new type nodes may be generated by
+ * substitution; when they are encountered they are added to the forest.
  */
-void UnionFind::smart_insert(std::shared_ptr<TipType> t) {
+std::size_t UnionFind::smart_insert(std::shared_ptr<TipType> t) {
     if(t == nullptr) {
         throw std::invalid_argument("Refusing to insert a nullptr into the map.");
     }
-    
+
     LOG_S(3) << "UnionFind inserting term " << *t;
 
-    for(auto const &edge : edges) {
-        if(*t == *edge.first) {
-            LOG_S(3) << " ; already in the graph as " << *edge.first;
-            return;
+    auto h = TypeHasher::hash(t.get());
+    auto range = index.equal_range(h);
+    for(auto it = range.first; it != range.second; ++it) {
+        if(*t == *terms[it->second]) {
+            LOG_S(3) << " ; already in the graph as " << *terms[it->second];
+            return it->second;
         }
     }
 
-    LOG_S(3) << " ; adding new edge\n";
-    edges.insert(std::pair<std::shared_ptr<TipType>, std::shared_ptr<TipType>>(t, t));
+    LOG_S(3) << " ; adding new term\n";
+    auto id = terms.size();
+    terms.push_back(t);
+    parents.push_back(id);
+    ranks.push_back(0);
+    representatives.push_back(id);
+    index.emplace(h, id);
+    return id;
 }
-
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <map>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <TipType.h>
 
@@ -9,6 +11,14 @@
  *
  * \brief Specialized implementation of a union-find data structure tailored to work with
  * TipTypes wrapped in shared pointers.
+ *
+ * Terms are interned into dense integer ids using a structural hash that is
+ * consistent with TipType equality, so structurally equal terms share a
+ * single node in the forest.  The forest is kept in parent and rank vectors
+ * and uses path compression and union by rank.  Because union by rank may
+ * choose either root as the new tree root, the representative term of each
+ * class is tracked separately; quick_union(t1, t2) always makes the
+ * representative of t2 the representative of the merged class.
  */
 class UnionFind {
 public:
@@ -24,12 +34,37 @@ public:
      */
     std::unique_ptr<UnionFind> copy();
 
+    //! \brief The number of distinct terms in the structure.
+    std::size_t size() const { return terms.size(); }
+
+    /*! \brief Returns the dense id of a term, adding it as a singleton class if necessary.
+     *
+     * Ids are assigned in order of insertion.
+     */
+    std::size_t insert(std::shared_ptr<TipType> t) { return smart_insert(t); }
+
+    //! \brief Returns the term with the given id.
+    std::shared_ptr<TipType> term(std::size_t id) const { return terms[id]; }
+
+    /*! \brief Replace the classes with those given by a solution computed elsewhere.
+     * \param representativeOf For each id, the id of the representative term of its class.
+     */
+    void assign(std::vector<std::size_t> const &representativeOf);
+
 private:
-    // A mapping from terms to parents.
-    std::map<std::shared_ptr<TipType>, std::shared_ptr<TipType>> edges;
+    // Dense id to term mapping.
+    std::vector<std::shared_ptr<TipType>> terms;
 
-    std::shared_ptr<TipType> get_parent(std::shared_ptr<TipType> t);
-    void smart_insert(std::shared_ptr<TipType> t);
-    std::ostream& print(std::ostream &out) const;
-};
+    // Forest over ids, indexed by id.
+    std::vector<std::size_t> parents;
+    std::vector<std::size_t> ranks;
+
+    // For each root id, the id of the representative term of its class.
+    std::vector<std::size_t> representatives;
 
+    // Structural hash to ids of the terms with that hash.
+    std::unordered_multimap<std::size_t, std::size_t> index;
+
+    std::size_t smart_insert(std::shared_ptr<TipType> t);
+    std::size_t root(std::size_t id);
+};
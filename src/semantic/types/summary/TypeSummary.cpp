@@ -0,0 +1,415 @@
+#include "TypeSummary.h"
+#include "ASTVisitor.h"
+#include "InternalError.h"
+#include "TipAbsentField.h"
+#include "TipAlpha.h"
+#include "TipFunction.h"
+#include "TipInt.h"
+#include "TipRecord.h"
+#include "TipRef.h"
+#include "TipTypeFactory.h"
+#include "TypeConstraintCollectVisitor.h"
+#include "UnificationError.h"
+#include "Unifier.h"
+#include "picosha2.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+namespace {
+
+/*
+ * Collects the field accesses of a function, whose types the absent field
+ * check queries, and the functions it refers to by name.
+ */
+class References : public ASTVisitor {
+public:
+  explicit References(SymbolTable *symbols) : symbols(symbols) {}
+
+  void endVisit(ASTAccessExpr *element) override {
+    accesses.push_back(element);
+  }
+
+  void endVisit(ASTVariableExpr *element) override {
+    auto decl = element->getDecl();
+    if (symbols->getFunction(decl->getName()) == decl) {
+      functions.push_back(decl);
+    }
+  }
+
+  SymbolTable *symbols;
+  std::vector<ASTAccessExpr*> accesses;
+  std::vector<ASTDeclNode*> functions;
+};
+
+void preorder(ASTNode *node, std::vector<ASTNode*> &nodes) {
+  nodes.push_back(node);
+  for (auto child : node->children()) {
+    preorder(child, nodes);
+  }
+}
+
+/*
+ * The nodes of a group in pre-order, the nodes whose types the summary
+ * retains, and the functions outside the group that it refers to, in
+ * order of first reference.
+ */
+struct Group {
+  std::vector<ASTNode*> nodes;
+  std::vector<ASTNode*> retained;
+  std::vector<ASTDeclNode*> externals;
+
+  Group(std::vector<ASTFunction*> const &functions, SymbolTable *symbols) {
+    std::vector<ASTDeclNode*> referenced;
+    for (auto f : functions) {
+      preorder(f, nodes);
+
+      retained.push_back(f->getDecl());
+      for (auto l : symbols->getLocals(f->getDecl())) {
+        retained.push_back(l);
+      }
+      References references(symbols);
+      f->accept(&references);
+      retained.insert(retained.end(), references.accesses.begin(), references.accesses.end());
+      referenced.insert(referenced.end(), references.functions.begin(), references.functions.end());
+    }
+
+    for (auto decl : referenced) {
+      auto inGroup = std::find_if(functions.begin(), functions.end(),
+                                  [decl](ASTFunction *f) { return f->getDecl() == decl; });
+      if (inGroup == functions.end() &&
+          std::find(externals.begin(), externals.end(), decl) == externals.end()) {
+        externals.push_back(decl);
+      }
+    }
+  }
+};
+
+} // namespace
+
+std::shared_ptr<TypeSummary> TypeSummary::summarize(std::vector<ASTFunction*> const &functions,
+                                                    SymbolTable *symbols) {
+  std::vector<TypeConstraint> constraints;
+  for (auto f : functions) {
+    TypeConstraintCollectVisitor visitor(symbols);
+    f->accept(&visitor);
+    auto &collected = visitor.getCollectedConstraints();
+    std::move(collected.begin(), collected.end(), std::back_inserter(constraints));
+  }
+
+  Unifier unifier(std::move(constraints));
+  try {
+    unifier.solve();
+  } catch (UnificationError &e) {
+    return nullptr;
+  }
+
+  Group group(functions, symbols);
+  std::vector<std::shared_ptr<TipType>> retained;
+  for (auto n : group.retained) {
+    retained.push_back(TipTypeFactory::var(n));
+  }
+  for (auto e : group.externals) {
+    retained.push_back(TipTypeFactory::var(e));
+  }
+  auto equations = unifier.reduced(retained);
+
+  auto summary = std::make_shared<TypeSummary>();
+  summary->numNodes = group.nodes.size();
+  for (auto e : group.externals) {
+    summary->externals.push_back(e->getName());
+  }
+
+  std::map<ASTNode*, int> position;
+  for (std::size_t i = 0; i < group.nodes.size(); i++) {
+    position[group.nodes[i]] = i;
+  }
+  for (std::size_t i = 0; i < group.externals.size(); i++) {
+    position[group.externals[i]] = -1 - static_cast<int>(i);
+  }
+
+  std::map<TipType*, int> translated;
+  for (auto &e : equations) {
+    auto lhs = summary->translate(e.lhs, position, translated);
+    summary->equations.emplace_back(lhs, summary->translate(e.rhs, position, translated));
+  }
+  return summary;
+}
+
+/*
+ * Interned types are shared, so each is translated once, after its
+ * arguments, and its term is numbered by the order of translation.
+ */
+int TypeSummary::translate(std::shared_ptr<TipType> const &type, std::map<ASTNode*, int> const &position,
+                           std::map<TipType*, int> &translated) {
+  auto memo = translated.find(type.get());
+  if (memo != translated.end()) {
+    return memo->second;
+  }
+
+  Term term{Term::Int};
+  if (auto v = std::dynamic_pointer_cast<TipVar>(type)) {
+    auto found = position.find(v->getNode());
+    if (found == position.end()) {
+      throw InternalError("type variable outside of the summarized functions"); // LCOV_EXCL_LINE
+    }
+    term.node = found->second;
+    if (auto a = std::dynamic_pointer_cast<TipAlpha>(type)) {
+      term.kind = Term::Alpha;
+      term.names.push_back(a->getName());
+    } else {
+      term.kind = Term::Var;
+    }
+  } else if (std::dynamic_pointer_cast<TipAbsentField>(type)) {
+    term.kind = Term::Absent;
+  } else if (auto c = std::dynamic_pointer_cast<TipCons>(type)) {
+    if (std::dynamic_pointer_cast<TipRef>(type)) {
+      term.kind = Term::Ref;
+    } else if (std::dynamic_pointer_cast<TipFunction>(type)) {
+      term.kind = Term::Function;
+    } else if (auto r = std::dynamic_pointer_cast<TipRecord>(type)) {
+      term.kind = Term::Record;
+      term.names = r->getNames();
+    }
+    for (auto &a : c->getArguments()) {
+      term.args.push_back(translate(a, position, translated));
+    }
+  }
+
+  terms.push_back(std::move(term));
+  return translated[type.get()] = terms.size() - 1;
+}
+
+std::string TypeSummary::key(std::vector<ASTFunction*> const &functions, SymbolTable *symbols) {
+  std::stringstream text;
+  for (auto f : functions) {
+    text << *f << "\n";
+    for (auto d : f->getDeclarations()) {
+      text << *d << "\n";
+    }
+    for (auto s : f->getStmts()) {
+      text << *s << "\n";
+    }
+  }
+  text << "fields";
+  for (auto &field : symbols->getFields()) {
+    text << " " << field;
+  }
+
+  auto tohash = text.str();
+  std::vector<unsigned char> hash(picosha2::k_digest_size);
+  picosha2::hash256(tohash.begin(), tohash.end(), hash.begin(), hash.end());
+  return picosha2::bytes_to_hex_string(hash.begin(), hash.end());
+}
+
+std::string TypeSummary::key(std::vector<std::string> const &keys) {
+  std::string tohash;
+  for (auto &k : keys) {
+    tohash += k + "\n";
+  }
+  std::vector<unsigned char> hash(picosha2::k_digest_size);
+  picosha2::hash256(tohash.begin(), tohash.end(), hash.begin(), hash.end());
+  return picosha2::bytes_to_hex_string(hash.begin(), hash.end());
+}
+
+bool TypeSummary::instantiate(std::vector<ASTFunction*> const &functions, SymbolTable *symbols,
+                              std::vector<TypeConstraint> &constraints) const {
+  Group group(functions, symbols);
+  if (static_cast<int>(group.nodes.size()) != numNodes || group.externals.size() != externals.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < externals.size(); i++) {
+    if (group.externals[i]->getName() != externals[i]) {
+      return false;
+    }
+  }
+
+  std::vector<std::shared_ptr<TipType>> types;
+  types.reserve(terms.size());
+  for (auto &term : terms) {
+    std::vector<std::shared_ptr<TipType>> args;
+    for (auto a : term.args) {
+      args.push_back(types[a]);
+    }
+
+    ASTNode *node = nullptr;
+    if (term.kind == Term::Var || term.kind == Term::Alpha) {
+      node = term.node >= 0 ? group.nodes[term.node] : group.externals[-1 - term.node];
+    }
+
+    switch (term.kind) {
+    case Term::Var:
+      types.push_back(TipTypeFactory::var(node));
+      break;
+    case Term::Alpha:
+      types.push_back(TipTypeFactory::alpha(node, term.names[0]));
+      break;
+    case Term::Int:
+      types.push_back(TipTypeFactory::intType());
+      break;
+    case Term::Absent:
+      types.push_back(TipTypeFactory::absentField());
+      break;
+    case Term::Ref:
+      types.push_back(TipTypeFactory::ref(args[0]));
+      break;
+    case Term::Function: {
+      auto ret = args.back();
+      args.pop_back();
+      types.push_back(TipTypeFactory::function(args, ret));
+      break;
+    }
+    case Term::Record:
+      types.push_back(TipTypeFactory::record(args, term.names));
+      break;
+    }
+  }
+
+  for (auto &e : equations) {
+    constraints.emplace_back(types[e.first], types[e.second]);
+  }
+  return true;
+}
+
+/*
+ * The format is line based: the number of nodes, the names of the
+ * externals, the terms one per line as a kind letter followed by its
+ * operands, and the equations as pairs of term numbers.  Field names are
+ * identifiers, so they are separated by spaces, and an alpha without a
+ * name is written with a name count of zero.
+ */
+void TypeSummary::write(std::ostream &os) const {
+  os << "nodes " << numNodes << "\n";
+  os << "externals " << externals.size();
+  for (auto &e : externals) {
+    os << " " << e;
+  }
+  os << "\nterms " << terms.size() << "\n";
+  for (auto &t : terms) {
+    switch (t.kind) {
+    case Term::Var: os << "v " << t.node; break;
+    case Term::Alpha:
+      os << "a " << t.node;
+      if (t.names[0].empty()) {
+        os << " 0";
+      } else {
+        os << " 1 " << t.names[0];
+      }
+      break;
+    case Term::Int: os << "i"; break;
+    case Term::Absent: os << "x"; break;
+    case Term::Ref: os << "r " << t.args[0]; break;
+    case Term::Function:
+      os << "f " << t.args.size();
+      for (auto a : t.args) {
+        os << " " << a;
+      }
+      break;
+    case Term::Record:
+      os << "c " << t.args.size();
+      for (std::size_t i = 0; i < t.args.size(); i++) {
+        os << " " << t.names[i] << " " << t.args[i];
+      }
+      break;
+    }
+    os << "\n";
+  }
+  os << "equations " << equations.size();
+  for (auto &e : equations) {
+    os << " " << e.first << " " << e.second;
+  }
+  os << "\n";
+}
+
+/*
+ * Besides the syntax, reading checks that every number refers to an
+ * earlier term, a node or an external, so that a summary that was read can
+ * be instantiated without further checks.
+ */
+std::shared_ptr<TypeSummary> TypeSummary::read(std::istream &is) {
+  auto summary = std::make_shared<TypeSummary>();
+  std::string tag;
+  int count;
+
+  if (!(is >> tag >> summary->numNodes) || tag != "nodes" || summary->numNodes < 0) {
+    return nullptr;
+  }
+  if (!(is >> tag >> count) || tag != "externals" || count < 0) {
+    return nullptr;
+  }
+  summary->externals.resize(count);
+  for (auto &e : summary->externals) {
+    if (!(is >> e)) {
+      return nullptr;
+    }
+  }
+
+  if (!(is >> tag >> count) || tag != "terms" || count < 0) {
+    return nullptr;
+  }
+  auto isTerm = [&summary](int a) { return a >= 0 && a < static_cast<int>(summary->terms.size()); };
+  auto isNode = [&summary](int n) {
+    return n < summary->numNodes && -1 - n < static_cast<int>(summary->externals.size());
+  };
+  for (int i = 0; i < count; i++) {
+    Term t{Term::Int};
+    int arity;
+    if (!(is >> tag) || tag.size() != 1) {
+      return nullptr;
+    }
+    switch (tag[0]) {
+    case 'v':
+      t.kind = Term::Var;
+      if (!(is >> t.node) || !isNode(t.node)) return nullptr;
+      break;
+    case 'a':
+      t.kind = Term::Alpha;
+      t.names.resize(1);
+      if (!(is >> t.node >> arity) || !isNode(t.node) || arity < 0 || arity > 1) return nullptr;
+      if (arity == 1 && !(is >> t.names[0])) return nullptr;
+      break;
+    case 'i':
+      break;
+    case 'x':
+      t.kind = Term::Absent;
+      break;
+    case 'r':
+      t.kind = Term::Ref;
+      t.args.resize(1);
+      if (!(is >> t.args[0]) || !isTerm(t.args[0])) return nullptr;
+      break;
+    case 'f':
+      t.kind = Term::Function;
+      if (!(is >> arity) || arity < 1) return nullptr;
+      t.args.resize(arity);
+      for (auto &a : t.args) {
+        if (!(is >> a) || !isTerm(a)) return nullptr;
+      }
+      break;
+    case 'c':
+      t.kind = Term::Record;
+      if (!(is >> arity) || arity < 0) return nullptr;
+      t.args.resize(arity);
+      t.names.resize(arity);
+      for (int j = 0; j < arity; j++) {
+        if (!(is >> t.names[j] >> t.args[j]) || !isTerm(t.args[j])) return nullptr;
+      }
+      break;
+    default:
+      return nullptr;
+    }
+    summary->terms.push_back(std::move(t));
+  }
+
+  if (!(is >> tag >> count) || tag != "equations" || count < 0) {
+    return nullptr;
+  }
+  summary->equations.resize(count);
+  for (auto &e : summary->equations) {
+    if (!(is >> e.first >> e.second) || !isTerm(e.first) || !isTerm(e.second)) {
+      return nullptr;
+    }
+  }
+  return summary;
+}
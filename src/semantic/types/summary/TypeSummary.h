@@ -0,0 +1,100 @@
+#pragma once
+
+#include "ASTFunction.h"
+#include "SymbolTable.h"
+#include "TypeConstraint.h"
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*! \class TypeSummary
+ *  \brief The solved type constraints of a group of functions.
+ *
+ * The constraints of a group of functions, typically a strongly connected
+ * component of the call graph, mention the type variables of the group's own
+ * nodes and those of the functions it refers to.  Solving them and keeping
+ * only the solutions for the declarations of the group, its field accesses
+ * and the functions it refers to yields a smaller system of equations that
+ * has the same solutions for those variables.  A summary can therefore stand
+ * in for the constraints of its group when the types of the whole program
+ * are solved.
+ *
+ * Summaries do not refer to AST nodes directly.  Type variables refer to the
+ * nodes of the group by their position in a pre-order walk of the group and
+ * to the functions outside the group by name, so a summary computed for one
+ * parse of a group can be instantiated for a later parse of the same text.
+ * \sa Unifier::reduced
+ * \sa TypeSummaryCache
+ */
+class TypeSummary {
+public:
+  /*! \brief A node of a type term.
+   *
+   * Arguments are the numbers of earlier terms.  The node of a variable is
+   * its position in the group, or -1 - i for the i-th external function.
+   */
+  struct Term {
+    enum Kind { Var, Alpha, Int, Absent, Ref, Function, Record };
+    Kind kind;
+    int node = 0;
+    std::vector<int> args;
+    std::vector<std::string> names;
+  };
+
+  /*! \fn summarize
+   *  \brief Solve the type constraints of a group of functions.
+   * \param functions The functions of the group, in program order
+   * \param symbols The symbol table of the program
+   * \return The summary, or nullptr if the constraints of the group cannot be unified
+   */
+  static std::shared_ptr<TypeSummary> summarize(std::vector<ASTFunction*> const &functions,
+                                                SymbolTable *symbols);
+
+  /*! \fn key
+   *  \brief Return a hash of the text of a group of functions.
+   *
+   * The constraints of a group also depend on the record fields of the
+   * program, so they are part of the key.
+   */
+  static std::string key(std::vector<ASTFunction*> const &functions, SymbolTable *symbols);
+
+  //! \brief Return a hash of the keys of several groups, in order.
+  static std::string key(std::vector<std::string> const &keys);
+
+  /*! \fn instantiate
+   *  \brief Produce the equations of the summary over the type variables of a group.
+   * \param functions The functions of the group, in program order
+   * \param symbols The symbol table of the program
+   * \param constraints The vector the equations are appended to
+   * \return false, leaving constraints unchanged, if the group does not match the summary
+   */
+  bool instantiate(std::vector<ASTFunction*> const &functions, SymbolTable *symbols,
+                   std::vector<TypeConstraint> &constraints) const;
+
+  //! \brief Write the summary in the format read by read.
+  void write(std::ostream &os) const;
+
+  //! \brief Read a summary written by write, or return nullptr if the input is malformed.
+  static std::shared_ptr<TypeSummary> read(std::istream &is);
+
+  int getNumNodes() const { return numNodes; }
+  std::vector<std::string> const &getExternals() const { return externals; }
+  std::vector<Term> const &getTerms() const { return terms; }
+  std::vector<std::pair<int, int>> const &getEquations() const { return equations; }
+
+private:
+  /*! \brief Add the terms of a type and return the number of its term.
+   * \param position The position of each node of the group, and of each external
+   * \param translated The number of the term of each type translated so far
+   */
+  int translate(std::shared_ptr<TipType> const &type, std::map<ASTNode*, int> const &position,
+                std::map<TipType*, int> &translated);
+
+  int numNodes = 0;
+  std::vector<std::string> externals;
+  std::vector<Term> terms;
+  std::vector<std::pair<int, int>> equations;
+};
@@ -0,0 +1,78 @@
+#include "TypeSummaryCache.h"
+
+namespace {
+const std::string header = "tip-type-summaries 2";
+}
+
+std::shared_ptr<TypeSummary> TypeSummaryCache::find(std::string const &key) {
+  auto found = summaries.find(key);
+  if (found == summaries.end()) {
+    misses++;
+    return nullptr;
+  }
+  hits++;
+  used.insert(key);
+  return found->second;
+}
+
+void TypeSummaryCache::insert(std::string const &key, std::shared_ptr<TypeSummary> summary) {
+  summaries[key] = std::move(summary);
+  used.insert(key);
+}
+
+bool TypeSummaryCache::isSolved(std::string const &key) {
+  if (solved.count(key) == 0) {
+    return false;
+  }
+  usedSolved.insert(key);
+  return true;
+}
+
+void TypeSummaryCache::markSolved(std::string const &key) {
+  solved.insert(key);
+  usedSolved.insert(key);
+}
+
+/*
+ * Entries are read into a separate map so that a truncated or corrupt
+ * cache adds nothing.
+ */
+bool TypeSummaryCache::load(std::istream &is) {
+  std::string line;
+  if (!std::getline(is, line) || line != header) {
+    return false;
+  }
+
+  std::map<std::string, std::shared_ptr<TypeSummary>> loaded;
+  std::set<std::string> loadedSolved;
+  std::string tag, key;
+  while (is >> tag >> key) {
+    if (tag == "solved") {
+      loadedSolved.insert(key);
+      continue;
+    }
+    auto summary = TypeSummary::read(is);
+    if (tag != "key" || summary == nullptr) {
+      return false;
+    }
+    loaded[key] = summary;
+  }
+  if (!is.eof()) {
+    return false;
+  }
+
+  summaries.insert(loaded.begin(), loaded.end());
+  solved.insert(loadedSolved.begin(), loadedSolved.end());
+  return true;
+}
+
+void TypeSummaryCache::save(std::ostream &os) const {
+  os << header << "\n";
+  for (auto &key : used) {
+    os << "key " << key << "\n";
+    summaries.at(key)->write(os);
+  }
+  for (auto &key : usedSolved) {
+    os << "solved " << key << "\n";
+  }
+}
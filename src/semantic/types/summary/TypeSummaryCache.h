@@ -0,0 +1,61 @@
+#pragma once
+
+#include "TypeSummary.h"
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <string>
+
+/*! \class TypeSummaryCache
+ *  \brief Type summaries keyed by a hash of the text of their group of functions.
+ *
+ * The cache can be saved to and loaded from a stream, so that a compilation
+ * only solves the constraints of the groups whose text changed since the
+ * last one.  Saving writes only the summaries that were looked up or added
+ * since the cache was loaded, so summaries of text that no longer exists
+ * are dropped.
+ *
+ * The cache also records the keys of the sets of groups whose summaries
+ * were solved together without error, so that an unchanged part of a
+ * program need not be checked again.
+ * \sa TypeSummary
+ */
+class TypeSummaryCache {
+  std::map<std::string, std::shared_ptr<TypeSummary>> summaries;
+  std::set<std::string> used;
+  std::set<std::string> solved;
+  std::set<std::string> usedSolved;
+  int hits = 0;
+  int misses = 0;
+public:
+  //! \brief Return the summary stored under key, or nullptr.
+  std::shared_ptr<TypeSummary> find(std::string const &key);
+
+  //! \brief Store a summary under key, replacing any summary stored there.
+  void insert(std::string const &key, std::shared_ptr<TypeSummary> summary);
+
+  //! \brief Return whether the summaries of the groups combined in key were solved together.
+  bool isSolved(std::string const &key);
+
+  //! \brief Record that the summaries of the groups combined in key were solved together.
+  void markSolved(std::string const &key);
+
+  //! \brief The number of stored summaries.
+  std::size_t size() const { return summaries.size(); }
+
+  //! \brief The number of lookups that found a summary.
+  int getHits() const { return hits; }
+
+  //! \brief The number of lookups that did not find a summary.
+  int getMisses() const { return misses; }
+
+  /*! \brief Add the summaries written by save.
+   * \return false if the input is not a cache, in which case nothing is added
+   */
+  bool load(std::istream &is);
+
+  //! \brief Write the summaries and solved keys that were used since the cache was loaded.
+  void save(std::ostream &os) const;
+};
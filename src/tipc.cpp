@@ -5,10 +5,17 @@
 #include "ParseError.h"
 #include "InternalError.h"
 #include "SemanticError.h"
+#include "TypeSummaryCache.h"
+#include "PhaseScheduler.h"
+#include "Statistics.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/raw_ostream.h"
 #include "loguru.hpp"
 
 #include <fstream>
+#include <stdexcept>
 
 using namespace llvm;
 using namespace std;
@@ -19,9 +26,57 @@ static cl::opt<bool> psym("ps", cl::desc("print symbols"), cl::cat(TIPcat));
 static cl::opt<bool> ptypes("pt", cl::desc("print symbols with types (supercedes --ps)"), cl::cat(TIPcat));
 static cl::opt<bool> disopt("do", cl::desc("disable bitcode optimization"), cl::cat(TIPcat));
 static cl::opt<int> debug("verbose", cl::desc("enable log messages (Levels 1-3) \n Level 1 - Basic logging for every phase.\n Level 2 - Level 1 and type constraints being unified.\n Level 3 - Level 2 and union-find solving steps."), cl::cat(TIPcat));
+static cl::opt<bool> typedCodegen("typed-codegen",
+                                  cl::desc("represent references, records and functions by LLVM pointer types derived from the inferred types, rather than Int64"),
+                                  cl::cat(TIPcat));
+static cl::opt<bool> promoteCalls("promote-calls",
+                                  cl::desc("call the functions that control flow analysis finds a function value may be directly"),
+                                  cl::cat(TIPcat));
+static cl::opt<bool> pooledAlloc("pooled-alloc",
+                                 cl::desc("allocate heap cells with the pooled allocator of the runtime library rather than calloc"),
+                                 cl::cat(TIPcat));
 static cl::opt<bool> emitHrAsm("asm",
                            cl::desc("emit human-readable LLVM assembly language"),
                            cl::cat(TIPcat));
+static cl::opt<unsigned> jobs("j",
+                             cl::value_desc("threads"),
+                             cl::desc("run independent phases, and generate type constraints, on <threads> threads (0 for all hardware threads)"),
+                             cl::init(1),
+                             cl::cat(TIPcat));
+static cl::opt<unsigned> unifyJobs("unify-threads",
+                                   cl::value_desc("threads"),
+                                   cl::desc("unify type constraints on <threads> threads (0 for all hardware threads); free type variables printed by --pt may then be named differently from run to run"),
+                                   cl::init(1),
+                                   cl::cat(TIPcat));
+static cl::opt<bool> phaseTimes("phase-times",
+                                cl::desc("report the time taken by each phase and the time saved by running phases concurrently"),
+                                cl::cat(TIPcat));
+static cl::opt<std::string> timeTrace("time-trace",
+                                     cl::value_desc("trace file"),
+                                     cl::desc("write the time spent in each phase, pass and function to <trace file> in Chrome trace format"),
+                                     cl::cat(TIPcat));
+static cl::opt<unsigned> timeTraceGranularity("time-trace-granularity",
+                                              cl::value_desc("microseconds"),
+                                              cl::desc("the shortest span recorded by --time-trace"),
+                                              cl::init(500),
+                                              cl::cat(TIPcat));
+enum class StatsFormat { none, json };
+static cl::opt<StatsFormat> statsFormat("stats-format",
+                                        cl::desc("report counters gathered across the compiler and the time and memory of each phase"),
+                                        cl::values(clEnumValN(StatsFormat::json, "json", "as a JSON object")),
+                                        cl::init(StatsFormat::none),
+                                        cl::cat(TIPcat));
+static cl::opt<std::string> statsFile("stats-file",
+                                      cl::value_desc("stats file"),
+                                      cl::desc("write the report of --stats-format to <stats file> instead of stderr"),
+                                      cl::cat(TIPcat));
+static cl::opt<std::string> typeCache("type-cache",
+                                     cl::value_desc("cache file"),
+                                     cl::desc("reuse the types solved for each strongly connected component of the references between functions from <cache file> and update it; free type variables printed by --pt may be named differently"),
+                                     cl::cat(TIPcat));
+static cl::opt<bool> prune("prune",
+                           cl::desc("remove functions that are not reachable from main before type checking and code generation"),
+                           cl::cat(TIPcat));
 static cl::opt<std::string> cgFile("pcg", 
                          cl::value_desc("call graph output file"),
                          cl::desc("print call graph to a file in dot syntax"), 
@@ -43,10 +98,83 @@ static cl::opt<std::string> outputfile("o",
                                     cl::desc("write output to <outputfile>"),
                                     cl::cat(TIPcat));
 
+namespace {
+
+//! \brief Raised by a phase that cannot open the file it writes.
+class OutputError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+std::ofstream openOutput(std::string const &name) {
+  std::ofstream stream(name);
+  if (!stream.good()) {
+    throw OutputError("failed to open '" + name + "' for writing");
+  }
+  return stream;
+}
+
+// Record the number of LLVM instructions of each function defined in the module.
+void countInstructions(llvm::Module *module, Statistics &stats, std::string const &counter) {
+  unsigned total = 0;
+  for (auto &fun : module->functions()) {
+    if (!fun.isDeclaration()) {
+      stats.set("functions", fun.getName().str(), counter, fun.getInstructionCount());
+      total += fun.getInstructionCount();
+    }
+  }
+  stats.set("llvm", counter, total);
+}
+
+/*! \brief Report the phase times, the statistics and the time trace, if asked for.
+ * \return false if a report cannot be written
+ */
+bool finishPhases(PhaseScheduler const &phases, Statistics &stats) {
+  bool written = true;
+  if (phaseTimes) {
+    phases.report(std::cerr);
+  }
+
+  if (statsFormat == StatsFormat::json) {
+    for (auto &record : phases.getRecords()) {
+      stats.set("phases", record.name, "timeMs", record.time);
+      stats.set("phases", record.name, "cumulativePeakRssKiB", record.cumulativePeakRSS);
+      stats.set("phases", record.name, "peakRssGrowthKiB", record.peakRSSGrowth);
+    }
+    if (statsFile.getValue().empty()) {
+      stats.print(std::cerr);
+    } else {
+      std::ofstream statsStream(statsFile);
+      if (statsStream.good()) {
+        stats.print(statsStream);
+      } else {
+        LOG_S(ERROR) << "tipc: error: failed to open '" << statsFile << "' for writing";
+        written = false;
+      }
+    }
+  }
+
+  if (llvm::timeTraceProfilerEnabled()) {
+    std::error_code ec;
+    llvm::raw_fd_ostream traceStream(timeTrace, ec, llvm::sys::fs::OF_Text);
+    if (!ec) {
+      llvm::timeTraceProfilerWrite(traceStream);
+    }
+    llvm::timeTraceProfilerCleanup();
+    if (ec) {
+      LOG_S(ERROR) << "tipc: error: failed to open '" << timeTrace << "' for writing";
+      written = false;
+    }
+  }
+  return written;
+}
+
+}
+
 /*! \brief tipc driver.
  * 
  * This function is the entry point for tipc.   It handles command line parsing
- * using LLVM CommandLine support.  It runs the phases of the compiler in sequence.
+ * using LLVM CommandLine support.  It runs the phases of the compiler with a PhaseScheduler.
  * If an error is detected, via an exception, it reports the error and exits.  
  * If there is no error, then the LLVM bitcode is emitted to a file whose name
  * is the providvvved source file suffixed by ".bc".
@@ -70,6 +198,10 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if (!timeTrace.getValue().empty()) {
+    llvm::timeTraceProfilerInitialize(timeTraceGranularity, "tipc");
+  }
+
   std::ifstream stream;
   stream.open(sourceFile);
   if(!stream.good()) {
@@ -82,76 +214,180 @@ int main(int argc, char *argv[]) {
    * represented using smart pointers.  The driver "owns" this data and
    * it permits other components to read the contents by passing
    * the underlying pointer, i.e., via a call to get().
+   *
+   * The phases are run by a scheduler in the order they are added here,
+   * except that phases whose inputs are ready run concurrently with -j.
+   * Phases that print add to their own buffer, which the scheduler copies
+   * to cout in order, so the output does not depend on the threads.  Phases
+   * that write files depend on the type check, so that nothing is written
+   * for a program with errors.
    */
   try {
-    std::shared_ptr<ASTProgram> ast = std::move(FrontEnd::parse(stream));
-
-    try {
-      auto analysisResults = SemanticAnalysis::analyze(ast.get());
+    std::shared_ptr<ASTProgram> ast;
+    std::unique_ptr<SemanticAnalysis> analysisResults;
+    std::unique_ptr<llvm::Module> llvmModule;
+    bool caching = !typeCache.getValue().empty();
+    TypeSummaryCache cache;
+    PhaseScheduler phases;
+    phases.setTimeTraceGranularity(timeTraceGranularity);
+    bool gatherStats = statsFormat == StatsFormat::json;
+    Statistics stats;
 
+    int loadCache = -1;
+    if (caching) {
+      loadCache = phases.add("load type cache", [&](std::ostream &) {
+        std::ifstream cacheStream(typeCache);
+        if (cacheStream.good() && !cache.load(cacheStream)) {
+          LOG_S(WARNING) << "tipc: ignoring malformed type cache '" << typeCache << "'";
+        }
+      });
+    }
 
-      if (ppretty) {
-        FrontEnd::prettyprint(ast.get(), std::cout);
+    int parse = phases.add("parse", [&](std::ostream &) {
+      // The driver never retains nodes beyond the program so it can use an arena
+      ast = std::move(FrontEnd::parse(stream, true));
+      if (gatherStats) {
+        stats.set("ast", "nodes", ast->getNumNodes());
+        stats.set("ast", "functions", ast->getFunctions().size());
+        if (auto arena = ast->getArena()) {
+          stats.set("ast", "arenaBytes", arena->bytesAllocated());
+        }
       }
+    });
 
-      if (ptypes) {
-        analysisResults->getTypeResults()->print(std::cout);
-      } else if (psym) {
-        analysisResults->getSymbolTable()->print(std::cout);
+    int names = phases.add("names", [&](std::ostream &) {
+      analysisResults = SemanticAnalysis::resolve(ast.get(), jobs, caching ? &cache : nullptr, prune,
+                                                   unifyJobs);
+      if (gatherStats && prune) {
+        stats.set("ast", "prunedNodes", ast->getNumNodes());
       }
+    }, {parse});
+
+    // Pruning removes functions from the AST, so readers of the AST wait for it
+    int astReady = prune ? names : parse;
 
-      bool printCG = !cgFile.getValue().empty();
-      if(printCG) {
-        std::ofstream cgStream;
-        cgStream.open(cgFile);
-        if(!cgStream.good()) {
-          LOG_S(ERROR) << "tipc: error: failed to open '" << cgFile << "' for writing";
-          exit(1);
+    // The control flow counters are reported when the call graph is printed, and
+    // are not a reason to run the cubic analysis on their own
+    bool printCG = !cgFile.getValue().empty();
+    int callGraph = -1;
+    if (printCG) {
+      callGraph = phases.add("call graph", [&](std::ostream &) {
+        auto graph = analysisResults->getCallGraph();
+        if (gatherStats) {
+          auto solver = graph->getSolverStats();
+          stats.set("cfa", "variables", solver.variables);
+          stats.set("cfa", "merges", solver.merges);
+          stats.set("cfa", "propagatedBits", solver.propagated);
+          stats.set("cfa", "callEdges", graph->getTotalEdges());
         }
+      }, {names});
+    }
 
-        analysisResults->getCallGraph()->print(cgStream);
+    std::vector<int> typeInputs = {names};
+    if (caching) {
+      typeInputs.push_back(loadCache);
+    }
+    // Printing the types and code generation, which lays out records by their types, query them at the same time
+    int types = phases.add("types", [&](std::ostream &) {
+      bool queried = ptypes || typedCodegen || !analysisResults->getSymbolTable()->getFields().empty();
+      analysisResults->checkTypes(queried);
+      if (gatherStats) {
+        stats.set("types", "constraints", analysisResults->getTypeResults()->getNumConstraints());
+        stats.set("types", "unionFindTerms", analysisResults->getTypeResults()->getNumTerms());
       }
+    }, typeInputs);
 
-      auto llvmModule = CodeGenerator::generate(ast.get(), analysisResults.get(), sourceFile);
+    if (caching) {
+      phases.add("save type cache", [&](std::ostream &) {
+        auto cacheStream = openOutput(typeCache);
+        cache.save(cacheStream);
+      }, {types});
+    }
 
-      if (!disopt) {
-        Optimizer::optimize(llvmModule.get());
+    if (ppretty) {
+      phases.add("pretty print", [&](std::ostream &out) {
+        FrontEnd::prettyprint(ast.get(), out);
+      }, {astReady});
+    }
+
+    if (ptypes) {
+      phases.add("print types", [&](std::ostream &out) {
+        analysisResults->getTypeResults()->print(out);
+      }, {types});
+    } else if (psym) {
+      phases.add("print symbols", [&](std::ostream &out) {
+        analysisResults->getSymbolTable()->print(out);
+      }, {names});
+    }
+
+    if (printCG) {
+      phases.add("print call graph", [&](std::ostream &) {
+        auto cgStream = openOutput(cgFile);
+        analysisResults->getCallGraph()->print(cgStream);
+      }, {callGraph, types});
+    }
+
+    int generated = phases.add("codegen", [&](std::ostream &) {
+      llvmModule = CodeGenerator::generate(ast.get(), analysisResults.get(), sourceFile, typedCodegen,
+                                           promoteCalls, pooledAlloc);
+      if (gatherStats) {
+        countInstructions(llvmModule.get(), stats, "instructions");
       }
+    }, {types});
 
+    if (!disopt) {
+      generated = phases.add("optimize", [&](std::ostream &) {
+        Optimizer::optimize(llvmModule.get());
+        if (gatherStats) {
+          countInstructions(llvmModule.get(), stats, "optimizedInstructions");
+        }
+      }, {generated});
+    }
+
+    phases.add("emit", [&](std::ostream &) {
       if(emitHrAsm) {
         CodeGenerator::emitHumanReadableAssembly(llvmModule.get(), outputfile);
       } else {
         CodeGenerator::emit(llvmModule.get(), outputfile);
       }
+    }, {generated});
 
-      bool printAST = !astFile.getValue().empty();
-      if(printAST) {
-        std::ofstream astStream;
-        astStream.open(astFile);
-        if(!astStream.good()) {
-          LOG_S(ERROR) << "tipc: error: failed to open '" << astFile << "' for writing";
-          exit(1);
-        }
-
+    bool printAST = !astFile.getValue().empty();
+    if(printAST) {
+      phases.add("print AST", [&](std::ostream &) {
+        auto astStream = openOutput(astFile);
         FrontEnd::astVisualize(ast, astStream);
-      }
+      }, {astReady, types});
+    }
 
-    } catch (SemanticError& e) {
-      LOG_S(ERROR) << "tipc: " << e.what();
-      LOG_S(ERROR) << "tipc: semantic error";
-      exit (EXIT_FAILURE);
-    } catch (InternalError& e) { // LCOV_EXCL_LINE
-      /* Internal errors should never happen, but we have logic to catch 
-       * them just in case.  We do not want to count these lines toward 
-       * coverage goals since a working compiler will never cover these.
-       */
-      LOG_S(ERROR) << "tipc: " << e.what(); // LCOV_EXCL_LINE
-      LOG_S(ERROR) << "tipc: internal error"; // LCOV_EXCL_LINE
-      exit (EXIT_FAILURE); // LCOV_EXCL_LINE
+    try {
+      phases.run(jobs, std::cout);
+    } catch (...) {
+      finishPhases(phases, stats);
+      throw;
+    }
+    if (!finishPhases(phases, stats)) {
+      exit(1);
     }
+
   } catch (ParseError& e) {
     LOG_S(ERROR) << "tipc: " << e.what();
     LOG_S(ERROR) << "tipc: parse error";
     exit (EXIT_FAILURE);
-  }  // LCOV_EXCL_LINE
+  } catch (SemanticError& e) {
+    LOG_S(ERROR) << "tipc: " << e.what();
+    LOG_S(ERROR) << "tipc: semantic error";
+    exit (EXIT_FAILURE);
+  } catch (OutputError& e) {
+    LOG_S(ERROR) << "tipc: error: " << e.what();
+    exit(1);
+  } catch (InternalError& e) { // LCOV_EXCL_LINE
+    /* Internal errors should never happen, but we have logic to catch 
+     * them just in case.  We do not want to count these lines toward 
+     * coverage goals since a working compiler will never cover these.
+     */
+    LOG_S(ERROR) << "tipc: " << e.what(); // LCOV_EXCL_LINE
+    LOG_S(ERROR) << "tipc: internal error"; // LCOV_EXCL_LINE
+    exit (EXIT_FAILURE); // LCOV_EXCL_LINE
+  }
 }  // LCOV_EXCL_LINE
@@ -0,0 +1,116 @@
+#include "ProgramGenerator.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string function(int k) {
+  return "fun" + std::to_string(k);
+}
+
+// The kinds of calls a function makes.
+enum class Call { direct, variable, apply };
+
+void generateFunction(ProgramGenerator::Shape const &shape, int k, std::mt19937 &rng, std::ostream &os) {
+  std::uniform_int_distribution<int> percent(0, 99);
+  bool recursive = percent(rng) < shape.recursive;
+
+  std::vector<std::pair<Call, int>> calls;
+  if (k > 0) {
+    std::uniform_int_distribution<int> callee(0, k - 1);
+    for (int c = 0; c < shape.calls; c++) {
+      auto kind = Call::direct;
+      if (percent(rng) < shape.higherOrder) {
+        kind = c % 2 == 0 ? Call::variable : Call::apply;
+      }
+      calls.emplace_back(kind, callee(rng));
+    }
+  }
+  bool usesVariable = std::any_of(calls.begin(), calls.end(),
+                                  [](auto &call) { return call.first == Call::variable; });
+  int recordFields = std::min(shape.recordFields, shape.fields);
+
+  os << function(k) << "(a, b) {\n";
+  os << "  var x";
+  if (usesVariable) {
+    os << ", g";
+  }
+  for (int p = 1; p <= shape.pointerDepth; p++) {
+    os << ", p" << p;
+  }
+  if (recordFields > 0) {
+    os << ", r";
+  }
+  if (recursive) {
+    os << ", l";
+  }
+  os << ";\n";
+
+  os << "  x = a + b;\n";
+
+  if (shape.pointerDepth > 0) {
+    os << "  p1 = &x;\n";
+    for (int p = 2; p <= shape.pointerDepth; p++) {
+      os << "  p" << p << " = &p" << p - 1 << ";\n";
+    }
+    std::string deref(shape.pointerDepth, '*');
+    os << "  " << deref << "p" << shape.pointerDepth << " = " << deref << "p" << shape.pointerDepth << " + 1;\n";
+  }
+
+  if (recordFields > 0) {
+    os << "  r = {";
+    for (int f = 0; f < recordFields; f++) {
+      os << (f > 0 ? ", " : "") << "field" << (k + f) % shape.fields << ": " << (f % 2 == 0 ? "x" : "a");
+    }
+    os << "};\n";
+    os << "  x = x + r.field" << k % shape.fields << ";\n";
+  }
+
+  if (recursive) {
+    os << "  l = alloc {val: x, next: null};\n";
+    os << "  (*l).next = l;\n";
+    os << "  x = x + (*(*l).next).val;\n";
+  }
+
+  for (auto &call : calls) {
+    switch (call.first) {
+    case Call::direct:
+      os << "  x = " << function(call.second) << "(x, a) + x;\n";
+      break;
+    case Call::variable:
+      os << "  g = " << function(call.second) << ";\n";
+      os << "  x = g(x, b) + x;\n";
+      break;
+    case Call::apply:
+      os << "  x = apply(" << function(call.second) << ", x, a) + x;\n";
+      break;
+    }
+  }
+
+  os << "  return x;\n";
+  os << "}\n\n";
+}
+
+}
+
+void ProgramGenerator::generate(Shape const &shape, std::ostream &os) {
+  std::mt19937 rng(shape.seed);
+
+  os << "apply(h, x, y) {\n";
+  os << "  return h(x, y);\n";
+  os << "}\n\n";
+
+  for (int k = 0; k < shape.functions; k++) {
+    generateFunction(shape, k, rng, os);
+  }
+
+  os << "main() {\n";
+  os << "  var x;\n";
+  os << "  x = " << (shape.functions > 0 ? function(shape.functions - 1) + "(1, 2)" : "0") << ";\n";
+  os << "  output x;\n";
+  os << "  return 0;\n";
+  os << "}\n";
+}
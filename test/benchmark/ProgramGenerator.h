@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ostream>
+
+/*! \class ProgramGenerator
+ *  \brief Generates synthetic TIP programs of a given shape for benchmarks.
+ *
+ * A program has functions fun0 ... fun(n-1) that take and return integers,
+ * plus a main that calls the last of them.  A function only calls functions
+ * with smaller numbers, so the call graph is acyclic, but since every call is
+ * made whatever the arguments a generated program is only meant to be
+ * compiled, not run.  The body of a function exercises each part of the
+ * compiler in proportion to the shape:
+ *  - direct calls, whose number sets the density of the call graph;
+ *  - calls through a function variable, and through a function passed to
+ *    apply, which the control flow analysis has to resolve;
+ *  - a record with some of the field names of the program;
+ *  - a chain of pointers to a local;
+ *  - a linked cell whose type is recursive, which yields a mu type.
+ *
+ * Programs are type correct, and the same shape always yields the same program.
+ */
+class ProgramGenerator {
+public:
+  //! \brief The shape of a generated program.
+  struct Shape {
+    int functions = 100;     //!< number of functions besides main and apply
+    int calls = 3;           //!< calls made by each function, bar the first
+    int higherOrder = 20;    //!< percentage of the calls made through function values
+    int fields = 8;          //!< distinct field names in the program
+    int recordFields = 2;    //!< fields of the record built by each function
+    int pointerDepth = 2;    //!< length of the chain of pointers in each function
+    int recursive = 10;      //!< percentage of the functions that build a recursive cell
+    unsigned seed = 1;       //!< seed for the choice of callees
+  };
+
+  /*! \brief Write a program of the given shape.
+   * \param shape The shape of the program
+   * \param os The stream the source of the program is written to
+   */
+  static void generate(Shape const &shape, std::ostream &os);
+};
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Heap allocation benchmark for tipc.
+
+Compiles the TIP programs in the alloc directory twice, allocating their
+heap cells with calloc and free from the C library, and with the pooled
+allocator of the runtime library (tipc --pooled-alloc).  Each program is
+run with the same inputs in both builds and the fastest of several runs
+is reported, with the speedup of the pooled allocator.
+"""
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# The workloads and the inputs of their main functions
+WORKLOADS = {
+    'linkedlist': [1000, 5000],
+    'recordchurn': [50000000],
+    'widerecordchurn': [20000000],
+}
+
+BUILDS = {'malloc': [], 'pooled': ['--pooled-alloc']}
+
+
+def build(args, name, flags, scratch):
+    source = os.path.join(scratch, name + '.tip')
+    with open(os.path.join(HERE, 'alloc', name + '.tip')) as f, open(source, 'w') as out:
+        out.write(f.read())
+    subprocess.run([args.tipc] + flags + shlex.split(args.tipc_args) + [source], check=True)
+    obj = os.path.join(scratch, name + '.o')
+    subprocess.run([args.llc, '-O2', '-filetype=obj', '-relocation-model=pic', source + '.bc', '-o', obj],
+                   check=True)
+    exe = os.path.join(scratch, name + '-' + '-'.join(flags or ['malloc']))
+    subprocess.run([args.cc, obj, args.rtlib_obj, '-o', exe], check=True)
+    return exe
+
+
+def run(args, exe, inputs):
+    best = None
+    output = None
+    for _ in range(args.repeat):
+        start = time.perf_counter()
+        result = subprocess.run([exe] + [str(i) for i in inputs], check=True, capture_output=True, text=True)
+        wall = (time.perf_counter() - start) * 1000
+        best = wall if best is None else min(best, wall)
+        output = result.stdout.strip()
+    return best, output
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--tipc', required=True, help='the tipc executable')
+    parser.add_argument('--llc', default='llc', help='the LLVM static compiler (default %(default)s)')
+    parser.add_argument('--cc', default='cc', help='the C compiler for the runtime library (default %(default)s)')
+    parser.add_argument('--rtlib', default=os.path.join(HERE, '..', '..', 'rtlib', 'tip_rtlib.c'),
+                        help='the runtime library source')
+    parser.add_argument('--tipc-args', default='', help='further tipc options, e.g. "-do"')
+    parser.add_argument('--repeat', type=int, default=3, help='runs of each program (default %(default)s)')
+    parser.add_argument('--output', default='benchmark-alloc.json', help='the results file (default %(default)s)')
+    args = parser.parse_args()
+
+    results = {'tipc': args.tipc, 'tipcArgs': args.tipc_args, 'workloads': {}}
+    failed = False
+    with tempfile.TemporaryDirectory() as scratch:
+        args.rtlib_obj = os.path.join(scratch, 'tip_rtlib.o')
+        subprocess.run([args.cc, '-O2', '-c', args.rtlib, '-o', args.rtlib_obj], check=True)
+
+        for name, inputs in WORKLOADS.items():
+            workload = {'inputs': inputs}
+            outputs = set()
+            for build_name, flags in BUILDS.items():
+                wall, output = run(args, build(args, name, flags, scratch), inputs)
+                workload[build_name + 'Ms'] = round(wall, 1)
+                outputs.add(output)
+            workload['speedup'] = round(workload['mallocMs'] / workload['pooledMs'], 2)
+            if len(outputs) != 1:
+                workload['error'] = 'the builds disagree: ' + ' / '.join(sorted(outputs))
+                failed = True
+            results['workloads'][name] = workload
+            print('%-16s malloc %8.1f ms  pooled %8.1f ms  speedup %.2f%s'
+                  % (name, workload['mallocMs'], workload['pooledMs'], workload['speedup'],
+                     '  ' + workload['error'] if 'error' in workload else ''), flush=True)
+
+    with open(args.output, 'w') as f:
+        json.dump(results, f, indent=2)
+        f.write('\n')
+    print('results written to', args.output)
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Compile time scaling benchmark for tipc.
+
+Generates programs of increasing size with tipgen, compiles each with
+tipc --stats-format=json, and writes the time and peak memory of every phase and
+the compiler's counters to a JSON file.  For each phase the growth of its
+time between consecutive sizes is reported as an exponent, time ~ size^k,
+so a phase that is quadratic in the size of the program shows up as k near 2.
+"""
+import argparse
+import json
+import math
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+DEFAULT_SIZES = [100, 316, 1000, 3162, 10000, 31623, 100000]
+
+# Times below this are too noisy to estimate an exponent from
+MIN_SCALING_MS = 5.0
+
+
+def compile_once(args, source, scratch):
+    stats_file = os.path.join(scratch, 'stats.json')
+    command = [args.tipc, '--stats-format=json', '--stats-file=' + stats_file,
+               '-o', os.path.join(scratch, 'out.bc')] + shlex.split(args.tipc_args) + [source]
+    start = time.perf_counter()
+    subprocess.run(command, check=True, timeout=args.timeout,
+                   stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    wall = (time.perf_counter() - start) * 1000
+    with open(stats_file) as f:
+        return wall, json.load(f)
+
+
+def measure(args, size, scratch):
+    """Compile a program of the given size repeatedly, keeping the fastest time of each phase."""
+    source = os.path.join(scratch, 'bench%d.tip' % size)
+    subprocess.run([args.tipgen, '--functions=%d' % size, '-o', source] + shlex.split(args.shape),
+                   check=True)
+
+    result = {'functions': size, 'status': 'ok', 'wallMs': None, 'phases': {}, 'counters': {}}
+    for _ in range(args.repeat):
+        try:
+            wall, stats = compile_once(args, source, scratch)
+        except subprocess.TimeoutExpired:
+            result['status'] = 'timeout'
+            return result
+        except subprocess.CalledProcessError as e:
+            result['status'] = 'error'
+            result['error'] = e.stderr.decode(errors='replace')[-2000:]
+            return result
+
+        result['wallMs'] = wall if result['wallMs'] is None else min(result['wallMs'], wall)
+        for name, phase in stats.pop('phases', {}).items():
+            best = result['phases'].setdefault(name, dict(phase))
+            best['timeMs'] = min(best['timeMs'], phase['timeMs'])
+            best['cumulativePeakRssKiB'] = max(best['cumulativePeakRssKiB'],
+                                               phase['cumulativePeakRssKiB'])
+            best['peakRssGrowthKiB'] = max(best['peakRssGrowthKiB'], phase['peakRssGrowthKiB'])
+        stats.pop('functions', None)
+        result['counters'] = stats
+    return result
+
+
+def scaling(runs):
+    """The exponent of the growth of each phase between consecutive sizes."""
+    exponents = {}
+    ok = [r for r in runs if r['status'] == 'ok']
+    for small, large in zip(ok, ok[1:]):
+        ratio = math.log(large['functions'] / small['functions'])
+        for name, phase in large['phases'].items():
+            before = small['phases'].get(name)
+            if before is None or before['timeMs'] < MIN_SCALING_MS:
+                continue
+            k = math.log(phase['timeMs'] / before['timeMs']) / ratio
+            exponents.setdefault(name, []).append(
+                {'from': small['functions'], 'to': large['functions'], 'exponent': round(k, 2)})
+    return exponents
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--tipc', required=True, help='the tipc executable')
+    parser.add_argument('--tipgen', required=True, help='the tipgen executable')
+    parser.add_argument('--sizes', default=','.join(map(str, DEFAULT_SIZES)),
+                        help='comma separated numbers of functions (default %(default)s)')
+    parser.add_argument('--shape', default='', help='further tipgen options, e.g. "--calls=5 --higher-order=50"')
+    parser.add_argument('--tipc-args', default='', help='further tipc options, e.g. "-j 4"')
+    parser.add_argument('--repeat', type=int, default=3, help='compilations per size (default %(default)s)')
+    parser.add_argument('--timeout', type=float, default=600, help='seconds allowed per compilation')
+    parser.add_argument('--max-exponent', type=float,
+                        help='fail if a phase grows faster than size^k between two sizes')
+    parser.add_argument('--output', default='benchmark.json', help='the results file (default %(default)s)')
+    args = parser.parse_args()
+
+    runs = []
+    with tempfile.TemporaryDirectory() as scratch:
+        for size in [int(s) for s in args.sizes.split(',')]:
+            run = measure(args, size, scratch)
+            runs.append(run)
+            phases = ' '.join('%s=%.1f' % (name, p['timeMs']) for name, p in run['phases'].items())
+            wall = '%.1f ms' % run['wallMs'] if run['wallMs'] is not None else '-'
+            print('%7d functions: %s %s %s' % (size, run['status'], wall, phases), flush=True)
+            if run['status'] != 'ok':
+                break
+
+    exponents = scaling(runs)
+    results = {
+        'tipc': args.tipc,
+        'shape': args.shape,
+        'tipcArgs': args.tipc_args,
+        'runs': runs,
+        'scaling': exponents,
+    }
+    with open(args.output, 'w') as f:
+        json.dump(results, f, indent=2)
+        f.write('\n')
+    print('results written to', args.output)
+
+    failed = any(r['status'] != 'ok' for r in runs)
+    for name, steps in exponents.items():
+        worst = max(steps, key=lambda s: s['exponent'])
+        print('%-24s grows like size^%.2f (worst from %d to %d functions)'
+              % (name, worst['exponent'], worst['from'], worst['to']))
+        if args.max_exponent is not None and worst['exponent'] > args.max_exponent:
+            failed = True
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
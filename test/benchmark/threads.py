@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""Thread scaling benchmark for the type checking of tipc.
+
+Generates one program with tipgen and compiles it with 1 to N threads, where
+N is the number of hardware threads, recording the time spent generating
+type constraints (tipc -j) and unifying them (tipc --unify-threads) from the
+--time-trace of each compilation.  The fastest of several compilations is
+kept and the speedup over one thread is reported for each.
+
+Constraint generation with -j must not change the output of tipc, so the
+types printed by --pt with each number of threads are also compared with
+those printed by a single thread.
+"""
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+# The spans of the time trace that are reported, and the tipc options that parallelize them
+SPANS = {'TypeConstraints': '-j', 'Unify': '--unify-threads'}
+
+
+def default_threads():
+    counts = []
+    n = 1
+    while n < os.cpu_count():
+        counts.append(n)
+        n *= 2
+    return counts + [os.cpu_count()]
+
+
+def durations(trace_file):
+    """The total duration in milliseconds of each span and phase of a time trace."""
+    with open(trace_file) as f:
+        events = json.load(f)['traceEvents']
+    totals = {}
+    for event in events:
+        if event.get('ph') != 'X':
+            continue
+        name = event['name']
+        if name == 'Phase':
+            name = event.get('args', {}).get('detail', name)
+        elif name not in SPANS:
+            continue
+        totals[name] = totals.get(name, 0.0) + event['dur'] / 1000
+    return totals
+
+
+def compile_once(args, source, threads, scratch):
+    trace_file = os.path.join(scratch, 'trace.json')
+    command = [args.tipc, '--do', '-j', str(threads), '--unify-threads', str(threads),
+               '--time-trace=' + trace_file, '--time-trace-granularity=0',
+               '-o', os.path.join(scratch, 'out.bc')] + shlex.split(args.tipc_args) + [source]
+    start = time.perf_counter()
+    subprocess.run(command, check=True, timeout=args.timeout, stdout=subprocess.DEVNULL)
+    wall = (time.perf_counter() - start) * 1000
+    return wall, durations(trace_file)
+
+
+def printed_types(args, source, threads, scratch):
+    command = [args.tipc, '--do', '--pt', '-j', str(threads), '-o', os.path.join(scratch, 'out.bc')] \
+        + shlex.split(args.tipc_args) + [source]
+    return subprocess.run(command, check=True, timeout=args.timeout, capture_output=True, text=True).stdout
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--tipc', required=True, help='the tipc executable')
+    parser.add_argument('--tipgen', required=True, help='the tipgen executable')
+    parser.add_argument('--functions', type=int, default=10000, help='functions in the program (default %(default)s)')
+    parser.add_argument('--shape', default='', help='further tipgen options, e.g. "--calls=5 --higher-order=50"')
+    parser.add_argument('--threads', default=','.join(map(str, default_threads())),
+                        help='comma separated numbers of threads (default %(default)s)')
+    parser.add_argument('--tipc-args', default='', help='further tipc options')
+    parser.add_argument('--repeat', type=int, default=3, help='compilations per number of threads (default %(default)s)')
+    parser.add_argument('--timeout', type=float, default=600, help='seconds allowed per compilation')
+    parser.add_argument('--output', default='benchmark-threads.json', help='the results file (default %(default)s)')
+    args = parser.parse_args()
+
+    runs = []
+    identical = True
+    with tempfile.TemporaryDirectory() as scratch:
+        source = os.path.join(scratch, 'bench.tip')
+        subprocess.run([args.tipgen, '--functions=%d' % args.functions, '-o', source] + shlex.split(args.shape),
+                       check=True)
+        serial_types = None
+        for threads in [int(t) for t in args.threads.split(',')]:
+            best = {}
+            for _ in range(args.repeat):
+                wall, spans = compile_once(args, source, threads, scratch)
+                spans['wall'] = wall
+                for name, ms in spans.items():
+                    best[name] = min(best.get(name, ms), ms)
+
+            types = printed_types(args, source, threads, scratch)
+            if serial_types is None:
+                serial_types = types
+            same = types == serial_types
+            identical = identical and same
+
+            runs.append({'threads': threads, 'ms': best, 'sameTypesAsSerial': same})
+            spans = ' '.join('%s=%.1f' % (name, best.get(name, 0.0)) for name in list(SPANS) + ['types', 'wall'])
+            print('%3d threads: %s%s' % (threads, spans, '' if same else ' (--pt output differs)'), flush=True)
+
+    base = runs[0]['ms']
+    for run in runs:
+        run['speedup'] = {name: round(base[name] / ms, 2) for name, ms in run['ms'].items()
+                          if name in base and ms > 0}
+
+    results = {
+        'tipc': args.tipc,
+        'functions': args.functions,
+        'shape': args.shape,
+        'tipcArgs': args.tipc_args,
+        'runs': runs,
+    }
+    with open(args.output, 'w') as f:
+        json.dump(results, f, indent=2)
+        f.write('\n')
+    print('results written to', args.output)
+
+    for name, option in SPANS.items():
+        steps = ', '.join('%dx%.2f' % (r['threads'], r['speedup'].get(name, 0.0)) for r in runs)
+        print('%-16s (%s) speedup by threads: %s' % (name, option, steps))
+    return 0 if identical else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,60 @@
+#include "ProgramGenerator.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace llvm;
+
+static cl::OptionCategory Gencat("tipgen Options", "Options for controlling the shape of the generated program.");
+static cl::opt<int> functions("functions", cl::desc("number of functions"), cl::init(100), cl::cat(Gencat));
+static cl::opt<int> calls("calls", cl::desc("calls made by each function, the density of the call graph"),
+                          cl::init(3), cl::cat(Gencat));
+static cl::opt<int> higherOrder("higher-order",
+                                cl::desc("percentage of the calls made through function variables and apply"),
+                                cl::init(20), cl::cat(Gencat));
+static cl::opt<int> fields("fields", cl::desc("distinct field names in the program"), cl::init(8), cl::cat(Gencat));
+static cl::opt<int> recordFields("record-fields", cl::desc("fields of the record built by each function"),
+                                 cl::init(2), cl::cat(Gencat));
+static cl::opt<int> pointerDepth("pointer-depth", cl::desc("length of the chain of pointers in each function"),
+                                 cl::init(2), cl::cat(Gencat));
+static cl::opt<int> recursive("recursive",
+                              cl::desc("percentage of the functions that build a cell of recursive type"),
+                              cl::init(10), cl::cat(Gencat));
+static cl::opt<unsigned> seed("seed", cl::desc("seed for the choice of callees"), cl::init(1), cl::cat(Gencat));
+static cl::opt<std::string> outputfile("o", cl::value_desc("outputfile"),
+                                       cl::desc("write the program to <outputfile> instead of stdout"),
+                                       cl::cat(Gencat));
+
+/*! \brief tipgen driver.
+ *
+ * Writes a synthetic TIP program whose shape is given on the command line,
+ * for the compile time benchmarks.
+ */
+int main(int argc, char *argv[]) {
+  cl::HideUnrelatedOptions(Gencat);
+  cl::ParseCommandLineOptions(argc, argv, "tipgen - a generator of synthetic TIP programs\n");
+
+  ProgramGenerator::Shape shape;
+  shape.functions = functions;
+  shape.calls = calls;
+  shape.higherOrder = higherOrder;
+  shape.fields = fields;
+  shape.recordFields = recordFields;
+  shape.pointerDepth = pointerDepth;
+  shape.recursive = recursive;
+  shape.seed = seed;
+
+  if (outputfile.getValue().empty()) {
+    ProgramGenerator::generate(shape, std::cout);
+    return 0;
+  }
+
+  std::ofstream stream(outputfile);
+  if (!stream.good()) {
+    std::cerr << "tipgen: error: failed to open '" << outputfile << "' for writing\n";
+    return 1;
+  }
+  ProgramGenerator::generate(shape, stream);
+  return 0;
+}
@@ -2,7 +2,7 @@
 source_filename = "iotests/fib.tip"
 target triple = "x86_64-apple-darwin21.5.0"
 
-@_tip_ftable = internal constant [2 x i64 ()*] [i64 ()* bitcast (i64 (i64)* @fib to i64 ()*), i64 ()* @_tip_main]
+@_tip_ftable = internal constant [0 x i64 ()*] zeroinitializer
 @_tip_num_inputs = constant i64 1
 @_tip_input_array = common global [1 x i64] zeroinitializer
 
@@ -39,5 +39,8 @@ entry:
 ; Function Attrs: nounwind
 declare noalias i8* @calloc(i64, i64) #1
 
+; Function Attrs: nounwind
+declare void @free(i8*) #1
+
 attributes #0 = { nofree nosync nounwind readnone willreturn }
 attributes #1 = { nounwind }
@@ -24,44 +24,41 @@ initialize_test() {
   ((numtests++))
 }
 
-# Self contained test cases
-for i in selftests/*.tip
-do
-  base="$(basename $i .tip)"
+# Compile a self contained test case with the given tipc flags, then run it
+run_selftest() {
+  local i=$1
+  local flags=$2
+  local base="$(basename $i .tip)"
 
-  # test optimized program
   initialize_test
-  ${TIPC} $i
+  ${TIPC} ${flags} $i
   ${TIPCLANG} -w $i.bc ${RTLIB}/tip_rtlib.bc -o $base
 
   ./${base} &>/dev/null
   exit_code=${?}
   if [ ${exit_code} -ne 0 ]; then
     echo -n "Test failure for : " 
-    echo $i
+    echo "$i ${flags}"
     ./${base}
     ((numfailures++))
   else 
     rm ${base}
   fi 
   rm $i.bc
+}
 
-  # test unoptimized program
-  initialize_test
-  ${TIPC} -do $i
-  ${TIPCLANG} -w $i.bc ${RTLIB}/tip_rtlib.bc -o $base
-
-  ./${base} &>/dev/null
-  exit_code=${?}
-  if [ ${exit_code} -ne 0 ]; then
-    echo -n "Test failure for : " 
-    echo $i
-    ./${base}
-    ((numfailures++))
-  else 
-    rm ${base}
-  fi 
-  rm $i.bc
+# Self contained test cases, each compiled
+#  - optimized,
+#  - unoptimized (-do),
+#  - with unreachable functions removed (--prune),
+#  - from the inferred types (--typed-codegen),
+#  - with heap cells from the pooled allocator (--pooled-alloc).
+for i in selftests/*.tip
+do
+  for flags in "" "-do" "--prune" "--typed-codegen" "--pooled-alloc"
+  do
+    run_selftest $i "${flags}"
+  done
 done
 
 # IO related test cases
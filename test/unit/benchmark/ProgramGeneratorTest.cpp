@@ -0,0 +1,62 @@
+#include "ProgramGenerator.h"
+#include "ASTHelper.h"
+#include "SemanticAnalysis.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+namespace {
+
+std::string generate(ProgramGenerator::Shape const &shape) {
+    std::stringstream program;
+    ProgramGenerator::generate(shape, program);
+    return program.str();
+}
+
+}
+
+TEST_CASE("ProgramGenerator: generated programs are type correct", "[ProgramGenerator]") {
+    ProgramGenerator::Shape defaults;
+    ProgramGenerator::Shape higherOrder;
+    higherOrder.higherOrder = 100;
+    higherOrder.calls = 6;
+    ProgramGenerator::Shape flat;
+    flat.pointerDepth = 0;
+    flat.fields = 0;
+    flat.recursive = 0;
+    ProgramGenerator::Shape deep;
+    deep.pointerDepth = 5;
+    deep.recordFields = 8;
+    deep.recursive = 100;
+
+    for (auto &shape : {defaults, higherOrder, flat, deep}) {
+        std::stringstream stream(generate(shape));
+        auto ast = ASTHelper::build_ast(stream);
+        REQUIRE(ast->getFunctions().size() == static_cast<std::size_t>(shape.functions + 2));
+        REQUIRE_NOTHROW(SemanticAnalysis::analyze(ast.get()));
+    }
+}
+
+TEST_CASE("ProgramGenerator: recursive cells have mu types", "[ProgramGenerator]") {
+    ProgramGenerator::Shape shape;
+    shape.functions = 2;
+    shape.recursive = 100;
+
+    std::stringstream stream(generate(shape));
+    auto ast = ASTHelper::build_ast(stream);
+    auto analysis = SemanticAnalysis::analyze(ast.get());
+    std::stringstream types;
+    analysis->getTypeResults()->print(types);
+    REQUIRE(types.str().find("μ") != std::string::npos);
+}
+
+TEST_CASE("ProgramGenerator: the shape determines the program", "[ProgramGenerator]") {
+    ProgramGenerator::Shape shape;
+    shape.functions = 50;
+    REQUIRE(generate(shape) == generate(shape));
+
+    ProgramGenerator::Shape reseeded = shape;
+    reseeded.seed = 2;
+    REQUIRE(generate(shape) != generate(reseeded));
+}
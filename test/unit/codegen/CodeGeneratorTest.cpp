@@ -0,0 +1,227 @@
+#include "ASTHelper.h"
+#include "CodeGenerator.h"
+#include "SemanticAnalysis.h"
+
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+namespace {
+
+std::string print(llvm::Module *module) {
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  module->print(os, nullptr);
+  return os.str();
+}
+
+std::unique_ptr<llvm::Module> generate(std::string const &program, bool typed, bool promoteCalls = false,
+                                       bool pooled = false) {
+  std::stringstream stream(program);
+  auto ast = ASTHelper::build_ast(stream);
+  auto analysis = SemanticAnalysis::analyze(ast.get());
+  return CodeGenerator::generate(ast.get(), analysis.get(), "test", typed, promoteCalls, pooled);
+}
+
+int countOf(std::string const &text, std::string const &pattern) {
+  int count = 0;
+  for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+
+}
+
+TEST_CASE("CodeGenerator: typed code represents references and records by pointers", "[CodeGenerator]") {
+  std::string program = R"(
+      foo(p) { var r; r = {f: *p, g: p}; return *(r.g) + r.f; }
+      main() { var x; x = 1; return foo(&x); }
+    )";
+
+  auto untyped = generate(program, false);
+  REQUIRE(untyped->getFunction("foo")->getArg(0)->getType()->isIntegerTy(64));
+  REQUIRE(print(untyped.get()).find("inttoptr") != std::string::npos);
+
+  auto typed = generate(program, true);
+  REQUIRE_FALSE(llvm::verifyModule(*typed, &llvm::errs()));
+  REQUIRE(typed->getFunction("foo")->getArg(0)->getType()->isPointerTy());
+  auto text = print(typed.get());
+  REQUIRE(text.find("inttoptr") == std::string::npos);
+  REQUIRE(text.find("ptrtoint") == std::string::npos);
+  // the record has just the fields it defines
+  REQUIRE(text.find("alloca { i64, i64* }") != std::string::npos);
+}
+
+TEST_CASE("CodeGenerator: typed code calls function values through function pointers", "[CodeGenerator]") {
+  std::string program = R"(
+      apply(f, x) { return f(x); }
+      inc(x) { return x + 1; }
+      main() { return apply(inc, 1); }
+    )";
+
+  auto untyped = generate(program, false);
+  REQUIRE(untyped->getGlobalVariable("_tip_ftable", true) != nullptr);
+
+  auto typed = generate(program, true);
+  REQUIRE_FALSE(llvm::verifyModule(*typed, &llvm::errs()));
+  REQUIRE(typed->getGlobalVariable("_tip_ftable", true) == nullptr);
+  auto *f = typed->getFunction("apply")->getArg(0)->getType();
+  REQUIRE(f->isPointerTy());
+  REQUIRE(f->getPointerElementType()->isFunctionTy());
+}
+
+TEST_CASE("CodeGenerator: typed code calls function values with the type they are defined with", "[CodeGenerator]") {
+  // f is defined with a parameter of type μα.(α) -> int, and called through g unrolled once
+  std::string program = R"(
+      f(h) { return 0; }
+      k(p) { return *p; }
+      main() { var g, x; g = f; x = 1; return g(g) + k(&x); }
+    )";
+
+  auto typed = generate(program, true);
+  REQUIRE_FALSE(llvm::verifyModule(*typed, &llvm::errs()));
+  auto text = print(typed.get());
+  REQUIRE(text.find("define internal i64 @f(i64 %h)") != std::string::npos);
+  REQUIRE(text.find("store i64 (i64)* @f,") != std::string::npos);
+  REQUIRE(text.find("bitcast (i64") == std::string::npos);
+  // k is only called by name, so it keeps the representation of its parameter
+  REQUIRE(typed->getFunction("k")->getArg(0)->getType()->isPointerTy());
+}
+
+TEST_CASE("CodeGenerator: typed code represents recursive records by named structures", "[CodeGenerator]") {
+  std::string program = R"(
+      main() {
+        var l;
+        l = alloc {val: 1, next: null};
+        (*l).next = l;
+        return (*(*l).next).val;
+      }
+    )";
+
+  auto typed = generate(program, true);
+  REQUIRE_FALSE(llvm::verifyModule(*typed, &llvm::errs()));
+  auto structs = typed->getIdentifiedStructTypes();
+  REQUIRE(structs.size() == 1);
+
+  // the next field is a reference to a record of the same type
+  auto *record = structs[0];
+  bool recursive = false;
+  for (auto *field : record->elements()) {
+    if (field->isPointerTy() && field->getPointerElementType()->isPointerTy()) {
+      recursive = field->getPointerElementType()->getPointerElementType() == record;
+    }
+  }
+  REQUIRE(recursive);
+}
+
+TEST_CASE("CodeGenerator: records are laid out by their types", "[CodeGenerator]") {
+  std::string program = R"(
+      main() {
+        var p, q;
+        p = alloc {a: 1, b: 2};
+        q = {c: 3};
+        return (*p).b + q.c + (*null).d;
+      }
+    )";
+
+  auto untyped = generate(program, false);
+  REQUIRE_FALSE(llvm::verifyModule(*untyped, &llvm::errs()));
+  auto text = print(untyped.get());
+  REQUIRE(text.find("call i8* @calloc(i64 1, i64 16)") != std::string::npos);
+  REQUIRE(text.find("alloca { i64 }") != std::string::npos);
+  REQUIRE(text.find("getelementptr inbounds { i64, i64 }, { i64, i64 }* %") != std::string::npos);
+  // the type of the record null points to is not known, so it is accessed as an UberRecord
+  REQUIRE(text.find("getelementptr inbounds %uberRecord") != std::string::npos);
+}
+
+TEST_CASE("CodeGenerator: named functions are called directly", "[CodeGenerator]") {
+  std::string program = R"(
+      apply(f, x) { return f(x); }
+      inc(x) { return x + 1; }
+      main() { return apply(inc, 1) + inc(2); }
+    )";
+
+  auto module = generate(program, false);
+  REQUIRE_FALSE(llvm::verifyModule(*module, &llvm::errs()));
+  auto text = print(module.get());
+  REQUIRE(text.find("call i64 @apply(i64 0, i64 1)") != std::string::npos);
+  REQUIRE(text.find("call i64 @inc(i64 2)") != std::string::npos);
+
+  // only inc is used as a value, so it is the only function in the table
+  auto *table = module->getGlobalVariable("_tip_ftable", true);
+  REQUIRE(table != nullptr);
+  REQUIRE(table->getValueType()->getArrayNumElements() == 1);
+}
+
+TEST_CASE("CodeGenerator: main is called directly whatever its parameters", "[CodeGenerator]") {
+  std::string program = R"(
+      main(n) {
+        var r;
+        if (n == 0) { r = 0; } else { r = main(n - 1); }
+        return r;
+      }
+    )";
+
+  for (bool typed : {false, true}) {
+    auto module = generate(program, typed);
+    REQUIRE_FALSE(llvm::verifyModule(*module, &llvm::errs()));
+    auto text = print(module.get());
+    REQUIRE(text.find("call i64 @_tip_main()") != std::string::npos);
+    REQUIRE(text.find("_tip_ftable, i64 0, i64 -1") == std::string::npos);
+  }
+}
+
+TEST_CASE("CodeGenerator: calls of function values test for their possible callees", "[CodeGenerator]") {
+  std::string program = R"(
+      inc(x) { return x + 1; }
+      dec(x) { return x - 1; }
+      apply(f, x) { return f(x); }
+      main() { return apply(inc, 1) + apply(dec, 2); }
+    )";
+
+  auto module = generate(program, false);
+  auto text = print(module.get());
+  REQUIRE(text.find("istarget") == std::string::npos);
+
+  for (bool typed : {false, true}) {
+    auto promoted = generate(program, typed, true);
+    REQUIRE_FALSE(llvm::verifyModule(*promoted, &llvm::errs()));
+    text = print(promoted.get());
+
+    // f is tested for inc and dec, then called indirectly if it is neither
+    REQUIRE(countOf(text, "br i1 %istarget") == 2);
+    REQUIRE(text.find("call i64 @inc(i64 %x") != std::string::npos);
+    REQUIRE(text.find("call i64 @dec(i64 %x") != std::string::npos);
+    REQUIRE(text.find("phi i64") != std::string::npos);
+  }
+}
+
+TEST_CASE("CodeGenerator: pooled cells are zeroed only when they are not initialized", "[CodeGenerator]") {
+  std::string program = R"(
+      main() {
+        var p, r, q;
+        p = alloc 1;
+        r = alloc {f: 1};
+        q = {f: 2, g: 3};
+        free p;
+        return (*r).f + q.g;
+      }
+    )";
+
+  auto untyped = generate(program, false, false, true);
+  REQUIRE_FALSE(llvm::verifyModule(*untyped, &llvm::errs()));
+  auto text = print(untyped.get());
+  REQUIRE(text.find("@calloc") == std::string::npos);
+  REQUIRE(text.find("call void @_tip_free(") != std::string::npos);
+  // the cells of p and r and the record of r, which has just its one field, are initialized
+  REQUIRE(countOf(text, "call i8* @_tip_alloc(i64 8)") == 3);
+  REQUIRE(text.find("@_tip_alloc_zeroed(i64 ") == std::string::npos);
+
+  auto typed = generate(program, true, false, true);
+  REQUIRE_FALSE(llvm::verifyModule(*typed, &llvm::errs()));
+  REQUIRE(print(typed.get()).find("@_tip_alloc_zeroed(i64 ") == std::string::npos);
+}
@@ -0,0 +1,47 @@
+#include "ASTHelper.h"
+#include "EscapingFunctions.h"
+#include "SymbolTable.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+namespace {
+
+std::vector<bool> escapes(std::string const &program) {
+  std::stringstream stream(program);
+  auto ast = ASTHelper::build_ast(stream);
+  auto symbols = SymbolTable::build(ast.get());
+  return EscapingFunctions::build(ast.get());
+}
+
+}
+
+TEST_CASE("EscapingFunctions: functions only called by name do not escape", "[EscapingFunctions]") {
+  auto result = escapes(R"(
+      fib(n) { var r; if (n > 1) r = fib(n - 1) + fib(n - 2); else r = 1; return r; }
+      main() { return fib(10); }
+    )");
+  REQUIRE(result == std::vector<bool>{false, false});
+}
+
+TEST_CASE("EscapingFunctions: functions used as values escape", "[EscapingFunctions]") {
+  auto result = escapes(R"(
+      inc(x) { return x + 1; }
+      dec(x) { return x - 1; }
+      twice(f, x) { return f(f(x)); }
+      pick(b) { var g; g = dec; return g; }
+      main() { return twice(inc, pick(1)(2)); }
+    )");
+  // inc is an argument and dec is assigned, twice and pick are only called
+  REQUIRE(result == std::vector<bool>{true, true, false, false, false});
+}
+
+TEST_CASE("EscapingFunctions: a function passed to itself escapes", "[EscapingFunctions]") {
+  auto result = escapes(R"(
+      apply(f, x) { return f(x); }
+      main() { var h; h = 3; return apply(apply, h); }
+    )");
+  // apply is passed to itself, the local h is not a function
+  REQUIRE(result == std::vector<bool>{true, false});
+}
@@ -0,0 +1,120 @@
+#include "PhaseScheduler.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+void pause(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+}
+
+TEST_CASE("PhaseScheduler: one thread runs the phases in order", "[PhaseScheduler]") {
+    PhaseScheduler phases;
+    std::string trace;
+    int a = phases.add("a", [&](std::ostream &out) { trace += "a"; out << "1"; });
+    phases.add("b", [&](std::ostream &out) { trace += "b"; out << "2"; });
+    phases.add("c", [&](std::ostream &out) { trace += "c"; out << "3"; }, {a});
+
+    std::stringstream out;
+    phases.run(1, out);
+    REQUIRE(trace == "abc");
+    REQUIRE(out.str() == "123");
+}
+
+TEST_CASE("PhaseScheduler: output is in phase order", "[PhaseScheduler]") {
+    PhaseScheduler phases;
+    phases.add("slow", [](std::ostream &out) { pause(50); out << "slow "; });
+    phases.add("fast", [](std::ostream &out) { out << "fast "; });
+    phases.add("last", [](std::ostream &out) { out << "last"; });
+
+    std::stringstream out;
+    phases.run(3, out);
+    REQUIRE(out.str() == "slow fast last");
+}
+
+TEST_CASE("PhaseScheduler: dependences are respected and independent phases overlap", "[PhaseScheduler]") {
+    PhaseScheduler phases;
+    std::atomic<int> finished(0);
+    int first = phases.add("first", [&](std::ostream &) { pause(30); finished++; });
+    int second = phases.add("second", [&](std::ostream &) { pause(30); finished++; });
+    std::atomic<int> seen(-1);
+    phases.add("join", [&](std::ostream &) { seen = finished.load(); }, {first, second});
+
+    std::stringstream out;
+    phases.run(2, out);
+    REQUIRE(seen == 2);
+    REQUIRE(phases.getTotal() >= 60);
+    REQUIRE(phases.getCriticalPath() < phases.getTotal());
+    REQUIRE(phases.getElapsed() < phases.getTotal());
+
+    std::stringstream report;
+    phases.report(report);
+    REQUIRE(report.str().find("join") != std::string::npos);
+    REQUIRE(report.str().find("saving") != std::string::npos);
+
+    auto records = phases.getRecords();
+    REQUIRE(records.size() == 3);
+    REQUIRE(records[2].name == "join");
+    REQUIRE(records[2].start >= 30);
+    REQUIRE(records[2].cumulativePeakRSS > 0);
+    REQUIRE(records[2].peakRSSGrowth >= 0);
+}
+
+TEST_CASE("PhaseScheduler: errors stop later phases", "[PhaseScheduler]") {
+    PhaseScheduler phases;
+    bool ranDependent = false;
+    phases.add("ok", [](std::ostream &out) { out << "ok"; });
+    int failing = phases.add("fails", [](std::ostream &out) {
+        out << "partial";
+        throw std::runtime_error("failed");
+    });
+    phases.add("dependent", [&](std::ostream &) { ranDependent = true; }, {failing});
+
+    for (unsigned threads : {1u, 4u}) {
+        std::stringstream out;
+        REQUIRE_THROWS_AS(phases.run(threads, out), std::runtime_error);
+        REQUIRE(out.str() == "ok");
+        REQUIRE_FALSE(ranDependent);
+    }
+}
+
+TEST_CASE("PhaseScheduler: the first phase to fail is reported", "[PhaseScheduler]") {
+    PhaseScheduler phases;
+    phases.add("early", [](std::ostream &) { pause(30); throw std::logic_error("early"); });
+    phases.add("late", [](std::ostream &) { throw std::runtime_error("late"); });
+
+    std::stringstream out;
+    REQUIRE_THROWS_AS(phases.run(2, out), std::logic_error);
+}
+
+TEST_CASE("PhaseScheduler: phases on workers are spans of the time trace", "[PhaseScheduler]") {
+    PhaseScheduler phases;
+    phases.setTimeTraceGranularity(0);
+    int first = phases.add("first", [](std::ostream &) { pause(5); });
+    phases.add("left", [](std::ostream &) { pause(20); }, {first});
+    phases.add("right", [](std::ostream &) { pause(20); }, {first});
+
+    llvm::timeTraceProfilerInitialize(0, "tipc");
+    std::stringstream out;
+    phases.run(2, out);
+    llvm::SmallString<1024> trace;
+    llvm::raw_svector_ostream traceStream(trace);
+    llvm::timeTraceProfilerWrite(traceStream);
+    llvm::timeTraceProfilerCleanup();
+
+    std::string json(trace.str());
+    REQUIRE(json.find("\"detail\":\"first\"") != std::string::npos);
+    REQUIRE(json.find("\"detail\":\"left\"") != std::string::npos);
+    REQUIRE(json.find("\"detail\":\"right\"") != std::string::npos);
+}
@@ -0,0 +1,59 @@
+#include "Statistics.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+TEST_CASE("Statistics: sections are reported in order of their names", "[Statistics]") {
+    Statistics stats;
+    stats.set("types", "constraints", 12);
+    stats.set("ast", "nodes", 40);
+    stats.set("ast", "functions", 2);
+
+    std::stringstream out;
+    stats.print(out);
+    std::string expected = "{\n"
+                           "  \"ast\": {\n"
+                           "    \"functions\": 2,\n"
+                           "    \"nodes\": 40\n"
+                           "  },\n"
+                           "  \"types\": {\n"
+                           "    \"constraints\": 12\n"
+                           "  }\n"
+                           "}\n";
+    REQUIRE(out.str() == expected);
+}
+
+TEST_CASE("Statistics: tables have a row per name", "[Statistics]") {
+    Statistics stats;
+    stats.set("functions", "main", "instructions", 10);
+    stats.set("functions", "f", "instructions", 4);
+    stats.set("functions", "main", "instructions", 7);
+    stats.set("phases", "parse \"x\"", "timeMs", 1.25);
+
+    std::stringstream out;
+    stats.print(out);
+    std::string expected = "{\n"
+                           "  \"functions\": {\n"
+                           "    \"f\": {\n"
+                           "      \"instructions\": 4\n"
+                           "    },\n"
+                           "    \"main\": {\n"
+                           "      \"instructions\": 7\n"
+                           "    }\n"
+                           "  },\n"
+                           "  \"phases\": {\n"
+                           "    \"parse \\\"x\\\"\": {\n"
+                           "      \"timeMs\": 1.250\n"
+                           "    }\n"
+                           "  }\n"
+                           "}\n";
+    REQUIRE(out.str() == expected);
+}
+
+TEST_CASE("Statistics: no counters is an empty object", "[Statistics]") {
+    Statistics stats;
+    std::stringstream out;
+    stats.print(out);
+    REQUIRE(out.str() == "{\n}\n");
+}
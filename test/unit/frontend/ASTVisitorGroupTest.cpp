@@ -0,0 +1,132 @@
+#include "ASTHelper.h"
+#include "ASTVisitorGroup.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Records the functions, declarations and numbers it is shown
+class TraceVisitor : public ASTVisitor {
+public:
+  std::string name;
+  bool skipFunctions;
+  std::vector<std::string> &trace;
+  int programs = 0;
+
+  TraceVisitor(std::string name, bool skipFunctions, std::vector<std::string> &trace)
+      : name(name), skipFunctions(skipFunctions), trace(trace) {}
+
+  bool visit(ASTProgram * element) override {
+    programs++;
+    return true;
+  }
+  bool visit(ASTFunction * element) override {
+    trace.push_back(name + " visit " + element->getName());
+    return !skipFunctions;
+  }
+  void endVisit(ASTFunction * element) override {
+    trace.push_back(name + " endVisit " + element->getName());
+  }
+  void endVisit(ASTDeclNode * element) override {
+    trace.push_back(name + " decl " + element->getName());
+  }
+  void endVisit(ASTNumberExpr * element) override {
+    trace.push_back(name + " number " + std::to_string(element->getValue()));
+  }
+};
+
+}
+
+TEST_CASE("ASTVisitorGroup: members see each node in order", "[ASTVisitorGroup]") {
+  std::stringstream stream;
+  stream << R"(
+      main() {
+        var x;
+        return 5;
+      }
+    )";
+  auto ast = ASTHelper::build_ast(stream);
+
+  std::vector<std::string> trace;
+  TraceVisitor a("a", false, trace);
+  TraceVisitor b("b", false, trace);
+  ASTVisitorGroup group({&a, &b});
+  ast->accept(&group);
+
+  std::vector<std::string> expected = {
+      "a visit main", "b visit main",
+      "a decl main", "b decl main",
+      "a decl x", "b decl x",
+      "a number 5", "b number 5",
+      "a endVisit main", "b endVisit main",
+  };
+  REQUIRE(trace == expected);
+  REQUIRE(a.programs == 1);
+  REQUIRE(b.programs == 1);
+}
+
+TEST_CASE("ASTVisitorGroup: members that decline a node skip its children", "[ASTVisitorGroup]") {
+  std::stringstream stream;
+  stream << R"(
+      foo() {
+        return 1;
+      }
+      main() {
+        return 2;
+      }
+    )";
+  auto ast = ASTHelper::build_ast(stream);
+
+  std::vector<std::string> grouped;
+  TraceVisitor shallow("s", true, grouped);
+  TraceVisitor deep("d", false, grouped);
+  ASTVisitorGroup group({&shallow, &deep});
+  ast->accept(&group);
+
+  // Each member sees exactly what it would see on its own
+  std::vector<std::string> alone;
+  TraceVisitor shallowAlone("s", true, alone);
+  ast->accept(&shallowAlone);
+  TraceVisitor deepAlone("d", false, alone);
+  ast->accept(&deepAlone);
+
+  std::vector<std::string> shallowTrace, deepTrace, shallowAloneTrace, deepAloneTrace;
+  for (auto &t : grouped) {
+    (t[0] == 's' ? shallowTrace : deepTrace).push_back(t);
+  }
+  for (auto &t : alone) {
+    (t[0] == 's' ? shallowAloneTrace : deepAloneTrace).push_back(t);
+  }
+  REQUIRE(shallowTrace == shallowAloneTrace);
+  REQUIRE(deepTrace == deepAloneTrace);
+
+  std::vector<std::string> expectedShallow = {
+      "s visit foo", "s endVisit foo", "s visit main", "s endVisit main",
+  };
+  REQUIRE(shallowTrace == expectedShallow);
+}
+
+TEST_CASE("ASTVisitorGroup: children are skipped when all members decline", "[ASTVisitorGroup]") {
+  std::stringstream stream;
+  stream << R"(
+      main() {
+        return 2;
+      }
+    )";
+  auto ast = ASTHelper::build_ast(stream);
+
+  std::vector<std::string> trace;
+  TraceVisitor a("a", true, trace);
+  TraceVisitor b("b", true, trace);
+  ASTVisitorGroup group({&a, &b});
+  ast->accept(&group);
+
+  std::vector<std::string> expected = {
+      "a visit main", "b visit main", "a endVisit main", "b endVisit main",
+  };
+  REQUIRE(trace == expected);
+}
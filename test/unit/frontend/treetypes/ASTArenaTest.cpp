@@ -0,0 +1,176 @@
+#include "AST.h"
+#include "ASTArena.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+
+TEST_CASE("ASTArena: nodes are allocated from the active arena", "[ASTArena]") {
+  auto arena = std::make_shared<ASTArena>();
+  REQUIRE(arena->bytesAllocated() == 0);
+
+  std::unique_ptr<ASTExpr> expr;
+  {
+    ASTArena::Scope scope(arena.get());
+    REQUIRE(ASTArena::active() == arena.get());
+    expr = std::make_unique<ASTBinaryExpr>("+", std::make_unique<ASTNumberExpr>(1),
+                                           std::make_unique<ASTVariableExpr>("x"));
+  }
+  REQUIRE(ASTArena::active() == nullptr);
+  REQUIRE(arena->bytesAllocated() >= sizeof(ASTBinaryExpr) + sizeof(ASTNumberExpr) + sizeof(ASTVariableExpr));
+  REQUIRE(arena->numBlocks() == 1);
+
+  // Nodes allocated outside of a scope come from the heap
+  auto allocated = arena->bytesAllocated();
+  auto heapExpr = std::make_unique<ASTNumberExpr>(2);
+  REQUIRE(arena->bytesAllocated() == allocated);
+
+  // Destroying arena nodes runs their destructors and leaves the arena intact
+  expr.reset();
+  REQUIRE(arena->bytesAllocated() == allocated);
+}
+
+TEST_CASE("ASTArena: nodes are told apart by their address", "[ASTArena]") {
+  std::unique_ptr<ASTExpr> heapExpr = std::make_unique<ASTNumberExpr>(1);
+  REQUIRE_FALSE(ASTArena::holds(heapExpr.get()));
+
+  std::unique_ptr<ASTExpr> arenaExpr;
+  {
+    auto arena = std::make_unique<ASTArena>();
+    ASTArena::Scope scope(arena.get());
+    arenaExpr = std::make_unique<ASTNumberExpr>(2);
+    REQUIRE(ASTArena::holds(arenaExpr.get()));
+    arenaExpr.reset();
+  }
+  REQUIRE_FALSE(ASTArena::holds(heapExpr.get()));
+}
+
+namespace {
+
+struct ThrowingExpr : public ASTExpr {
+  ThrowingExpr() { throw std::runtime_error("not constructed"); }
+  void accept(ASTVisitor *visitor) override {}
+  llvm::Value *codegen() override { return nullptr; }
+  std::ostream &print(std::ostream &out) const override { return out; }
+};
+
+}
+
+// The memory of a node whose constructor throws is released by where it came from
+TEST_CASE("ASTArena: failed constructions release their memory", "[ASTArena]") {
+  REQUIRE_THROWS(new ThrowingExpr());
+
+  ASTArena arena;
+  ASTArena::Scope scope(&arena);
+  REQUIRE_THROWS(new ThrowingExpr());
+  REQUIRE(arena.bytesAllocated() >= sizeof(ThrowingExpr));
+  auto expr = std::make_unique<ASTNumberExpr>(1);
+  REQUIRE(ASTArena::holds(expr.get()));
+}
+
+TEST_CASE("ASTArena: scopes nest", "[ASTArena]") {
+  ASTArena outer, inner;
+  ASTArena::Scope outerScope(&outer);
+  {
+    ASTArena::Scope innerScope(&inner);
+    REQUIRE(ASTArena::active() == &inner);
+    {
+      ASTArena::Scope heapScope(nullptr);
+      REQUIRE(ASTArena::active() == nullptr);
+    }
+    REQUIRE(ASTArena::active() == &inner);
+  }
+  REQUIRE(ASTArena::active() == &outer);
+}
+
+TEST_CASE("ASTArena: large nodes get their own block", "[ASTArena]") {
+  ASTArena arena;
+  arena.allocate(16);
+  arena.allocate(1024 * 1024);
+  REQUIRE(arena.numBlocks() == 2);
+  REQUIRE(arena.bytesAllocated() >= 1024 * 1024 + 16);
+}
+
+TEST_CASE("ASTArena: allocations are aligned as requested", "[ASTArena]") {
+  ASTArena arena;
+  auto first = static_cast<char *>(arena.allocate(8, 8));
+  auto second = static_cast<char *>(arena.allocate(8, 8));
+  REQUIRE(second == first + 8);
+  auto third = static_cast<char *>(arena.allocate(8));
+  REQUIRE(reinterpret_cast<std::uintptr_t>(third) % alignof(std::max_align_t) == 0);
+  REQUIRE(third == first + 16);
+}
+
+TEST_CASE("ASTArena: a program owns the arena of its functions", "[ASTArena]") {
+  auto arena = std::make_shared<ASTArena>();
+  std::vector<std::unique_ptr<ASTFunction>> functions;
+  {
+    ASTArena::Scope scope(arena.get());
+    std::vector<std::unique_ptr<ASTStmt>> body;
+    body.push_back(std::make_unique<ASTReturnStmt>(std::make_unique<ASTNumberExpr>(0)));
+    functions.push_back(std::make_unique<ASTFunction>(std::make_unique<ASTDeclNode>("main"),
+                                                      std::vector<std::unique_ptr<ASTDeclNode>>(),
+                                                      std::vector<std::unique_ptr<ASTDeclStmt>>(),
+                                                      std::move(body)));
+  }
+  auto program = std::make_unique<ASTProgram>(std::move(functions));
+  program->setArena(arena);
+  std::weak_ptr<ASTArena> weakArena = arena;
+  arena.reset();
+
+  REQUIRE(program->getArena() != nullptr);
+  REQUIRE(program->getFunctions().front()->getName() == "main");
+
+  program.reset();
+  REQUIRE(weakArena.expired());
+}
+
+namespace {
+
+std::unique_ptr<ASTFunction> makeFunction(std::string const &name) {
+  std::vector<std::unique_ptr<ASTDeclNode>> formals;
+  formals.push_back(std::make_unique<ASTDeclNode>("x"));
+  std::vector<std::unique_ptr<ASTStmt>> body;
+  body.push_back(std::make_unique<ASTIfStmt>(std::make_unique<ASTVariableExpr>("x"),
+                                             std::make_unique<ASTOutputStmt>(std::make_unique<ASTNumberExpr>(1)),
+                                             nullptr));
+  body.push_back(std::make_unique<ASTReturnStmt>(std::make_unique<ASTVariableExpr>("x")));
+  return std::make_unique<ASTFunction>(std::make_unique<ASTDeclNode>(name), std::move(formals),
+                                       std::vector<std::unique_ptr<ASTDeclStmt>>(), std::move(body));
+}
+
+// Check that children() lists the nodes of getChildren in every node of a tree
+void requireSameChildren(ASTNode *node) {
+  auto children = node->children();
+  auto shared = node->getChildren();
+  REQUIRE(children.size() == shared.size());
+  for (std::size_t i = 0; i < shared.size(); i++) {
+    REQUIRE(children[i] == shared[i].get());
+    requireSameChildren(children[i]);
+  }
+}
+
+}
+
+TEST_CASE("ASTArena: children are listed in place for arena and heap nodes", "[ASTArena]") {
+  auto arena = std::make_shared<ASTArena>();
+  std::vector<std::unique_ptr<ASTFunction>> functions;
+  {
+    ASTArena::Scope scope(arena.get());
+    functions.push_back(makeFunction("f"));
+  }
+  functions.push_back(makeFunction("main"));
+  auto program = std::make_unique<ASTProgram>(std::move(functions));
+  program->setArena(arena);
+
+  requireSameChildren(program.get());
+  REQUIRE(program->getNumNodes() == 19);
+
+  // The list of the program follows the functions that are retained
+  auto main = program->findFunctionByName("main");
+  REQUIRE(program->retainFunctions({main}) == 1);
+  REQUIRE(program->children().size() == 1);
+  REQUIRE(program->children().front() == main);
+  requireSameChildren(program.get());
+}
@@ -39,3 +39,14 @@ TEST_CASE("ASTProgramTest: ASTProgram returns nullptr when getting nonexistent f
   ASTFunction * actualFunction = ast->findFunctionByName("fred");
   REQUIRE(expectedFunction == actualFunction);
 }
+
+TEST_CASE("ASTProgramTest: ASTProgram counts its nodes", "[ASTProgram]") {
+  std::stringstream stream;
+  stream << R"(
+      foo(x) { return x; }
+    )";
+
+  auto ast = ASTHelper::build_ast(stream);
+  // The program, the function, its name, the formal, the return and the variable
+  REQUIRE(ast->getNumNodes() == 6);
+}
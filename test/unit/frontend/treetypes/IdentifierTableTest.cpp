@@ -0,0 +1,30 @@
+#include "AST.h"
+#include "IdentifierTable.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("IdentifierTable: names are interned once", "[IdentifierTable]") {
+  auto before = IdentifierTable::size();
+  auto first = IdentifierTable::intern("identifierTableTestName");
+  auto second = IdentifierTable::intern("identifierTableTestName");
+  auto other = IdentifierTable::intern("identifierTableTestOther");
+
+  REQUIRE(first == second);
+  REQUIRE(first != other);
+  REQUIRE(IdentifierTable::size() == before + 2);
+  REQUIRE(IdentifierTable::name(first) == "identifierTableTestName");
+  REQUIRE(IdentifierTable::name(other) == "identifierTableTestOther");
+}
+
+TEST_CASE("IdentifierTable: nodes share ids for equal names", "[IdentifierTable]") {
+  ASTDeclNode decl("x");
+  ASTVariableExpr var("x");
+  ASTVariableExpr otherVar("y");
+  ASTAccessExpr access(std::make_unique<ASTVariableExpr>("r"), "x");
+
+  REQUIRE(decl.getId() == var.getId());
+  REQUIRE(decl.getId() != otherVar.getId());
+  REQUIRE(access.getFieldId() == decl.getId());
+  REQUIRE(var.getName() == "x");
+  REQUIRE(access.getField() == "x");
+}
@@ -0,0 +1,91 @@
+#include "ASTHelper.h"
+#include "CodeGenerator.h"
+#include "Optimizer.h"
+#include "SemanticAnalysis.h"
+
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+namespace {
+
+std::string optimize(std::string const &program, bool typed = false, bool pooled = false) {
+  std::stringstream stream(program);
+  auto ast = ASTHelper::build_ast(stream);
+  auto analysis = SemanticAnalysis::analyze(ast.get());
+  auto module = CodeGenerator::generate(ast.get(), analysis.get(), "test", typed, false, pooled);
+  Optimizer::optimize(module.get());
+  REQUIRE_FALSE(llvm::verifyModule(*module, &llvm::errs()));
+
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  module->print(os, nullptr);
+  return os.str();
+}
+
+// Calls are told from declarations by their first argument
+bool callsCalloc(std::string const &text) { return text.find("@calloc(i64 ") != std::string::npos; }
+bool callsFree(std::string const &text) { return text.find("@free(i8* ") != std::string::npos; }
+
+}
+
+TEST_CASE("HeapToStack: cells that do not escape are moved to the stack", "[HeapToStack]") {
+  std::string program = R"(
+      foo(x, y, z) { var rec; rec = alloc {l: x, m: y, n: z}; return (*rec).m; }
+      main() { var p; p = alloc 3; *p = *p + 1; return foo(1, *p, 2); }
+    )";
+
+  for (bool typed : {false, true}) {
+    auto text = optimize(program, typed);
+    REQUIRE_FALSE(callsCalloc(text));
+    REQUIRE(text.find("ret i64 %y") != std::string::npos);
+  }
+}
+
+TEST_CASE("HeapToStack: cells that are freed without being read are removed", "[HeapToStack]") {
+  auto text = optimize(R"(
+      main() { var p; p = alloc 5; free p; return 0; }
+    )");
+  REQUIRE_FALSE(callsCalloc(text));
+  REQUIRE_FALSE(callsFree(text));
+}
+
+TEST_CASE("HeapToStack: cells that escape stay on the heap", "[HeapToStack]") {
+  // Returned from the function that allocates it
+  REQUIRE(callsCalloc(optimize(R"(
+      cell(x) { return alloc x; }
+      main() { return *cell(4); }
+    )")));
+
+  // Passed to another function
+  REQUIRE(callsCalloc(optimize(R"(
+      get(p) { return *p; }
+      main() { var p; p = alloc 1; return get(p); }
+    )")));
+
+  // Kept from one iteration of a loop to the next
+  REQUIRE(callsCalloc(optimize(R"(
+      main() {
+        var i, p, q, s;
+        i = 0; s = 0; q = alloc 0;
+        while (3 > i) { p = alloc i; s = s + *q; q = p; i = i + 1; }
+        return s;
+      }
+    )")));
+}
+
+TEST_CASE("HeapToStack: cells of the pooled allocator are moved to the stack", "[HeapToStack]") {
+  std::string program = R"(
+      foo(x, y) { var rec, p; rec = alloc {l: x, m: y}; p = alloc 3; free p; return (*rec).m; }
+      main() { return foo(1, 2); }
+    )";
+
+  auto text = optimize(program, false, true);
+  REQUIRE(text.find("@_tip_alloc(i64 ") == std::string::npos);
+  REQUIRE(text.find("@_tip_alloc_zeroed(i64 ") == std::string::npos);
+  REQUIRE(text.find("@_tip_free(i8* ") == std::string::npos);
+  REQUIRE(text.find("ret i64 %y") != std::string::npos);
+}
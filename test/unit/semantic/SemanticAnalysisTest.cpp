@@ -0,0 +1,119 @@
+#include "ASTHelper.h"
+#include "SemanticAnalysis.h"
+#include "SemanticError.h"
+#include "TipInt.h"
+#include "TipRef.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+TEST_CASE("SemanticAnalysis: analyze reports type errors", "[SemanticAnalysis]") {
+    std::stringstream stream;
+    stream << R"(main() { var x; x = 1; return *x; })";
+    auto ast = ASTHelper::build_ast(stream);
+    REQUIRE_THROWS_AS(SemanticAnalysis::analyze(ast.get()), SemanticError);
+}
+
+TEST_CASE("SemanticAnalysis: types are checked on demand", "[SemanticAnalysis]") {
+    std::stringstream stream;
+    stream << R"(main() { var x; x = 1; return *x; })";
+    auto ast = ASTHelper::build_ast(stream);
+    SemanticAnalysis analysis(ast.get(), SymbolTable::build(ast.get()));
+
+    REQUIRE(analysis.getSymbolTable()->getFunction("main") != nullptr);
+    REQUIRE_THROWS_AS(analysis.checkTypes(), SemanticError);
+}
+
+TEST_CASE("SemanticAnalysis: results are computed once", "[SemanticAnalysis]") {
+    std::stringstream stream;
+    stream << R"(
+      foo(x) { return x + 1; }
+      main() { return foo(1); }
+    )";
+    auto ast = ASTHelper::build_ast(stream);
+    SemanticAnalysis analysis(ast.get(), SymbolTable::build(ast.get()));
+
+    auto types = analysis.getTypeResults();
+    REQUIRE(types == analysis.getTypeResults());
+    auto x = analysis.getSymbolTable()->getLocal("x", analysis.getSymbolTable()->getFunction("foo"));
+    REQUIRE(std::dynamic_pointer_cast<TipInt>(types->getInferredType(x)) != nullptr);
+
+    auto callGraph = analysis.getCallGraph();
+    REQUIRE(callGraph == analysis.getCallGraph());
+    REQUIRE(callGraph->existEdge("main", "foo"));
+}
+
+TEST_CASE("SemanticAnalysis: resolve leaves the types to checkTypes", "[SemanticAnalysis]") {
+    std::stringstream stream;
+    stream << R"(main() { var x; x = 1; return *x; })";
+    auto ast = ASTHelper::build_ast(stream);
+    auto analysis = SemanticAnalysis::resolve(ast.get());
+    REQUIRE_THROWS_AS(analysis->checkTypes(), SemanticError);
+
+    std::stringstream unassignable;
+    unassignable << R"(main() { var x; {f:0, g:1}.f = x; return 0; })";
+    auto other = ASTHelper::build_ast(unassignable);
+    REQUIRE_THROWS_AS(SemanticAnalysis::resolve(other.get()), SemanticError);
+}
+
+TEST_CASE("SemanticAnalysis: constraints collected by resolve are solved by checkTypes", "[SemanticAnalysis]") {
+    std::stringstream stream;
+    stream << R"(
+      deref(p) { return *p; }
+      main() { var x; x = 1; return deref(&x); }
+    )";
+    auto ast = ASTHelper::build_ast(stream);
+    auto symbols = SymbolTable::build(ast.get());
+    auto expected = TypeInference::check(ast.get(), symbols.get());
+    std::stringstream checked;
+    expected->print(checked);
+
+    auto analysis = SemanticAnalysis::resolve(ast.get());
+    analysis->checkTypes();
+    REQUIRE(analysis->getTypeResults()->getNumConstraints() == expected->getNumConstraints());
+    std::stringstream resolved;
+    analysis->getTypeResults()->print(resolved);
+    REQUIRE(resolved.str() == checked.str());
+}
+
+TEST_CASE("SemanticAnalysis: closed types are queried without unifying", "[SemanticAnalysis]") {
+    std::stringstream stream;
+    stream << R"(
+      id(x) { return x; }
+      main() { var p; p = alloc id(1); return *p; }
+    )";
+    auto ast = ASTHelper::build_ast(stream);
+    auto analysis = SemanticAnalysis::resolve(ast.get());
+    analysis->checkTypes(true);
+
+    auto types = analysis->getTypeResults();
+    auto terms = types->getNumTerms();
+    std::stringstream printed;
+    types->print(printed);
+    auto main = analysis->getSymbolTable()->getFunction("main");
+    auto p = analysis->getSymbolTable()->getLocal("p", main);
+    REQUIRE(std::dynamic_pointer_cast<TipRef>(types->getInferredType(p)) != nullptr);
+    REQUIRE(types->getNumTerms() == terms);
+}
+
+TEST_CASE("SemanticAnalysis: generating constraints on several threads prints the same types", "[SemanticAnalysis]") {
+    std::stringstream stream;
+    stream << R"(
+      id(x) { return x; }
+      copy(p) { var q; q = *p; return &q; }
+      cell(n) { var r; r = alloc {head: n, tail: null}; return r; }
+      main() { var a, b; a = copy(alloc 1); b = cell(id(3)); return *a + (*b).head; }
+    )";
+    auto ast = ASTHelper::build_ast(stream);
+
+    std::stringstream serial;
+    SemanticAnalysis::analyze(ast.get())->getTypeResults()->print(serial);
+    for (unsigned threads : {2u, 4u}) {
+        auto analysis = SemanticAnalysis::resolve(ast.get(), threads);
+        analysis->checkTypes();
+        std::stringstream parallel;
+        analysis->getTypeResults()->print(parallel);
+        REQUIRE(parallel.str() == serial.str());
+    }
+}
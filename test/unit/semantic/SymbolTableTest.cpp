@@ -8,6 +8,17 @@
 #include <iostream>
 #include <optional>
 
+namespace {
+
+// Collects the variable references in a program
+class VariableCollector : public ASTVisitor {
+public:
+  std::vector<ASTVariableExpr*> vars;
+  void endVisit(ASTVariableExpr * element) override { vars.push_back(element); }
+};
+
+}
+
 
 TEST_CASE("Symbol Table: locals", "[SymbolTable]") {
     std::stringstream stream;
@@ -185,3 +196,42 @@ TEST_CASE("Symbol Table: Unknown Function", "[SymbolTable]") {
   std::unique_ptr<SymbolTable> symbols = SymbolTable::build(ast.get());
   REQUIRE(nullptr == symbols->getFunction("foo"));
 }
+
+TEST_CASE("Symbol Table: declarations numbered functions first", "[SymbolTable]") {
+  std::stringstream stream;
+  stream << R"(foo(a) { var x; return a; } bar(b, c) { var y, z; return b; })";
+  auto ast = ASTHelper::build_ast(stream);
+  auto symbols = SymbolTable::build(ast.get());
+
+  REQUIRE(symbols->getNumDeclarations() == 8);
+  auto fs = ast->getFunctions();
+  REQUIRE(fs[0]->getDecl()->getIndex() == 0);
+  REQUIRE(fs[1]->getDecl()->getIndex() == 1);
+  for (int i = 0; i < symbols->getNumDeclarations(); i++) {
+    REQUIRE(symbols->getDeclaration(i)->getIndex() == i);
+  }
+  REQUIRE(symbols->getDeclaration(2)->getName() == "a");
+  REQUIRE(symbols->getDeclaration(7)->getName() == "z");
+}
+
+TEST_CASE("Symbol Table: variable references bound to declarations", "[SymbolTable]") {
+  std::stringstream stream;
+  stream << R"(foo(x) { return x; } bar() { var x; x = foo; return x(1); })";
+  auto ast = ASTHelper::build_ast(stream);
+  auto symbols = SymbolTable::build(ast.get());
+
+  VariableCollector collector;
+  ast->accept(&collector);
+  REQUIRE(collector.vars.size() == 4);
+
+  auto foo = ast->getFunctions()[0];
+  auto bar = ast->getFunctions()[1];
+  for (auto v : collector.vars) {
+    REQUIRE(v->getDecl() != nullptr);
+    REQUIRE(v->getDecl()->getName() == v->getName());
+    REQUIRE(v->getDeclIndex() == v->getDecl()->getIndex());
+  }
+  REQUIRE(collector.vars[0]->getDecl() == symbols->getLocal("x", foo->getDecl()));
+  REQUIRE(collector.vars[1]->getDecl() == symbols->getLocal("x", bar->getDecl()));
+  REQUIRE(collector.vars[2]->getDecl() == foo->getDecl());
+}
@@ -0,0 +1,104 @@
+#include "CFAnalyzer.h"
+#include "ASTHelper.h"
+#include "SymbolTable.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+namespace {
+
+ASTFunction* getFunction(ASTProgram* p, std::string name) {
+    for (auto f : p->getFunctions()) {
+        if (f->getName() == name) return f;
+    }
+    return nullptr; // LCOV_EXCL_LINE
+}
+
+// The first declared local of a function
+ASTDeclNode* getLocal(ASTFunction* f) {
+    return f->getDeclarations().front()->getVars().front();
+}
+
+}
+
+TEST_CASE("CFAnalyzer: direct calls flow arguments and results" "[CFAnalyzer]") {
+    std::stringstream program;
+    program << R"(
+      id(x) {
+        return x;
+      }
+      inc(x) {
+        return x + 1;
+      }
+      main() {
+        var f;
+        f = id(inc);
+        return f(1);
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+    auto cfa = CFAnalyzer::analyze(ast.get(), symTable.get());
+
+    auto main = getFunction(ast.get(), "main");
+    auto possible = cfa.getPossibleFunctionsForExpr(getLocal(main), main);
+    REQUIRE(possible.size() == 1);
+    REQUIRE(possible.front() == getFunction(ast.get(), "inc"));
+}
+
+TEST_CASE("CFAnalyzer: results of nullary functions flow to the call" "[CFAnalyzer]") {
+    std::stringstream program;
+    program << R"(
+      inc(x) {
+        return x + 1;
+      }
+      pick() {
+        return inc;
+      }
+      main() {
+        var f, g;
+        g = pick;
+        f = g();
+        return f(1);
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+    auto cfa = CFAnalyzer::analyze(ast.get(), symTable.get());
+
+    auto main = getFunction(ast.get(), "main");
+    auto possible = cfa.getPossibleFunctionsForExpr(getLocal(main), main);
+    REQUIRE(possible.size() == 1);
+    REQUIRE(possible.front() == getFunction(ast.get(), "inc"));
+}
+
+TEST_CASE("CFAnalyzer: calls through an assigned function name" "[CFAnalyzer]") {
+    std::stringstream program;
+    program << R"(
+      id(x) {
+        return x;
+      }
+      k(x) {
+        return k;
+      }
+      main() {
+        var f;
+        id = k;
+        f = id(1);
+        return f;
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+    auto cfa = CFAnalyzer::analyze(ast.get(), symTable.get());
+
+    // The call to id may reach k, which returns itself
+    auto main = getFunction(ast.get(), "main");
+    auto possible = cfa.getPossibleFunctionsForExpr(getLocal(main), main);
+    REQUIRE(possible.size() == 1);
+    REQUIRE(possible.front() == getFunction(ast.get(), "k"));
+}
@@ -1,4 +1,5 @@
 #include "CallGraph.h"
+#include "DeadFunctionEliminator.h"
 #include "ASTHelper.h"
 #include "SymbolTable.h"
 #include "SemanticAnalysis.h"
@@ -321,3 +322,184 @@ TEST_CASE("CallGraph: test print method" "[CallGraph]") {
     found = output.find("a1 -> a0;");
     REQUIRE(found!=std::string::npos);
 }
+
+TEST_CASE("CallGraph: test components and topological order" "[CallGraph]") {
+    std::stringstream program;
+    program << R"(
+      h(x) {
+        return x;
+      }
+      f(n) {
+        var r;
+        if (n > 0) { r = g(n-1); } else { r = h(n); }
+        return r;
+      }
+      g(n) {
+        return f(n);
+      }
+      main() {
+        return f(3);
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+    auto callGraph = CallGraph::build(ast.get(), symTable.get());
+
+    auto h = callGraph->getASTFun("h");
+    auto f = callGraph->getASTFun("f");
+    auto g = callGraph->getASTFun("g");
+    auto main = callGraph->getASTFun("main");
+
+    // Callees come first and mutually recursive functions share a component
+    auto components = callGraph->getComponents();
+    REQUIRE(components.size() == 3);
+    REQUIRE(components[0] == std::vector<ASTFunction*>{h});
+    std::vector<ASTFunction*> recursive{f, g};
+    REQUIRE(components[1] == recursive);
+    REQUIRE(components[2] == std::vector<ASTFunction*>{main});
+    REQUIRE(callGraph->getComponent(f) == callGraph->getComponent(g));
+
+    auto order = callGraph->getTopologicalOrder();
+    std::vector<ASTFunction*> expected{main, f, g, h};
+    REQUIRE(order == expected);
+}
+
+TEST_CASE("CallGraph: test reverse index" "[CallGraph]") {
+    std::stringstream program;
+    program << R"(
+      foo1(x) {
+        return x;
+      }
+      foo2(x) {
+        return foo1(x);
+      }
+      bar() {
+        return foo2(7) + foo1(7);
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+    auto callGraph = CallGraph::build(ast.get(), symTable.get());
+
+    auto foo1 = callGraph->getVertexIndex(callGraph->getASTFun("foo1"));
+    auto callers = callGraph->getCallerIndices(foo1);
+    std::vector<int> expected{1, 2};
+    REQUIRE(std::vector<int>(callers.begin(), callers.end()) == expected);
+    REQUIRE(callGraph->getCalleeIndices(foo1).size() == 0);
+
+    // Repeated queries do not accumulate edges
+    REQUIRE(callGraph->getEdges().size() == 3);
+    REQUIRE(callGraph->getEdges().size() == 3);
+    REQUIRE(callGraph->getASTFun("baz") == nullptr);
+}
+
+namespace {
+// Collects the function applications of a program in program order
+class CallCollector : public ASTVisitor {
+public:
+    std::vector<ASTFunAppExpr*> calls;
+    bool visit(ASTFunAppExpr* element) override {
+        calls.push_back(element);
+        return true;
+    }
+};
+}
+
+TEST_CASE("CallGraph: test call targets" "[CallGraph]") {
+    std::stringstream program;
+    program << R"(
+      inc(x) {
+        return x + 1;
+      }
+      dec(x) {
+        return x - 1;
+      }
+      apply(f, x) {
+        return f(x);
+      }
+      main() {
+        var g;
+        g = inc;
+        return apply(inc, 1) + apply(dec, 2) + g(3);
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+    auto callGraph = CallGraph::build(ast.get(), symTable.get());
+
+    CallCollector collector;
+    ast->accept(&collector);
+    REQUIRE(collector.calls.size() == 4);
+
+    auto inc = callGraph->getASTFun("inc");
+    auto dec = callGraph->getASTFun("dec");
+    auto apply = callGraph->getASTFun("apply");
+
+    // f in apply may be either function passed to it, in program order
+    std::vector<ASTFunction*> expected{inc, dec};
+    REQUIRE(callGraph->getCallTargets(collector.calls[0]) == expected);
+
+    expected = {apply};
+    REQUIRE(callGraph->getCallTargets(collector.calls[1]) == expected);
+    REQUIRE(callGraph->getCallTargets(collector.calls[2]) == expected);
+
+    expected = {inc};
+    REQUIRE(callGraph->getCallTargets(collector.calls[3]) == expected);
+
+    // Applications of another program have no known targets
+    ASTFunAppExpr other(std::make_unique<ASTVariableExpr>("inc"), {});
+    REQUIRE(callGraph->getCallTargets(&other).empty());
+
+    // Semantic analysis finds the same targets by solving the constraints on demand
+    SemanticAnalysis analysis(ast.get(), SymbolTable::build(ast.get()));
+    for (auto call : collector.calls) {
+        REQUIRE(analysis.getCallTargets(call) == callGraph->getCallTargets(call));
+    }
+}
+
+TEST_CASE("CallGraph: test components of the references between functions" "[CallGraph]") {
+    std::stringstream program;
+    program << R"(
+      main() {
+        return even(4) + apply(inc, 1);
+      }
+      apply(f, x) {
+        return f(x);
+      }
+      odd(n) {
+        var r;
+        if (n == 0) { r = 0; } else { r = even(n - 1); }
+        return r;
+      }
+      even(n) {
+        var r;
+        if (n == 0) { r = 1; } else { r = odd(n - 1); }
+        return r;
+      }
+      inc(x) {
+        return x + 1;
+      }
+      alone() {
+        return alone();
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+
+    CallGraph references(ast->getFunctions(), DeadFunctionEliminator::references(ast.get()));
+
+    std::vector<std::vector<std::string>> components;
+    for (auto &component : references.getComponents()) {
+        std::vector<std::string> names;
+        for (auto f : component) names.push_back(f->getName());
+        components.push_back(names);
+    }
+
+    // apply only calls its parameter, so it does not refer to inc
+    std::vector<std::vector<std::string>> expected{{"apply"}, {"odd", "even"}, {"inc"}, {"main"}, {"alone"}};
+    REQUIRE(components == expected);
+}
@@ -0,0 +1,111 @@
+#include "CubicSolver.h"
+#include "ASTHelper.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+namespace {
+
+// A program with n zero argument functions f0 ... f(n-1)
+std::unique_ptr<ASTProgram> functions(int n) {
+    std::stringstream program;
+    for (int i = 0; i < n; i++) {
+        program << "f" << i << "() { return " << i << "; }\n";
+    }
+    return ASTHelper::build_ast(program);
+}
+
+}
+
+TEST_CASE("CubicSolver: subset constraints propagate elements" "[CubicSolver]") {
+    auto ast = functions(3);
+    auto fs = ast->getFunctions();
+    ASTNumberExpr a(1), b(2), c(3);
+
+    CubicSolver solver(fs);
+    solver.addSubseteqConstraint(&a, &b);
+    solver.addElementofConstraint(fs[0], &a);
+    solver.addSubseteqConstraint(&b, &c);
+    solver.addElementofConstraint(fs[1], &b);
+
+    REQUIRE(solver.getPossibleFunctionsForExpr(&a).size() == 1);
+    REQUIRE(solver.getPossibleFunctionsForExpr(&b).size() == 2);
+    REQUIRE(solver.getPossibleFunctionsForExpr(&c).size() == 2);
+    REQUIRE(solver.getPossibleFunctionsForExpr(fs[2]).empty());
+}
+
+TEST_CASE("CubicSolver: cycles share a solution" "[CubicSolver]") {
+    auto ast = functions(3);
+    auto fs = ast->getFunctions();
+    ASTNumberExpr a(1), b(2), c(3), d(4);
+
+    CubicSolver solver(fs);
+    solver.addSubseteqConstraint(&a, &b);
+    solver.addSubseteqConstraint(&b, &c);
+    solver.addSubseteqConstraint(&c, &a);
+    solver.addSubseteqConstraint(&c, &d);
+    solver.addElementofConstraint(fs[0], &b);
+    solver.addElementofConstraint(fs[2], &c);
+
+    for (auto n : std::vector<ASTNode*>{&a, &b, &c, &d}) {
+        auto possible = solver.getPossibleFunctionsForExpr(n);
+        REQUIRE(possible.size() == 2);
+    }
+}
+
+TEST_CASE("CubicSolver: conditional constraints" "[CubicSolver]") {
+    auto ast = functions(2);
+    auto fs = ast->getFunctions();
+    ASTNumberExpr in(1), from(2), to(3), other(4);
+
+    CubicSolver solver(fs);
+    solver.addElementofConstraint(fs[1], &from);
+
+    // Not triggered since f0 is not in the set for in
+    solver.addConditionalConstraint(fs[0], &in, &from, &to);
+    REQUIRE(solver.getPossibleFunctionsForExpr(&to).empty());
+
+    // Triggered later through a subset constraint
+    solver.addElementofConstraint(fs[0], &other);
+    solver.addSubseteqConstraint(&other, &in);
+    REQUIRE(solver.getPossibleFunctionsForExpr(&to).size() == 1);
+    REQUIRE(solver.getPossibleFunctionsForExpr(&to).front() == fs[1]);
+
+    // Triggered immediately since f1 is already in the set for from
+    solver.addConditionalConstraint(fs[1], &from, &in, &other);
+    REQUIRE(solver.getPossibleFunctionsForExpr(&other).size() == 1);
+}
+
+TEST_CASE("CubicSolver: sets spanning several words" "[CubicSolver]") {
+    auto ast = functions(130);
+    auto fs = ast->getFunctions();
+    ASTNumberExpr a(1), b(2);
+
+    CubicSolver solver(fs);
+    solver.addSubseteqConstraint(&a, &b);
+    for (auto f : fs) {
+        solver.addElementofConstraint(f, &a);
+    }
+
+    REQUIRE(solver.getPossibleFunctionsForExpr(&b).size() == 130);
+}
+
+TEST_CASE("CubicSolver: counts the work done" "[CubicSolver]") {
+    auto ast = functions(3);
+    auto fs = ast->getFunctions();
+    ASTNumberExpr a(1), b(2), c(3), d(4);
+
+    CubicSolver solver(fs);
+    solver.addSubseteqConstraint(&a, &b);
+    solver.addSubseteqConstraint(&b, &c);
+    solver.addSubseteqConstraint(&c, &a);
+    solver.addSubseteqConstraint(&c, &d);
+    solver.addElementofConstraint(fs[0], &b);
+
+    auto stats = solver.getStats();
+    REQUIRE(stats.variables == 4);
+    // a, b and c are collapsed into one
+    REQUIRE(stats.merges == 2);
+    REQUIRE(stats.propagated > 0);
+}
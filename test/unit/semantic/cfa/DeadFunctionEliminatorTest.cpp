@@ -0,0 +1,132 @@
+#include "DeadFunctionEliminator.h"
+#include "ASTHelper.h"
+#include "SemanticAnalysis.h"
+#include "SemanticError.h"
+#include "SymbolTable.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+namespace {
+
+std::vector<std::string> names(std::vector<ASTFunction*> const &functions) {
+    std::vector<std::string> result;
+    for (auto f : functions) result.push_back(f->getName());
+    return result;
+}
+
+}
+
+TEST_CASE("DeadFunctionEliminator: keeps functions called or named by live code" "[DeadFunctionEliminator]") {
+    std::stringstream program;
+    program << R"(
+      unused(x) {
+        return x;
+      }
+      inc(x) {
+        return x + 1;
+      }
+      twice(f, x) {
+        return f(f(x));
+      }
+      named() {
+        return 0;
+      }
+      onlyFromUnused() {
+        return unused(1);
+      }
+      main() {
+        var g;
+        g = named;
+        return twice(inc, 1);
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+
+    std::vector<std::string> expected{"inc", "twice", "named", "main"};
+    REQUIRE(names(DeadFunctionEliminator::reachable(ast.get())) == expected);
+    REQUIRE(DeadFunctionEliminator::prune(ast.get()) == 2);
+    REQUIRE(names(ast->getFunctions()) == expected);
+}
+
+TEST_CASE("DeadFunctionEliminator: removes dead recursive functions" "[DeadFunctionEliminator]") {
+    std::stringstream program;
+    program << R"(
+      even(n) {
+        var r;
+        if (n == 0) { r = 1; } else { r = odd(n - 1); }
+        return r;
+      }
+      odd(n) {
+        var r;
+        if (n == 0) { r = 0; } else { r = even(n - 1); }
+        return r;
+      }
+      main() {
+        return 0;
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+
+    REQUIRE(DeadFunctionEliminator::prune(ast.get()) == 2);
+    REQUIRE(ast->findFunctionByName("even") == nullptr);
+    REQUIRE(ast->findFunctionByName("odd") == nullptr);
+}
+
+TEST_CASE("DeadFunctionEliminator: programs without main are unchanged" "[DeadFunctionEliminator]") {
+    std::stringstream program;
+    program << R"(
+      foo() {
+        return 1;
+      }
+      bar() {
+        return foo();
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+
+    REQUIRE(DeadFunctionEliminator::prune(ast.get()) == 0);
+    REQUIRE(ast->getFunctions().size() == 2);
+}
+
+TEST_CASE("DeadFunctionEliminator: type errors in dead functions are not reported" "[DeadFunctionEliminator]") {
+    std::stringstream program;
+    program << R"(
+      bad() {
+        var x;
+        x = 1;
+        return *x;
+      }
+      main() {
+        return 0;
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto analysis = SemanticAnalysis::analyze(ast.get(), 1, nullptr, true);
+
+    REQUIRE(ast->getFunctions().size() == 1);
+    REQUIRE(analysis->getCallGraph()->getTotalVertices() == 1);
+    REQUIRE(analysis->getSymbolTable()->getFunction("bad") == nullptr);
+
+    std::stringstream again;
+    again << R"(
+      bad() {
+        var x;
+        x = 1;
+        return *x;
+      }
+      main() {
+        return 0;
+      }
+    )";
+    auto full = ASTHelper::build_ast(again);
+    REQUIRE_THROWS_AS(SemanticAnalysis::analyze(full.get()), SemanticError);
+}
@@ -0,0 +1,135 @@
+#include "DemandSolver.h"
+#include "CubicSolver.h"
+#include "CFAnalyzer.h"
+#include "ASTHelper.h"
+#include "SymbolTable.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+#include <sstream>
+
+namespace {
+
+// A program with n zero argument functions f0 ... f(n-1)
+std::unique_ptr<ASTProgram> functions(int n) {
+    std::stringstream program;
+    for (int i = 0; i < n; i++) {
+        program << "f" << i << "() { return " << i << "; }\n";
+    }
+    return ASTHelper::build_ast(program);
+}
+
+}
+
+TEST_CASE("DemandSolver: solves only what a query depends on" "[DemandSolver]") {
+    auto ast = functions(2);
+    auto fs = ast->getFunctions();
+    ASTNumberExpr a(1), b(2), c(3), d(4);
+
+    DemandSolver solver(fs);
+    solver.addElementofConstraint(fs[0], &a);
+    solver.addSubseteqConstraint(&a, &b);
+    solver.addElementofConstraint(fs[1], &c);
+    solver.addSubseteqConstraint(&c, &d);
+
+    REQUIRE(solver.getPossibleFunctionsForExpr(&b) == std::vector<ASTFunction*>{fs[0]});
+    REQUIRE(solver.getNumSolved() == 2);
+    REQUIRE(solver.getPossibleFunctionsForExpr(&a) == std::vector<ASTFunction*>{fs[0]});
+    REQUIRE(solver.getNumSolved() == 2);
+    REQUIRE(solver.getPossibleFunctionsForExpr(&d) == std::vector<ASTFunction*>{fs[1]});
+    REQUIRE(solver.getNumSolved() == 4);
+
+    // New constraints discard the solutions
+    solver.addSubseteqConstraint(&d, &b);
+    REQUIRE(solver.getNumSolved() == 0);
+    REQUIRE(solver.getPossibleFunctionsForExpr(&b).size() == 2);
+}
+
+TEST_CASE("DemandSolver: conditional constraints depend on their condition" "[DemandSolver]") {
+    auto ast = functions(2);
+    auto fs = ast->getFunctions();
+    ASTNumberExpr in(1), from(2), to(3), other(4);
+
+    DemandSolver solver(fs);
+    solver.addElementofConstraint(fs[1], &from);
+    solver.addConditionalConstraint(fs[0], &in, &from, &to);
+    solver.addElementofConstraint(fs[0], &other);
+    solver.addSubseteqConstraint(&other, &in);
+
+    REQUIRE(solver.getPossibleFunctionsForExpr(&to) == std::vector<ASTFunction*>{fs[1]});
+    REQUIRE(solver.getNumSolved() == 4);
+    REQUIRE(solver.getPossibleFunctionsForExpr(fs[0]).empty());
+}
+
+TEST_CASE("DemandSolver: agrees with CubicSolver" "[DemandSolver]") {
+    auto ast = functions(70);
+    auto fs = ast->getFunctions();
+    std::vector<std::unique_ptr<ASTNumberExpr>> vars;
+    for (int i = 0; i < 40; i++) {
+        vars.push_back(std::make_unique<ASTNumberExpr>(i));
+    }
+
+    std::mt19937 random(42);
+    for (int trial = 0; trial < 20; trial++) {
+        CubicSolver exhaustive(fs);
+        DemandSolver demand(fs);
+        for (int k = 0; k < 60; k++) {
+            auto a = vars[random() % vars.size()].get();
+            auto b = vars[random() % vars.size()].get();
+            auto c = vars[random() % vars.size()].get();
+            auto f = fs[random() % fs.size()];
+            switch (random() % 3) {
+            case 0:
+                exhaustive.addElementofConstraint(f, a);
+                demand.addElementofConstraint(f, a);
+                break;
+            case 1:
+                exhaustive.addSubseteqConstraint(a, b);
+                demand.addSubseteqConstraint(a, b);
+                break;
+            default:
+                exhaustive.addConditionalConstraint(f, a, b, c);
+                demand.addConditionalConstraint(f, a, b, c);
+            }
+        }
+        for (auto &v : vars) {
+            REQUIRE(demand.getPossibleFunctionsForExpr(v.get()) == exhaustive.getPossibleFunctionsForExpr(v.get()));
+        }
+    }
+}
+
+TEST_CASE("DemandSolver: CFAnalyzer answers queries on demand" "[DemandSolver]") {
+    std::stringstream program;
+    program << R"(
+      id(x) {
+        return x;
+      }
+      inc(x) {
+        return x + 1;
+      }
+      k(x) {
+        return k;
+      }
+      main() {
+        var f, g;
+        f = id(inc);
+        id = k;
+        g = id(1);
+        return f(1) + g(2);
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symTable = SymbolTable::build(ast.get());
+    auto exhaustive = CFAnalyzer::analyze(ast.get(), symTable.get());
+    auto demand = CFAnalyzer::analyze(ast.get(), symTable.get(), true);
+    REQUIRE(exhaustive.getDemandSolver() == nullptr);
+    REQUIRE(demand.getDemandSolver()->getNumSolved() == 0);
+
+    auto main = ast->findFunctionByName("main");
+    for (auto local : symTable->getLocals(main->getDecl())) {
+        REQUIRE(demand.getPossibleFunctionsForExpr(local, main) == exhaustive.getPossibleFunctionsForExpr(local, main));
+    }
+    REQUIRE(demand.getDemandSolver()->getNumSolved() < demand.getDemandSolver()->getNumVariables());
+}
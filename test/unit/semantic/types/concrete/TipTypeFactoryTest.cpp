@@ -0,0 +1,93 @@
+#include "ASTNumberExpr.h"
+#include "TipTypeFactory.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+TEST_CASE("TipTypeFactory: Test structurally equal terms are interned", "[TipTypeFactory]") {
+    ASTNumberExpr n(42);
+
+    SECTION("Variables and alphas") {
+        REQUIRE(TipTypeFactory::var(&n) == TipTypeFactory::var(&n));
+        REQUIRE(TipTypeFactory::alpha(&n, "f") == TipTypeFactory::alpha(&n, "f"));
+        REQUIRE(TipTypeFactory::alpha(&n) != TipTypeFactory::alpha(&n, "f"));
+        REQUIRE(std::static_pointer_cast<TipType>(TipTypeFactory::var(&n)) !=
+                std::static_pointer_cast<TipType>(TipTypeFactory::alpha(&n)));
+    }
+
+    SECTION("Constructed types") {
+        auto f1 = TipTypeFactory::function({TipTypeFactory::var(&n)},
+                                           TipTypeFactory::ref(TipTypeFactory::intType()));
+        auto f2 = TipTypeFactory::function({TipTypeFactory::var(&n)},
+                                           TipTypeFactory::ref(TipTypeFactory::intType()));
+        REQUIRE(f1 == f2);
+
+        auto r1 = TipTypeFactory::record({TipTypeFactory::intType(), TipTypeFactory::absentField()}, {"f", "g"});
+        auto r2 = TipTypeFactory::record({TipTypeFactory::intType(), TipTypeFactory::absentField()}, {"f", "g"});
+        REQUIRE(r1 == r2);
+    }
+
+    SECTION("Record names are preserved") {
+        auto r1 = TipTypeFactory::record({TipTypeFactory::intType()}, {"f"});
+        auto r2 = TipTypeFactory::record({TipTypeFactory::intType()}, {"g"});
+        REQUIRE(r1 != r2);
+        REQUIRE(*r1 == *r2);
+
+        std::stringstream stream;
+        stream << *r2;
+        REQUIRE(stream.str() == "{g:int}");
+    }
+}
+
+TEST_CASE("TipTypeFactory: Test rebuilding a cons", "[TipTypeFactory]") {
+    ASTNumberExpr n(42);
+    auto alpha = TipTypeFactory::alpha(&n);
+    auto fun = TipTypeFactory::function({alpha}, alpha);
+
+    auto same = TipTypeFactory::cons(fun.get(), fun->getArguments());
+    REQUIRE(same == fun);
+
+    auto closed = TipTypeFactory::cons(fun.get(), {TipTypeFactory::intType(), TipTypeFactory::intType()});
+    std::stringstream stream;
+    stream << *closed;
+    REQUIRE(stream.str() == "(int) -> int");
+}
+
+TEST_CASE("TipTypeFactory: Test terms are released", "[TipTypeFactory]") {
+    ASTNumberExpr n(42);
+    auto before = TipTypeFactory::size();
+    {
+        auto ref = TipTypeFactory::ref(TipTypeFactory::var(&n));
+        REQUIRE(TipTypeFactory::size() == before + 2);
+    }
+    REQUIRE(TipTypeFactory::size() == before);
+}
+
+TEST_CASE("TipTypeFactory: Test terms requested on several threads are interned once", "[TipTypeFactory]") {
+    std::vector<std::unique_ptr<ASTNumberExpr>> nodes;
+    for (int i = 0; i < 64; i++) {
+        nodes.push_back(std::make_unique<ASTNumberExpr>(i));
+    }
+
+    const int threads = 4;
+    std::vector<std::vector<std::shared_ptr<TipType>>> terms(threads);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&nodes, &terms, t]() {
+            for (auto &n : nodes) {
+                terms[t].push_back(TipTypeFactory::function({TipTypeFactory::var(n.get())},
+                                                            TipTypeFactory::ref(TipTypeFactory::alpha(n.get()))));
+            }
+        });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+
+    for (int t = 1; t < threads; t++) {
+        REQUIRE(terms[t] == terms[0]);
+    }
+}
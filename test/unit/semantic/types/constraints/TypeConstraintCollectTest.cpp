@@ -1,6 +1,7 @@
 #include "TypeConstraintCollectVisitor.h"
 #include "ASTHelper.h"
 #include "SymbolTable.h"
+#include "TypeInference.h"
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -381,3 +382,33 @@ main() {
 
     runtest(program, expected);
 }
+
+TEST_CASE("TypeConstraintVisitor: parallel collection matches serial", "[TypeConstraintVisitor]") {
+    std::stringstream program;
+    program << R"(
+      id(x) { return x; }
+      deref(p) { return *p; }
+      rec(n) { var r; r = {f: n, g: alloc n}; return r.f; }
+      apply(f, x) { return f(x); }
+      main() {
+        var a, b;
+        a = 3;
+        b = &a;
+        return apply(id, deref(b)) + rec(a);
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symbols = SymbolTable::build(ast.get());
+
+    auto serial = TypeInference::collect(ast.get(), symbols.get(), 1);
+    for (unsigned threads : {2u, 3u, 8u, 0u}) {
+        auto parallel = TypeInference::collect(ast.get(), symbols.get(), threads);
+        REQUIRE(parallel.size() == serial.size());
+        for (int i = 0; i < serial.size(); i++) {
+            // Interned terms make structurally equal constraints identical objects
+            REQUIRE(parallel[i].lhs == serial[i].lhs);
+            REQUIRE(parallel[i].rhs == serial[i].rhs);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#include "ConcurrentUnionFind.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+#include <vector>
+
+TEST_CASE("ConcurrentUnionFind: Test linking roots", "[ConcurrentUnionFind]") {
+    ConcurrentUnionFind forest(4);
+    for(std::size_t id = 0; id < 4; id++) {
+        REQUIRE(forest.find(id) == id);
+        REQUIRE(forest.cons(id) == ConcurrentUnionFind::none);
+    }
+
+    std::size_t detached;
+    REQUIRE(forest.link(0, 1, detached));
+    REQUIRE(detached == ConcurrentUnionFind::none);
+    REQUIRE(forest.find(0) == forest.find(1));
+    REQUIRE(forest.find(2) != forest.find(0));
+
+    // Only roots can be linked
+    auto child = forest.find(0) == 0 ? 1 : 0;
+    REQUIRE_FALSE(forest.link(child, 2, detached));
+}
+
+TEST_CASE("ConcurrentUnionFind: Test constructors of classes", "[ConcurrentUnionFind]") {
+    ConcurrentUnionFind forest(4);
+    forest.setCons(1, 1);
+    forest.setCons(3, 3);
+
+    std::size_t detached;
+    REQUIRE(forest.link(0, 1, detached));
+    if(detached != ConcurrentUnionFind::none) {
+        REQUIRE(detached == 1);
+        REQUIRE(forest.attachCons(0, detached) == ConcurrentUnionFind::none);
+    }
+    REQUIRE(forest.cons(forest.find(0)) == 1);
+
+    // Merging two classes with constructors keeps the lower id and reports the other
+    REQUIRE(forest.link(forest.find(0), 3, detached));
+    REQUIRE(detached != ConcurrentUnionFind::none);
+    auto other = forest.attachCons(3, detached);
+    REQUIRE(((detached == 1 && other == 3) || (detached == 3 && other == 1)));
+    REQUIRE(forest.cons(forest.find(3)) == 1);
+}
+
+TEST_CASE("ConcurrentUnionFind: Test concurrent unions", "[ConcurrentUnionFind]") {
+    const std::size_t size = 10000;
+    ConcurrentUnionFind forest(size);
+
+    // Each thread links a different residue class, and the last links them all together
+    auto work = [&forest, size](std::size_t offset, std::size_t stride) {
+        for(std::size_t id = offset + stride; id < size; id += stride) {
+            while(true) {
+                auto r1 = forest.find(id - stride);
+                auto r2 = forest.find(id);
+                std::size_t detached;
+                if(r1 == r2 || forest.link(r1, r2, detached)) {
+                    break;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(std::size_t t = 0; t < 4; t++) {
+        threads.emplace_back(work, t, 4);
+    }
+    threads.emplace_back(work, 0, 1);
+    for(auto &t : threads) {
+        t.join();
+    }
+
+    auto root = forest.find(0);
+    for(std::size_t id = 0; id < size; id++) {
+        REQUIRE(forest.find(id) == root);
+    }
+}
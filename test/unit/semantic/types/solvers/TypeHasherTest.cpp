@@ -0,0 +1,68 @@
+#include "ASTNumberExpr.h"
+#include "TipAlpha.h"
+#include "TipFunction.h"
+#include "TipInt.h"
+#include "TipMu.h"
+#include "TipRecord.h"
+#include "TipRef.h"
+#include "TipVar.h"
+#include "TypeHasher.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+
+TEST_CASE("TypeHasher: Equal types have equal hashes", "[TypeHasher]") {
+    ASTNumberExpr n(42);
+
+    SECTION("Variables on the same node") {
+        TipVar v1(&n);
+        TipVar v2(&n);
+        REQUIRE(TypeHasher::hash(&v1) == TypeHasher::hash(&v2));
+    }
+
+    SECTION("Records ignore field names") {
+        std::vector<std::shared_ptr<TipType>> inits {std::make_shared<TipInt>()};
+        TipRecord r1(inits, {"f"});
+        TipRecord r2(inits, {"g"});
+        REQUIRE(r1 == r2);
+        REQUIRE(TypeHasher::hash(&r1) == TypeHasher::hash(&r2));
+    }
+
+    SECTION("Functions with equal arguments") {
+        std::vector<std::shared_ptr<TipType>> params {std::make_shared<TipVar>(&n)};
+        TipFunction f1(params, std::make_shared<TipRef>(std::make_shared<TipInt>()));
+        TipFunction f2(params, std::make_shared<TipRef>(std::make_shared<TipInt>()));
+        REQUIRE(f1 == f2);
+        REQUIRE(TypeHasher::hash(&f1) == TypeHasher::hash(&f2));
+    }
+
+    SECTION("Mu types") {
+        auto alpha = std::make_shared<TipAlpha>(&n);
+        TipMu m1(alpha, std::make_shared<TipRef>(alpha));
+        TipMu m2(std::make_shared<TipAlpha>(&n), std::make_shared<TipRef>(std::make_shared<TipAlpha>(&n)));
+        REQUIRE(m1 == m2);
+        REQUIRE(TypeHasher::hash(&m1) == TypeHasher::hash(&m2));
+    }
+}
+
+TEST_CASE("TypeHasher: Distinct types have distinct hashes", "[TypeHasher]") {
+    ASTNumberExpr n(42);
+    ASTNumberExpr m(43);
+
+    TipVar v1(&n);
+    TipVar v2(&m);
+    TipAlpha a1(&n);
+    TipAlpha a2(&n, "f");
+    TipInt i;
+    TipRef r(std::make_shared<TipInt>());
+    std::vector<std::shared_ptr<TipType>> params {std::make_shared<TipInt>()};
+    TipFunction f1(params, std::make_shared<TipInt>());
+    TipFunction f2({}, std::make_shared<TipInt>());
+
+    REQUIRE(TypeHasher::hash(&v1) != TypeHasher::hash(&v2));
+    REQUIRE(TypeHasher::hash(&v1) != TypeHasher::hash(&a1));
+    REQUIRE(TypeHasher::hash(&a1) != TypeHasher::hash(&a2));
+    REQUIRE(TypeHasher::hash(&i) != TypeHasher::hash(&r));
+    REQUIRE(TypeHasher::hash(&f1) != TypeHasher::hash(&f2));
+}
@@ -428,3 +428,127 @@ TEST_CASE("Unifier: Test closing mu ", "[Unifier]") {
 
     REQUIRE_NOTHROW(ss.str() == "\u03bc\u03B1<f>.(\u03B1<f>,int) -> int");
 }
+
+TEST_CASE("Unifier: Test closing a batch of types", "[Unifier]") {
+    std::stringstream program;
+    program << R"(
+      // p and q have recursive types, f is (int) -> int
+      f(n) {
+        var p, q;
+        p = alloc null;
+        *p = p;
+        q = p;
+        return n + 1;
+      }
+    )";
+
+    auto ast = ASTHelper::build_ast(program);
+    auto symbols = SymbolTable::build(ast.get());
+
+    TypeConstraintCollectVisitor visitor(symbols.get());
+    ast->accept(&visitor);
+
+    Unifier unifier(visitor.getCollectedConstraints());
+    REQUIRE_NOTHROW(unifier.solve());
+
+    auto fDecl = symbols->getFunction("f");
+    auto fType = std::make_shared<TipVar>(fDecl);
+    auto pType = std::make_shared<TipVar>(symbols->getLocal("p",fDecl));
+    auto qType = std::make_shared<TipVar>(symbols->getLocal("q",fDecl));
+
+    auto batch = unifier.inferredAll({fType, pType, qType});
+    REQUIRE(batch.size() == 3);
+
+    std::stringstream fString;
+    fString << *batch.at(0);
+    REQUIRE(fString.str() == "(int) -> int");
+    REQUIRE(std::dynamic_pointer_cast<TipMu>(batch.at(1)) != nullptr);
+    REQUIRE(std::dynamic_pointer_cast<TipRef>(batch.at(2)) != nullptr);
+
+    // Repeated queries agree with the batch and are answered from the memoized solution
+    REQUIRE(unifier.inferred(pType) == batch.at(1));
+    REQUIRE(unifier.inferred(fType) == batch.at(0));
+}
+
+TEST_CASE("Unifier: Test solving on several threads", "[Unifier]") {
+    SECTION("Test type-safe program") {
+        std::stringstream program;
+        program << R"(
+            id(x) { return x; }
+            deref(p) { return *p; }
+            rec(n) { var r; r = {f: n, g: alloc n}; return r.f; }
+            apply(f, x) { return f(x); }
+            main() {
+              var a, b;
+              a = 3;
+              b = &a;
+              return apply(id, deref(b)) + rec(a);
+            }
+         )";
+
+        auto ast = ASTHelper::build_ast(program);
+        auto symbols = SymbolTable::build(ast.get());
+
+        TypeConstraintCollectVisitor visitor(symbols.get());
+        ast->accept(&visitor);
+
+        Unifier serial(visitor.getCollectedConstraints());
+        REQUIRE_NOTHROW(serial.solve());
+
+        for (unsigned threads : {2u, 4u}) {
+            Unifier parallel(visitor.getCollectedConstraints());
+            REQUIRE_NOTHROW(parallel.solve(threads));
+
+            for (auto f : symbols->getFunctions()) {
+                auto fType = std::make_shared<TipVar>(f);
+                std::stringstream serialString, parallelString;
+                serialString << *serial.inferred(fType);
+                parallelString << *parallel.inferred(fType);
+                REQUIRE(serialString.str() == parallelString.str());
+            }
+        }
+    }
+
+    SECTION("Test type-unsafe program reports the serial error") {
+        std::stringstream program;
+        program << R"(
+            bar(g,x) {
+              var r;
+              if (x==0) {
+                r=g;
+              } else {
+                r=bar(2,0);
+              }
+              return r+1;
+            }
+
+            main() {
+              return bar(null,1);
+            }
+         )";
+
+        auto ast = ASTHelper::build_ast(program);
+        auto symbols = SymbolTable::build(ast.get());
+
+        TypeConstraintCollectVisitor visitor(symbols.get());
+        ast->accept(&visitor);
+
+        std::string serialError, parallelError;
+        Unifier serial(visitor.getCollectedConstraints());
+        try {
+            serial.solve();
+        } catch (UnificationError &e) {
+            serialError = e.what();
+        }
+
+        Unifier parallel(visitor.getCollectedConstraints());
+        try {
+            parallel.solve(4);
+        } catch (UnificationError &e) {
+            parallelError = e.what();
+        }
+
+        REQUIRE(!serialError.empty());
+        REQUIRE(serialError == parallelError);
+    }
+}
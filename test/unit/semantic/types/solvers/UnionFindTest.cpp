@@ -1,9 +1,13 @@
 #include "ASTNumberExpr.h"
+#include "TipInt.h"
+#include "TipRef.h"
 #include "TipVar.h"
 #include "UnionFind.h"
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <chrono>
+#include <iostream>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -86,3 +90,91 @@ TEST_CASE("UnionFind: Test connected", "[UnionFind]") {
     REQUIRE_FALSE(unionFind.connected(five, six));
     cleanup(tipVars);
 }
+
+TEST_CASE("UnionFind: Test structurally equal terms share a class", "[UnionFind]") {
+    std::vector<int> ints {3, 4};
+    auto tipVars = std::move(intsToTipVars(ints));
+    auto three = tipVars.at(0);
+    auto four = tipVars.at(1);
+
+    UnionFind unionFind(tipVars);
+    auto refThree = std::make_shared<TipRef>(three);
+    auto otherRefThree = std::make_shared<TipRef>(std::make_shared<TipVar>(
+        std::dynamic_pointer_cast<TipVar>(three)->getNode()));
+    unionFind.quick_union(four, refThree);
+
+    REQUIRE(*unionFind.find(four) == *refThree);
+    REQUIRE(unionFind.connected(four, otherRefThree));
+    REQUIRE(unionFind.size() == 3);
+    cleanup(tipVars);
+}
+
+TEST_CASE("UnionFind: Test second argument of union is the representative", "[UnionFind]") {
+    std::vector<int> ints {3, 4, 5};
+    auto tipVars = std::move(intsToTipVars(ints));
+    auto three = tipVars.at(0);
+    auto four = tipVars.at(1);
+    auto five = tipVars.at(2);
+    auto intType = std::make_shared<TipInt>();
+
+    UnionFind unionFind(tipVars);
+    unionFind.quick_union(three, four);
+    unionFind.quick_union(five, four);
+
+    // The class of four has the higher rank, but int must still be the representative
+    unionFind.quick_union(four, intType);
+
+    REQUIRE(*unionFind.find(three) == *intType);
+    REQUIRE(*unionFind.find(four) == *intType);
+    REQUIRE(*unionFind.find(five) == *intType);
+    cleanup(tipVars);
+}
+
+TEST_CASE("UnionFind: Test copy is independent", "[UnionFind]") {
+    std::vector<int> ints {3, 4, 5};
+    auto tipVars = std::move(intsToTipVars(ints));
+    auto three = tipVars.at(0);
+    auto four = tipVars.at(1);
+    auto five = tipVars.at(2);
+
+    UnionFind unionFind(tipVars);
+    unionFind.quick_union(three, four);
+    auto ufCopy = unionFind.copy();
+    ufCopy->quick_union(four, five);
+
+    REQUIRE(ufCopy->connected(three, five));
+    REQUIRE(*ufCopy->find(three) == *five);
+    REQUIRE_FALSE(unionFind.connected(three, five));
+    REQUIRE(*unionFind.find(three) == *four);
+    cleanup(tipVars);
+}
+
+/*
+ * Hidden benchmark, run with the "[benchmark]" tag.  Builds chains of
+ * reference types and unions every term into one class.  The time per term
+ * should stay roughly constant as the number of terms grows.
+ */
+TEST_CASE("UnionFind: Scaling benchmark", "[.][UnionFind][benchmark]") {
+    for (int n : {1000, 10000, 100000}) {
+        std::vector<int> ints;
+        for (int i = 0; i < n; i++) {
+            ints.push_back(i);
+        }
+        auto tipVars = std::move(intsToTipVars(ints));
+
+        auto start = std::chrono::steady_clock::now();
+        UnionFind unionFind(tipVars);
+        for (int i = 1; i < n; i++) {
+            unionFind.quick_union(tipVars.at(i), std::make_shared<TipRef>(tipVars.at(i - 1)));
+        }
+        for (int i = 0; i < n; i++) {
+            unionFind.find(tipVars.at(i));
+        }
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+
+        std::cout << "UnionFind " << n << " terms: " << elapsed.count() / 1000 << " ms, "
+                  << elapsed.count() / n << " us/term" << std::endl;
+        REQUIRE(unionFind.size() == 2 * n - 1);
+        cleanup(tipVars);
+    }
+}
@@ -0,0 +1,210 @@
+#include "ASTHelper.h"
+#include "SemanticError.h"
+#include "TypeInference.h"
+#include "TypeSummary.h"
+#include "TypeSummaryCache.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+namespace {
+
+const char *polyProgram = R"(
+  id(x) { return x; }
+  deref(p) { return *p; }
+  loop(n) { var q; q = alloc null; *q = q; return loop(n - 1) + odd(n); }
+  odd(n) { return loop(n); }
+  rec(n) { var r; r = {f: n, g: alloc n}; return r.f; }
+  apply(f, x) { return f(x); }
+  main() {
+    var a, b;
+    a = 3;
+    b = &a;
+    return apply(id, deref(b)) + rec(a);
+  }
+)";
+
+// One group per function, in reverse program order
+std::vector<std::vector<ASTFunction*>> singletons(ASTProgram *ast) {
+  std::vector<std::vector<ASTFunction*>> components;
+  for (auto f : ast->getFunctions()) {
+    components.insert(components.begin(), std::vector<ASTFunction*>{f});
+  }
+  return components;
+}
+
+std::string printed(TypeInference *types) {
+  std::stringstream s;
+  types->print(s);
+  return s.str();
+}
+
+std::string checkError(std::string const &text, TypeSummaryCache *cache) {
+  std::stringstream program(text);
+  auto ast = ASTHelper::build_ast(program);
+  auto symbols = SymbolTable::build(ast.get());
+  try {
+    if (cache == nullptr) {
+      TypeInference::check(ast.get(), symbols.get());
+    } else {
+      TypeInference::checkIncremental(ast.get(), symbols.get(), singletons(ast.get()), cache);
+    }
+  } catch (SemanticError &e) {
+    return e.what();
+  }
+  return "";
+}
+
+}
+
+TEST_CASE("TypeSummary: incremental check infers the types of check", "[TypeSummary]") {
+    std::stringstream program(polyProgram);
+    auto ast = ASTHelper::build_ast(program);
+    auto symbols = SymbolTable::build(ast.get());
+    auto expected = printed(TypeInference::check(ast.get(), symbols.get()).get());
+
+    TypeSummaryCache cache;
+    auto types = TypeInference::checkIncremental(ast.get(), symbols.get(), singletons(ast.get()), &cache);
+    REQUIRE(printed(types.get()) == expected);
+    REQUIRE(cache.getMisses() == 7);
+    REQUIRE(cache.getHits() == 0);
+
+    // Mutually recursive functions in one group
+    auto functions = ast->getFunctions();
+    std::vector<std::vector<ASTFunction*>> grouped = {{functions[0]}, {functions[1]}, {functions[2], functions[3]},
+                                                      {functions[4]}, {functions[5]}, {functions[6]}};
+    TypeSummaryCache groupCache;
+    types = TypeInference::checkIncremental(ast.get(), symbols.get(), grouped, &groupCache);
+    REQUIRE(printed(types.get()) == expected);
+}
+
+TEST_CASE("TypeSummary: summaries are reused for a new parse of the same text", "[TypeSummary]") {
+    TypeSummaryCache cache;
+    {
+        std::stringstream program(polyProgram);
+        auto ast = ASTHelper::build_ast(program);
+        auto symbols = SymbolTable::build(ast.get());
+        TypeInference::checkIncremental(ast.get(), symbols.get(), singletons(ast.get()), &cache);
+    }
+
+    std::stringstream saved;
+    cache.save(saved);
+    TypeSummaryCache loaded;
+    REQUIRE(loaded.load(saved));
+    REQUIRE(loaded.size() == 7);
+
+    // Only the edited function and the group whose text it shares are recomputed
+    std::string edited = polyProgram;
+    edited.replace(edited.find("return *p;"), 10, "return *p + 1;");
+    std::stringstream program(edited);
+    auto ast = ASTHelper::build_ast(program);
+    auto symbols = SymbolTable::build(ast.get());
+    auto expected = printed(TypeInference::check(ast.get(), symbols.get()).get());
+
+    auto types = TypeInference::checkIncremental(ast.get(), symbols.get(), singletons(ast.get()), &loaded);
+    REQUIRE(printed(types.get()) == expected);
+    REQUIRE(loaded.getHits() == 6);
+    REQUIRE(loaded.getMisses() == 1);
+}
+
+TEST_CASE("TypeSummary: unchanged independent parts are not unified again", "[TypeSummary]") {
+    std::string text = R"(
+      deref(p) { return *p; }
+      first() { var x; x = 1; return deref(&x); }
+      rec(n) { var r; r = {f: n}; return r.f; }
+      second() { return rec(2); }
+      main() { return 0; }
+    )";
+    TypeSummaryCache cache;
+    std::size_t all;
+    {
+        std::stringstream program(text);
+        auto ast = ASTHelper::build_ast(program);
+        auto symbols = SymbolTable::build(ast.get());
+        all = TypeInference::checkIncremental(ast.get(), symbols.get(), singletons(ast.get()), &cache)
+                ->getNumConstraints();
+        REQUIRE(all > 0);
+    }
+
+    std::stringstream saved;
+    cache.save(saved);
+    TypeSummaryCache loaded;
+    REQUIRE(loaded.load(saved));
+
+    // Nothing is unified until the types are queried
+    {
+        std::stringstream program(text);
+        auto ast = ASTHelper::build_ast(program);
+        auto symbols = SymbolTable::build(ast.get());
+        auto expected = printed(TypeInference::check(ast.get(), symbols.get()).get());
+        auto types = TypeInference::checkIncremental(ast.get(), symbols.get(), singletons(ast.get()), &loaded);
+        REQUIRE(types->getNumConstraints() == 0);
+        REQUIRE(printed(types.get()) == expected);
+    }
+
+    // Only the part with the edited function is unified
+    std::string edited = text;
+    edited.replace(edited.find("return *p;"), 10, "return *p + 1;");
+    std::stringstream program(edited);
+    auto ast = ASTHelper::build_ast(program);
+    auto symbols = SymbolTable::build(ast.get());
+    auto expected = printed(TypeInference::check(ast.get(), symbols.get()).get());
+    auto types = TypeInference::checkIncremental(ast.get(), symbols.get(), singletons(ast.get()), &loaded);
+    REQUIRE(types->getNumConstraints() > 0);
+    REQUIRE(types->getNumConstraints() < all);
+    REQUIRE(printed(types.get()) == expected);
+}
+
+TEST_CASE("TypeSummary: errors are those of check", "[TypeSummary]") {
+    // The error only arises when the summaries are combined
+    std::string combined = R"(
+      foo(p) { return *p; }
+      main() { return foo(3); }
+    )";
+    REQUIRE(checkError(combined, nullptr) != "");
+    TypeSummaryCache cache;
+    REQUIRE(checkError(combined, &cache) == checkError(combined, nullptr));
+
+    // The error arises within a single function
+    std::string local = R"(
+      foo(p) { var x; x = 3; return *x; }
+      main() { return foo(3); }
+    )";
+    REQUIRE(checkError(local, nullptr) != "");
+    REQUIRE(checkError(local, &cache) == checkError(local, nullptr));
+
+    // Absent fields are only known once the summaries are combined
+    std::string absent = R"(
+      get(r) { return r.g; }
+      main() { var r; r = {f: 1}; return get(r); }
+    )";
+    REQUIRE(checkError(absent, nullptr) != "");
+    REQUIRE(checkError(absent, &cache) == checkError(absent, nullptr));
+}
+
+TEST_CASE("TypeSummary: read rejects malformed summaries", "[TypeSummary]") {
+    std::stringstream program(polyProgram);
+    auto ast = ASTHelper::build_ast(program);
+    auto symbols = SymbolTable::build(ast.get());
+    auto functions = ast->getFunctions();
+    auto summary = TypeSummary::summarize({functions[5]}, symbols.get());
+    REQUIRE(summary != nullptr);
+
+    std::stringstream written;
+    summary->write(written);
+    std::stringstream copy(written.str());
+    auto read = TypeSummary::read(copy);
+    REQUIRE(read != nullptr);
+    std::stringstream rewritten;
+    read->write(rewritten);
+    REQUIRE(rewritten.str() == written.str());
+
+    std::stringstream truncated(written.str().substr(0, written.str().size() / 2));
+    REQUIRE(TypeSummary::read(truncated) == nullptr);
+
+    std::stringstream notACache("summaries");
+    TypeSummaryCache cache;
+    REQUIRE_FALSE(cache.load(notACache));
+    REQUIRE(cache.size() == 0);
+}